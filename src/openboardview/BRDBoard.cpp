@@ -16,31 +16,34 @@ using namespace std::placeholders;
 const string BRDBoard::kNetUnconnectedPrefix = "UNCONNECTED";
 const string BRDBoard::kComponentDummyName   = "...";
 
-BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
+namespace {
+
+// A shared_ptr to element i of a block, elements of a block share one allocation and control block
+template <class T>
+shared_ptr<T> block_element(const shared_ptr<vector<T>> &block, size_t i) {
+	return shared_ptr<T>(block, &(*block)[i]);
+}
+
+} // namespace
+
+BRDBoard::BRDBoard(BRDFileBase *const boardFile)
     : m_file(boardFile) {
 	// TODO: strip / trim all strings, especially those used as keys
-	// TODO: just loop through original arrays?
-	vector<BRDPart> m_parts(m_file->num_parts);
-	vector<BRDPin> m_pins(m_file->num_pins);
-	vector<BRDNail> m_nails(m_file->num_nails);
-	vector<BRDPoint> m_points(m_file->num_format);
-	vector<BRDTrack> m_tracks(m_file->tracks.size());
-	vector<BRDVia> m_vias(m_file->vias.size());
-	vector<BRDArc> m_arcs(m_file->arcs.size());
+
+	// Take the parsed elements over instead of copying them, the file is released once we are done
+	vector<BRDPart> brd_parts   = std::move(boardFile->parts);
+	vector<BRDPin> brd_pins     = std::move(boardFile->pins);
+	vector<BRDNail> brd_nails   = std::move(boardFile->nails);
+	vector<BRDTrack> brd_tracks = std::move(boardFile->tracks);
+	vector<BRDVia> brd_vias     = std::move(boardFile->vias);
+	vector<BRDArc> brd_arcs     = std::move(boardFile->arcs);
 	set<EBoardSide> all_side;
 	auto scale = m_file->scale;
 
-	m_parts  = m_file->parts;
-	m_pins   = m_file->pins;
-	m_nails  = m_file->nails;
-	m_points = m_file->format;
-	m_tracks = m_file->tracks;
-	m_vias = m_file->vias;
-	m_arcs = m_file->arcs;
-
 	// Set outline
 	{
-		for (auto &brdPoint : m_points) {
+		outline_points_.reserve(m_file->format.size());
+		for (auto &brdPoint : m_file->format) {
 			auto point = make_shared<Point>(brdPoint.x / scale, brdPoint.y/ scale);
 			outline_points_.push_back(point);
 		}
@@ -51,44 +54,68 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 		return {{s.first.x / scale, s.first.y/ scale}, {s.second.x/ scale, s.second.y / scale}};
 	});
 
-	// Populate map of unique nets
-	SharedStringMap<Net> net_map;
+	components_.reserve(brd_parts.size());
+	pins_.reserve(brd_pins.size());
+	tracks_.reserve(brd_tracks.size());
+	vias_.reserve(brd_vias.size());
+	arcs_.reserve(brd_arcs.size());
+	store_.names = &names_;
+
+	// Unique nets, indexed by the id of their name in names_ so resolving a name is one hash probe
+	names_.reserve(brd_parts.size() + brd_nails.size());
+	vector<shared_ptr<Net>> net_by_name;
+	const auto net_name_id = [&](string_view name) {
+		StringPool::Id id = names_.intern(name);
+		if (id >= net_by_name.size()) net_by_name.resize(id + 1);
+		return id;
+	};
+	const auto add_net = [&](StringPool::Id id, EBoardSide side) {
+		auto net        = make_shared<Net>();
+		net->name       = names_.view(id);
+		net->name_id    = id;
+		net->board_side = side;
+		// NOTE: net->number not set
+		net_by_name[id] = net;
+		return net.get();
+	};
+	// Net of a track, via or arc, nullptr if it has none
+	const auto resolve_net = [&](const char *name, EBoardSide side) -> Net * {
+		if (!name || !name[0]) return nullptr;
+		StringPool::Id id = net_name_id(name);
+		if (net_by_name[id]) return net_by_name[id].get();
+		return add_net(id, side);
+	};
+
+	Net *net_nc = nullptr;
 	{
 		// adding special net 'UNCONNECTED'
-		auto net_nc           = make_shared<Net>();
-		net_nc->name          = kNetUnconnectedPrefix;
-		net_nc->is_ground     = false;
-		net_map[net_nc->name] = net_nc;
+		net_nc            = add_net(net_name_id(kNetUnconnectedPrefix), kBoardSideBoth);
+		net_nc->is_ground = false;
 
 		// handle all the others
-		for (auto &brd_nail : m_nails) {
-			auto net = make_shared<Net>();
-
-			// copy NET name and number (probe)
-			net->name = string(brd_nail.net);
-
+		for (auto &brd_nail : brd_nails) {
 			// avoid having multiple UNCONNECTED<XXX> references
-			if (is_prefix(kNetUnconnectedPrefix, net->name)) continue;
+			if (is_prefix(kNetUnconnectedPrefix, brd_nail.net)) continue;
 
-			net->number    = brd_nail.probe;
-
-			if (brd_nail.side == BRDPartMountingSide::Top) {
-				net->board_side = kBoardSideTop;
-			} else {
-				net->board_side = kBoardSideBottom;
-			}
-
-			// so we can find nets later by name (making unique by name)
-			net_map[net->name] = net;
+			// copy NET name and number (probe), so we can find nets later by name (making unique by name)
+			auto net    = add_net(net_name_id(brd_nail.net), brd_nail.side == BRDPartMountingSide::Top ? kBoardSideTop : kBoardSideBottom);
+			net->number = brd_nail.probe;
 		}
 	}
 
 	// Populate parts
 	{
-		for (auto &brd_part : m_parts) {
-			auto comp = make_shared<Component>();
+		// Pin count of each part, so their pin vectors are allocated once
+		vector<unsigned int> part_pin_count(brd_parts.size());
+		for (auto &brd_pin : brd_pins)
+			if (brd_pin.part >= 1 && brd_pin.part <= brd_parts.size()) part_pin_count[brd_pin.part - 1]++;
+
+		for (size_t i = 0; i < brd_parts.size(); i++) {
+			auto &brd_part = brd_parts[i];
+			auto comp      = make_shared<Component>();
+			comp->pins.reserve(part_pin_count[i]);
 
-			comp->name    = string(brd_part.name);
+			comp->name    = brd_part.name; // in the file buffer until it is interned below
 			comp->mfgcode = std::move(brd_part.mfgcode);
 
 			comp->p1 = {brd_part.p1.x, brd_part.p1.y};
@@ -126,17 +153,16 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 		// NOTE: originally the pin diameter depended on part.name[0] == 'U' ?
 		unsigned int pin_idx  = 0;
 		unsigned int part_idx = 1;
-		auto pins             = m_pins;
-		auto parts            = m_parts;
+		auto pin_block        = make_shared<vector<Pin>>(brd_pins.size());
 
-		for (size_t i = 0; i < pins.size(); i++) {
+		for (size_t i = 0; i < brd_pins.size(); i++) {
 			// (originally from BoardView::DrawPins)
-			const BRDPin &brd_pin = pins[i];
+			const BRDPin &brd_pin = brd_pins[i];
 			std::shared_ptr<Component> comp       = components_[brd_pin.part - 1];
 
 			if (!comp) continue;
 
-			auto pin = make_shared<Pin>();
+			auto pin = block_element(pin_block, i);
 
 			if (comp->is_dummy()) {
 				// component is virtual, i.e. "...", pin is test pad
@@ -155,22 +181,19 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 				pin_idx  = 1;
 			}
 			if (brd_pin.snum) {
-				pin->number = brd_pin.snum;
+				pin->number = names_.view(names_.intern(brd_pin.snum));
 			} else {
-				pin->number = std::to_string(pin_idx);
+				pin->number = names_.view(names_.intern(std::to_string(pin_idx)));
 			}
 
 			// Lets us see BGA pad names finally
 			//
 			if (brd_pin.name) {
-				pin->name = std::string(brd_pin.name);
+				pin->name = names_.view(names_.intern(brd_pin.name));
 			} else {
 				pin->name = pin->number;
 			}
 
-			// copy position
-			pin->position = Point(brd_pin.pos.x / scale, brd_pin.pos.y / scale);
-
 			// Set board side for pins from specific setting
 			if (brd_pin.side == BRDPinSide::Top) {
 				pin->board_side = kBoardSideTop;
@@ -180,44 +203,30 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 				pin->board_side = kBoardSideBoth;
 			}
 
-			if (brd_pin.diode_vale) {
-				pin->diode_value = std::string(brd_pin.diode_vale);
-			}
-			if (brd_pin.voltage_value) {
-				pin->voltage_value = std::string(brd_pin.voltage_value);
-			}
-
 			// set net reference (here's our NET key string again)
-			string net_name = string(brd_pin.net);
-			if (net_map.count(net_name)) {
-				// there is a net with that name in our map
-				pin->net = net_map[net_name].get();
-				if (is_prefix(kNetUnconnectedPrefix, net_name)) {
-					pin->type = Pin::kPinTypeNotConnected;
-				}
-			} else {
-				// no net with that name registered, so create one
-				if (!net_name.empty()) {
+			string_view net_name = brd_pin.net ? brd_pin.net : "";
+			if (!net_name.empty()) {
+				StringPool::Id net_id = net_name_id(net_name);
+				if (net_by_name[net_id]) {
+					// there is a net with that name already
+					pin->net = net_by_name[net_id].get();
 					if (is_prefix(kNetUnconnectedPrefix, net_name)) {
-						// pin is unconnected, so reference our special net
-						pin->net  = net_map[kNetUnconnectedPrefix].get();
 						pin->type = Pin::kPinTypeNotConnected;
-					} else {
-						// indeed a new net
-						auto net        = make_shared<Net>();
-						net->name       = net_name;
-						net->board_side = pin->board_side;
-						// NOTE: net->number not set
-						net_map[net_name] = net;
-						pin->net          = net.get();
 					}
-				} else {
-					// not sure this can happen -> no info
-					// It does happen in .fz apparently and produces a SEGFAULT… Use
-					// unconnected net.
-					pin->net  = net_map[kNetUnconnectedPrefix].get();
+				} else if (is_prefix(kNetUnconnectedPrefix, net_name)) {
+					// pin is unconnected, so reference our special net
+					pin->net  = net_nc;
 					pin->type = Pin::kPinTypeNotConnected;
+				} else {
+					// indeed a new net
+					pin->net = add_net(net_id, pin->board_side);
 				}
+			} else {
+				// not sure this can happen -> no info
+				// It does happen in .fz apparently and produces a SEGFAULT… Use
+				// unconnected net.
+				pin->net  = net_nc;
+				pin->type = Pin::kPinTypeNotConnected;
 			}
 
 			// TODO: should either depend on file specs or type etc
@@ -225,7 +234,14 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 			//  if(brd_pin.radius) pin->diameter = brd_pin.radius; // some format
 			//  (.fz) contains a radius field
 			//    else pin->diameter = 0.5f;
-			pin->diameter = brd_pin.radius / scale; // some format (.fz) contains a radius field
+			// copy position and diameter, some format (.fz) contains a radius field
+			store_.add_pin(*pin, Point(brd_pin.pos.x / scale, brd_pin.pos.y / scale), brd_pin.radius / scale);
+			if (brd_pin.diode_vale) {
+				pin->set_value(Pin::kValueDiode, brd_pin.diode_vale);
+			}
+			if (brd_pin.voltage_value) {
+				pin->set_value(Pin::kValueVoltage, brd_pin.voltage_value);
+			}
 			pin->size = {brd_pin.size.x / scale, brd_pin.size.y / scale};
 			pin->shape = EShapeType(brd_pin.shape);
 			pin->angle = brd_pin.angle;
@@ -237,6 +253,8 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 			if (comp->is_dummy()) {
 				comp->name = comp->name.substr(3);
 			}
+			comp->name_id = names_.intern(comp->name);
+			comp->name    = names_.view(comp->name_id);
 		}
 	}
 
@@ -246,8 +264,10 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 		static_assert((int)BRDPartMountingSide::Bottom == (int)kBoardSideBottom, "");
 		return EBoardSide(side);
 	};
-	for (auto& board_track : m_tracks) {
-		auto track = make_shared<Track>();
+	auto track_block = make_shared<vector<Track>>(brd_tracks.size());
+	for (size_t i = 0; i < brd_tracks.size(); i++) {
+		auto &board_track = brd_tracks[i];
+		auto track        = block_element(track_block, i);
 		track->board_side = transform_side_fn(board_track.side);
 		all_side.emplace(track->board_side);
 		track->position_start.x = board_track.points.first.x / scale;
@@ -255,23 +275,13 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 		track->position_end.x = board_track.points.second.x / scale;
 		track->position_end.y = board_track.points.second.y / scale;
 		track->width = board_track.width / scale;
-		auto net_name = string(board_track.net);
-		if (!net_name.empty()) {
-			if (!net_map.count(net_name)) {
-				auto net        = make_shared<Net>();
-				net->name       = net_name;
-				net->board_side = track->board_side;
-				// NOTE: net->number not set
-				net_map[net_name] = net;
-				track->net = net.get();
-			} else {
-				track->net = net_map[net_name].get();
-			}
-		}
+		track->net = resolve_net(board_track.net, track->board_side);
 		tracks_.push_back(track);
 	}
-	for (auto& board_via : m_vias) {
-		auto via = make_shared<Via>();
+	auto via_block = make_shared<vector<Via>>(brd_vias.size());
+	for (size_t i = 0; i < brd_vias.size(); i++) {
+		auto &board_via = brd_vias[i];
+		auto via        = block_element(via_block, i);
 		via->board_side = transform_side_fn(board_via.side);
 		all_side.emplace(via->board_side);
 		via->target_side = transform_side_fn(board_via.target_side);
@@ -279,51 +289,33 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 		via->size = board_via.size / scale;
 		via->position.x = board_via.pos.x / scale;
 		via->position.y = board_via.pos.y / scale;
-		auto net_name = string(board_via.net);
-		if (!net_name.empty()) {
-			if (!net_map.count(net_name)) {
-				auto net        = make_shared<Net>();
-				net->name       = net_name;
-				net->board_side = via->board_side;
-				// NOTE: net->number not set
-				net_map[net_name] = net;
-				via->net = net.get();
-			} else {
-				via->net = net_map[net_name].get();
-			}
-		}
+		via->net = resolve_net(board_via.net, via->board_side);
 		vias_.push_back(via);
 	}
 
-	for (auto& board_arc : m_arcs) {
-		auto arc = make_shared<PcbArc>();
+	auto arc_block = make_shared<vector<PcbArc>>(brd_arcs.size());
+	for (size_t i = 0; i < brd_arcs.size(); i++) {
+		auto &board_arc = brd_arcs[i];
+		auto arc        = block_element(arc_block, i);
 		arc->board_side = transform_side_fn(board_arc.side);
 		arc->radius = board_arc.radius/ scale;
 		arc->startAngle = board_arc.startAngle;
 		arc->endAngle = board_arc.endAngle;
 		arc->position.x = board_arc.pos.x/ scale;
 		arc->position.y = board_arc.pos.y/ scale;
-		auto net_name = string(board_arc.net);
-		if (!net_name.empty()) {
-			if (!net_map.count(net_name)) {
-				auto net        = make_shared<Net>();
-				net->name       = net_name;
-				net->board_side = arc->board_side;
-				// NOTE: net->number not set
-				net_map[net_name] = net;
-				arc->net = net.get();
-			} else {
-				arc->net = net_map[net_name].get();
-			}
-		}
+		arc->net = resolve_net(board_arc.net, arc->board_side);
 		arcs_.push_back(arc);
 	}
-	// Populate Net vector by using the map. (sorted by keys)
-	for (auto &net : net_map) {
+	// Populate Net vector, sorted by name
+	for (auto &net : net_by_name) {
+		if (!net) continue;
 		// check whether the pin represents ground
-		net.second->is_ground = (net.second->name == "GND" || net.second->name == "GROUND");
-		nets_.push_back(net.second);
+		net->is_ground = (net->name == "GND" || net->name == "GROUND");
+		nets_.push_back(std::move(net));
 	}
+	sort(begin(nets_), end(nets_), [](const shared_ptr<Net> &lhs, const shared_ptr<Net> &rhs) {
+		return lhs->name < rhs->name;
+	});
 
 	for (auto& comp : components_) {
 		if (comp->pins.size() == 1 && comp->pins.front()->net->is_ground) {
@@ -338,6 +330,11 @@ BRDBoard::BRDBoard(const BRDFileBase * const boardFile)
 
 	std::move(all_side.begin(), all_side.end(), std::back_inserter(all_side_));
 	std::sort(all_side_.begin(), all_side_.end());
+
+	store_.build(pins_, components_, nets_);
+
+	// Every string we keep was copied above, nothing points into the file anymore
+	boardFile->release_elements();
 }
 
 BRDBoard::~BRDBoard() {}
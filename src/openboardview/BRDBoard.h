@@ -10,7 +10,8 @@ using namespace std;
 
 class BRDBoard : public Board {
   public:
-	BRDBoard(const BRDFileBase *const boardFile);
+	// Moves the parsed elements out of boardFile and releases its buffers, only its status fields remain
+	BRDBoard(BRDFileBase *const boardFile);
 	~BRDBoard();
 
 	const BRDFileBase *m_file;
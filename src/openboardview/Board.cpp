@@ -1,16 +1,89 @@
 #include "Board.h"
 
-std::vector<const std::string *> Component::searchableStringDetails() const {
-	return {&mfgcode};
+std::vector<string_view> Component::searchableStringDetails() const {
+	return {mfgcode};
 }
 
-std::vector<const std::string *> Net::searchableStringDetails() const {
-	std::vector<const std::string *> result = {};
+std::vector<string_view> Net::searchableStringDetails() const {
+	std::vector<string_view> result = {};
 	for (const auto &pin : pins) {
-		result.push_back(&pin->name);
+		result.push_back(pin->name);
 		if (pin->number != pin->name) {
-			result.push_back(&pin->number);
+			result.push_back(pin->number);
 		}
 	}
 	return result;
 }
+
+string_view Pin::value(EValue kind) const {
+	if (!store || store->pin_values[kind].empty()) return {};
+	StringPool::Id id = store->pin_values[kind][index];
+	return id == StringPool::kNone ? string_view() : store->names->view(id);
+}
+
+void Pin::set_value(EValue kind, string_view value) {
+	if (!store) return;
+	auto &values = store->pin_values[kind];
+	if (values.empty()) {
+		if (value.empty()) return;
+		values.assign(store->pin_count(), StringPool::kNone);
+	}
+	values[index] = value.empty() ? StringPool::kNone : store->names->intern(value);
+}
+
+namespace {
+
+// Groups the pin indices by owner (component or net), keeping the pin order within each group
+void build_ranges(const std::vector<uint32_t> &owners, size_t owner_count, std::vector<uint32_t> &begin, std::vector<uint32_t> &indices) {
+	begin.assign(owner_count + 1, 0);
+	for (auto owner : owners)
+		if (owner != BoardStore::kNone) begin[owner + 1]++;
+	for (size_t i = 0; i < owner_count; i++) begin[i + 1] += begin[i];
+
+	indices.resize(begin[owner_count]);
+	std::vector<uint32_t> next(begin.begin(), begin.end() - 1);
+	for (uint32_t i = 0; i < owners.size(); i++)
+		if (owners[i] != BoardStore::kNone) indices[next[owners[i]]++] = i;
+}
+
+} // namespace
+
+void BoardStore::add_pin(Pin &pin, Point position, float diameter) {
+	pin.store = this;
+	pin.index = static_cast<uint32_t>(pin_x.size());
+	pin_x.push_back(position.x);
+	pin_y.push_back(position.y);
+	pin_diameter.push_back(diameter);
+	for (auto &values : pin_values)
+		if (!values.empty()) values.push_back(StringPool::kNone);
+}
+
+void BoardStore::build(SharedVector<Pin> &pins, SharedVector<Component> &components, SharedVector<Net> &nets) {
+	for (uint32_t i = 0; i < nets.size(); i++) nets[i]->index = i;
+	for (uint32_t i = 0; i < components.size(); i++) components[i]->index = i;
+
+	pin_side.resize(pins.size());
+	pin_type.resize(pins.size());
+	pin_ground.resize(pins.size());
+	pin_net.resize(pins.size());
+	pin_component.resize(pins.size());
+
+	for (uint32_t i = 0; i < pins.size(); i++) {
+		auto &pin        = pins[i];
+		pin_side[i]      = pin->board_side;
+		pin_type[i]      = pin->type;
+		pin_ground[i]    = pin->net && pin->net->is_ground;
+		pin_net[i]       = pin->net ? pin->net->index : kNone;
+		pin_component[i] = pin->component ? pin->component->index : kNone;
+	}
+
+	component_side.resize(components.size());
+	for (size_t i = 0; i < components.size(); i++) component_side[i] = components[i]->board_side;
+
+	build_ranges(pin_component, components.size(), component_begin, component_pins);
+	build_ranges(pin_net, nets.size(), net_begin, net_pins);
+}
+
+void BoardStore::mirror_x(float max_x) {
+	for (auto &x : pin_x) x = max_x - x;
+}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include "FileFormats/BRDFile.h"
+#include "FileFormats/StringPool.h"
 
 #include "imgui/imgui.h"
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #define EMPTY_STRING ""
@@ -27,6 +30,7 @@ struct BoardElement;
 struct Net;
 struct Pin;
 struct Component;
+struct BoardStore;
 
 typedef function<void(const char *)> TcharStringCallback;
 typedef function<void(BoardElement *)> TboardElementCallback;
@@ -60,7 +64,7 @@ enum EShapeType {
 };
 
 // Checking whether str `prefix` is a prefix of str `base`.
-inline static bool is_prefix(string prefix, string base) {
+inline static bool is_prefix(string_view prefix, string_view base) {
 	if (prefix.size() > base.size()) return false;
 
 	auto res = mismatch(prefix.begin(), prefix.end(), base.begin());
@@ -119,16 +123,21 @@ struct Point {
 // Shared potential between multiple Pins/Contacts.
 struct Net : BoardElement {
 	int number;
-	string name;
+	// In Board::Names(), NUL-terminated, nets with the same name have the same name_id
+	string_view name;
+	StringPool::Id name_id = StringPool::kNone;
 	bool is_ground;
 
+	// Position in Board::Nets(), see BoardStore
+	uint32_t index = 0;
+
 	SharedVector<Pin> pins;
 
 	string UniqueId() const {
-		return kBoardNetPrefix + name;
+		return kBoardNetPrefix + string(name);
 	}
 
-	std::vector<const std::string *> searchableStringDetails() const;
+	std::vector<string_view> searchableStringDetails() const;
 };
 
 struct Track: BoardElement {
@@ -204,19 +213,30 @@ struct Pin : BoardElement {
 		kPinTypeTestPad,
 	};
 
+	// Values measured on a pin, from the board file or annotations.
+	enum EValue {
+		kValueNone = -1,
+		kValueDiode, // the pin diode
+		kValueVoltage, // the pin voltage
+		kValueOhm,
+		kValueOhmBlack,
+		kValueCount,
+	};
+
 	// Type of Contact, e.g. pin, via, probe/test point.
 	EPinType type;
 
-	// Pin number / Nail count.
-	string number;
+	// Pin number / Nail count, in Board::Names(), NUL-terminated
+	string_view number;
 
-	string name; // for BGA pads will be AZ82 etc
+	string_view name; // for BGA pads will be AZ82 etc, in Board::Names(), NUL-terminated
 
 	EShapeType shape = EShapeType::kShapeTypeCircle;
-	// Position according to board file. (probably in inches)
-	Point position;
-	// Contact diameter, e.g. via or pin size. (probably in inches)
-	float diameter;
+	// Position according to board file. (probably in inches), kept by the BoardStore
+	Point position() const;
+	// Contact diameter, e.g. via or pin size. (probably in inches), kept by the BoardStore
+	float diameter() const;
+	void set_diameter(float diameter);
 
 	// Rect size
 	Point size;
@@ -229,18 +249,18 @@ struct Pin : BoardElement {
 	// Contact belonging to this component (pin), nullptr if nail.
 	std::shared_ptr<Component> component;
 
-	string diode_value; // the pin diode
-
-	string voltage_value; // the pin voltage
-
-	string ohm_value;
-
-	string ohm_black_value;
+	// Measured value, kept by the BoardStore. NUL-terminated, empty if there is none
+	string_view value(EValue kind) const;
+	void set_value(EValue kind, string_view value);
 
 	PinVoltageFlag voltage_flag = PinVoltageFlag::unknown;
 
+	// Position in Board::Pins(), in store
+	uint32_t index    = 0;
+	BoardStore *store = nullptr;
+
 	string UniqueId() const {
-		return kBoardPinPrefix + number;
+		return kBoardPinPrefix + string(number);
 	}
 };
 
@@ -269,8 +289,9 @@ struct Component : BoardElement {
 	// Type of component, eg. resistor, cap, etc.
 	EComponentType component_type = kComponentTypeUnknown;
 
-	// Part name as stored in board file.
-	string name;
+	// Part name as stored in board file, in Board::Names(), NUL-terminated
+	string_view name;
+	StringPool::Id name_id = StringPool::kNone;
 
 	// Part type
 	string part_type;
@@ -296,10 +317,8 @@ struct Component : BoardElement {
 
 	PartAngle angle = PartAngle::unknown;
 
-	// enum ComponentVisualModes { CVMNormal = 0, CVMSelected, CVMShowPins, CVMModeCount };
-	enum ComponentVisualModes { CVMNormal = 0, CVMSelected, CVMModeCount };
-
-	uint8_t visualmode = 0;
+	// Position in Board::Components(), see BoardStore
+	uint32_t index = 0;
 
 	// Mount type as readable string.
 	string mount_type_str() {
@@ -316,7 +335,7 @@ struct Component : BoardElement {
 	}
 
 	string UniqueId() const {
-		return kBoardComponentPrefix + name;
+		return kBoardComponentPrefix + string(name);
 	}
 
 	void set_part_type(const string& part_type) {
@@ -339,9 +358,90 @@ struct Component : BoardElement {
 		this->part_type = part_type;
 	}
 
-	std::vector<const std::string *> searchableStringDetails() const;
+	std::vector<string_view> searchableStringDetails() const;
 };
 
+/*
+ * Structure of arrays copy of the pin fields the per-frame loops read (drawing, picking, net web),
+ * so they stream through a few contiguous arrays instead of dereferencing a shared_ptr per pin.
+ * Pin i is Board::Pins()[i], component c is Board::Components()[c] and net n is Board::Nets()[n];
+ * the objects stay the reference for everything else (names, outlines). Pin positions, diameters
+ * and values are only kept here.
+ */
+struct BoardStore {
+	static constexpr uint32_t kNone = UINT32_MAX;
+
+	// A run of pin indices
+	struct IndexRange {
+		const uint32_t *first, *last;
+		const uint32_t *begin() const {
+			return first;
+		}
+		const uint32_t *end() const {
+			return last;
+		}
+		size_t size() const {
+			return last - first;
+		}
+	};
+
+	// Per pin, pin_x, pin_y, pin_diameter and pin_values are the only copy, Pin reads them from here
+	std::vector<float> pin_x, pin_y;
+	std::vector<float> pin_diameter;
+	// Per kind of value, ids in names, empty until a pin has a value of that kind
+	std::vector<StringPool::Id> pin_values[Pin::kValueCount];
+	std::vector<EBoardSide> pin_side;
+	std::vector<uint8_t> pin_type; // Pin::EPinType
+	std::vector<uint8_t> pin_ground;
+	std::vector<uint32_t> pin_net;       // kNone if the pin has no net
+	std::vector<uint32_t> pin_component; // kNone if the pin has no component
+
+	// Per component, its pins are component_pins[component_begin[c]] to component_pins[component_begin[c + 1]]
+	std::vector<EBoardSide> component_side;
+	std::vector<uint32_t> component_begin;
+	std::vector<uint32_t> component_pins;
+
+	// Per net, same layout as the components
+	std::vector<uint32_t> net_begin;
+	std::vector<uint32_t> net_pins;
+
+	// Board::Names(), holds the pin values
+	StringPool *names = nullptr;
+
+	size_t pin_count() const {
+		return pin_x.size();
+	}
+
+	IndexRange component_pin_range(uint32_t component) const {
+		return {component_pins.data() + component_begin[component], component_pins.data() + component_begin[component + 1]};
+	}
+
+	IndexRange net_pin_range(uint32_t net) const {
+		return {net_pins.data() + net_begin[net], net_pins.data() + net_begin[net + 1]};
+	}
+
+	// Takes pin as the next of Board::Pins(), with its position and diameter
+	void add_pin(Pin &pin, Point position, float diameter);
+
+	// Numbers the elements and fills the other arrays, once the board's element vectors are final
+	void build(SharedVector<Pin> &pins, SharedVector<Component> &components, SharedVector<Net> &nets);
+
+	// Mirrors the pins around x = max_x / 2
+	void mirror_x(float max_x);
+};
+
+inline Point Pin::position() const {
+	return Point(store->pin_x[index], store->pin_y[index]);
+}
+
+inline float Pin::diameter() const {
+	return store->pin_diameter[index];
+}
+
+inline void Pin::set_diameter(float diameter) {
+	store->pin_diameter[index] = diameter;
+}
+
 class Board {
   public:
 	enum EBoardType { kBoardTypeUnknown = 0, kBoardTypeBRD = 0x01, kBoardTypeBDV = 0x02 };
@@ -361,4 +461,17 @@ class Board {
 	EBoardType BoardType() {
 		return kBoardTypeUnknown;
 	}
+
+	BoardStore &Store() {
+		return store_;
+	}
+
+	// Net and part names, interned
+	StringPool &Names() {
+		return names_;
+	}
+
+  protected:
+	BoardStore store_;
+	StringPool names_;
 };
@@ -0,0 +1,448 @@
+#include "BoardLoader.h"
+
+#include "BRDBoard.h"
+#include "OutlineEdges.h"
+#include "PartOutline.h"
+#include "FileFormats/CacheFile.h"
+#include "FileFormats/FormatRegistry.h"
+#include "parallel.h"
+#include "utils.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <system_error>
+
+#include "../linalg.hpp"
+
+using namespace std;
+
+BoardLoader::~BoardLoader() {
+	Cancel();
+	Reap(true);
+}
+
+/*
+ * Starts loading filepath, a load still in progress is cancelled
+ */
+bool BoardLoader::Start(const filesystem::path &filepath, std::string &error_msg) {
+	Cancel();
+	Reap(false);
+
+	std::error_code ec;
+	if (!filesystem::is_regular_file(filepath, ec)) {
+		error_msg = "Cannot open " + filepath.string() + (ec ? ": " + ec.message() : ": not a file");
+		return false;
+	}
+
+	auto job       = std::make_shared<Job>();
+	job->filepath  = filepath;
+	job->cache_dir = cache_dir;
+	job->fzkey     = fzkey;
+	try {
+		workers.emplace_back(std::thread(&BoardLoader::Run, job), job);
+	} catch (const std::system_error &e) {
+		error_msg = std::string("Cannot start loading: ") + e.what();
+		return false;
+	}
+	current = job;
+	return true;
+}
+
+// Parsed boards are cached in cache_dir, caching is disabled while it is empty
+void BoardLoader::SetCacheDir(const filesystem::path &dir) {
+	cache_dir = dir;
+}
+
+void BoardLoader::SetFZKey(const uint32_t key[44]) {
+	std::copy(key, key + fzkey.size(), fzkey.begin());
+}
+
+void BoardLoader::Cancel() {
+	if (current) {
+		current->cancelled = true;
+		current.reset();
+	}
+}
+
+bool BoardLoader::Busy() const {
+	return current && !current->finished;
+}
+
+BoardLoader::Phase BoardLoader::CurrentPhase() const {
+	return current ? current->phase.load() : Phase::Done;
+}
+
+const filesystem::path &BoardLoader::CurrentFilepath() const {
+	static const filesystem::path none;
+	return current ? current->filepath : none;
+}
+
+std::unique_ptr<BoardLoader::Result> BoardLoader::TakeResult() {
+	if (!current || !current->finished) return nullptr;
+
+	auto result = std::move(current->result);
+	current.reset();
+	Reap(false);
+	return result;
+}
+
+const char *BoardLoader::PhaseName(Phase phase) {
+	switch (phase) {
+		case Phase::Read: return "Reading file";
+		case Phase::Parse: return "Parsing";
+		case Phase::BuildModel: return "Building board";
+		case Phase::Geometry: return "Outlining parts";
+		case Phase::Annotations: return "Loading annotations";
+		case Phase::Done: return "Done";
+	}
+	return "";
+}
+
+// Rough share of the load time spent before each phase, for the progress bar
+float BoardLoader::PhaseProgress(Phase phase) {
+	switch (phase) {
+		case Phase::Read: return 0.0f;
+		case Phase::Parse: return 0.1f;
+		case Phase::BuildModel: return 0.6f;
+		case Phase::Geometry: return 0.8f;
+		case Phase::Annotations: return 0.9f;
+		case Phase::Done: return 1.0f;
+	}
+	return 0.0f;
+}
+
+/*
+ * Joins the threads of jobs done with their cache too, or of all jobs when wait is true
+ */
+void BoardLoader::Reap(bool wait) {
+	auto it = workers.begin();
+	while (it != workers.end()) {
+		if (wait || it->second->exited) {
+			it->first.join();
+			it = workers.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void BoardLoader::Run(std::shared_ptr<Job> job) {
+	load_cancel_flag() = &job->cancelled;
+	auto result        = Load(*job);
+	load_cancel_flag() = nullptr;
+	if (job->cancelled && result) {
+		result->annotations.Close();
+		result.reset();
+	}
+	job->result   = std::move(result);
+	job->phase    = Phase::Done;
+	job->finished = true;
+
+	// The board is handed over, a first load doesn't wait on the disk
+	if (!job->cache_image.empty()) {
+		CacheFile::write(job->cache_image, job->cachepath);
+		job->cache_image = std::vector<char>();
+		CacheFile::prune(job->cache_dir);
+	}
+	job->exited = true;
+}
+
+/*
+ * Returns the cached board at cachepath if it was made from the file identified by stamp
+ */
+std::unique_ptr<BRDFileBase> BoardLoader::LoadCache(const filesystem::path &cachepath, const SourceStamp &stamp) {
+	std::error_code ec;
+	if (!filesystem::exists(cachepath, ec)) return nullptr;
+
+	ParseBuffer buffer;
+	std::string error_msg;
+	if (!buffer.open(cachepath, error_msg)) return nullptr;
+
+	std::unique_ptr<BRDFileBase> file(new CacheFile(buffer, stamp));
+	if (!file->valid) return nullptr;
+	filesystem::last_write_time(cachepath, filesystem::file_time_type::clock::now(), ec); // used, for CacheFile::prune()
+	return file;
+}
+
+/*
+ * The load pipeline, returns nullptr as soon as the job is cancelled.
+ * Parsing errors are reported through the result.
+ */
+std::unique_ptr<BoardLoader::Result> BoardLoader::Load(Job &job) {
+	auto result      = std::make_unique<Result>();
+	result->filepath = job.filepath;
+
+	job.phase = Phase::Read;
+	SourceStamp stamp;
+	filesystem::path cachepath;
+	if (!job.cache_dir.empty() && stamp.read(input_files(job.filepath))) {
+		cachepath = CacheFile::cache_path(job.cache_dir, job.filepath);
+		result->file = LoadCache(cachepath, stamp);
+	}
+	if (job.cancelled) return nullptr;
+
+	if (!result->file) {
+		ParseBuffer buffer;
+		if (!buffer.open(job.filepath, result->error_msg) || buffer.empty()) return result;
+		if (job.cancelled) return nullptr;
+
+		job.phase = Phase::Parse;
+		FormatContext context;
+		context.filepath = job.filepath;
+		context.fzkey    = job.fzkey;
+		result->file     = load_board_file(buffer, context, result->error_msg);
+		if (!result->file || !result->file->valid) return result;
+		if (!cachepath.empty()) {
+			CacheFile::encode(*result->file, stamp, job.cache_image); // before the board takes the elements
+			job.cachepath = cachepath;
+		}
+		if (job.cancelled) return nullptr;
+	}
+
+	job.phase = Phase::BuildModel;
+	BRDFileBase *file = result->file.get();
+
+	// Check board outline (format) point count.
+	//		If we don't have an outline, generate one
+	//
+	if (file->outline_segments.size() < 3 && file->format.size() < 3) {
+		int minx, maxx, miny, maxy;
+		int margin = 200; // #define or leave this be? Rather arbritary.
+
+		minx = miny = INT_MAX;
+		maxx = maxy = INT_MIN;
+
+		for (auto &a : file->pins) {
+			if (a.pos.x > maxx) maxx = a.pos.x;
+			if (a.pos.y > maxy) maxy = a.pos.y;
+			if (a.pos.x < minx) minx = a.pos.x;
+			if (a.pos.y < miny) miny = a.pos.y;
+		}
+
+		maxx += margin;
+		maxy += margin;
+		minx -= margin;
+		miny -= margin;
+
+		file->format.push_back({minx, miny});
+		file->format.push_back({maxx, miny});
+		file->format.push_back({maxx, maxy});
+		file->format.push_back({minx, maxy});
+		file->format.push_back({minx, miny});
+	}
+
+	result->board.reset(new BRDBoard(file));
+	if (job.cancelled) return nullptr;
+
+	job.phase = Phase::Geometry;
+	EPCCheck(result->board.get()); // check to see we don't have a flipped board outline
+
+	/*
+	 * Set pins to a known lower size, they get resized
+	 * by OutlineParts() when the component is analysed
+	 */
+	for (auto &diameter : result->board->Store().pin_diameter) {
+		if (diameter <= 0) diameter = 7;
+	}
+	if (job.cancelled) return nullptr;
+
+	OutlineParts(result->board.get());
+	if (job.cancelled) return nullptr;
+
+	job.phase = Phase::Annotations;
+	result->annotations.SetFilename(job.filepath.string());
+	result->annotations.Load();
+	ReloadPinInfos(result->annotations, result->board.get());
+
+	return result;
+}
+
+/*
+ * Pins are tested against the outline as it is and flipped upside down, through an edge table of
+ * the outline filed in horizontal bands. Testing a pin against the flipped outline is testing it
+ * mirrored against the outline, so the outline is only flipped once, if the flipped one wins.
+ * Pins go in rounds spread over the whole board, the check stops once the difference between the
+ * two counts is far beyond chance, big boards rarely need all of their pins tested.
+ */
+int EPCCheck(Board *board) {
+	constexpr size_t kFirstRound = 4096; // pins, doubling each round
+	constexpr double kDecisive   = 4.0;  // standard deviations between the counts to stop early
+	constexpr int kMinDifference = 16;   // pins, so a few odd ones don't decide
+
+	auto &outline = board->OutlinePoints();
+
+	if (outline.empty()) {
+		return 1;
+	};
+
+	/*
+	 * As the check always did: the first contour is taken to start at (0, 0), so the segments joining
+	 * contours are usually counted, and the board flips around the highest point of the outline, or
+	 * around 0 when it is all below (the highest y was seeded with FLT_MIN)
+	 */
+	Point origin;
+	OutlineEdges edges;
+	edges.build(*board, false, &origin);
+	float max_y = std::max(edges.max().y, FLT_MIN);
+
+	// A pin inside the outline has an odd number of crossings on both sides
+	auto outside = [&edges](double x, double y) {
+		int l, r;
+		edges.crossings(x, y, l, r);
+		// If either side has no intersections, then it's out of bounds (likely)
+		return (l % 2 == 0) && (r % 2 == 0);
+	};
+
+	// Visit the pins in a spread out order: i * stride mod count, with the stride prime to count
+	auto &store   = board->Store();
+	size_t count  = store.pin_x.size();
+	size_t stride = count > 1 ? 2654435761u % count : 1;
+	if (stride == 0) stride = 1;
+	while (count > 1 && std::gcd(stride, count) != 1) stride++;
+
+	int epc[2] = {0, 0};
+	std::atomic<int> only[2] = {0, 0}; // pins out of one outline and not the other
+	size_t tested = 0;
+	for (size_t round = kFirstRound; tested < count; round *= 2) {
+		size_t n = std::min(round, count - tested);
+		std::atomic<int> out[2] = {0, 0};
+		parallel_for_ranges(n, 1024, [&](size_t begin, size_t end) {
+			int local_out[2] = {0, 0}, local_only[2] = {0, 0};
+			for (size_t k = begin; k < end; k++) {
+				size_t i  = ((tested + k) * stride) % count;
+				bool out0 = outside(store.pin_x[i], store.pin_y[i]);
+				bool out1 = outside(store.pin_x[i], max_y - store.pin_y[i]);
+				local_out[0] += out0;
+				local_out[1] += out1;
+				local_only[0] += out0 && !out1;
+				local_only[1] += out1 && !out0;
+			}
+			for (int side = 0; side < 2; side++) {
+				out[side] += local_out[side];
+				only[side] += local_only[side];
+			}
+		});
+		epc[0] += out[0];
+		epc[1] += out[1];
+		tested += n;
+
+		// Sign test on the pins the two outlines disagree on
+		int difference = std::abs(only[0] - only[1]);
+		if (tested < count && difference >= kMinDifference && difference > kDecisive * std::sqrt(double(only[0] + only[1]))) break;
+	}
+
+	SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "EPC[0]: %d, EPC[1]: %d of %zu pins tested", epc[0], epc[1], tested);
+
+	// flip the outline
+	if ((epc[0] || epc[1]) && (epc[0] > epc[1])) {
+		for (auto &p : outline) p->y = max_y - p->y;
+	}
+
+	return 0;
+}
+
+void ReloadPinInfos(Annotations &m_annotations, Board *m_board) {
+	m_annotations.RefreshPinInfos();
+	for (auto &part : m_board->Components()) {
+		if (m_annotations.partInfos.count(std::string(part->name)) == 0) continue;
+		auto& partInfo = m_annotations.partInfos[std::string(part->name)];
+		part->set_part_type(partInfo.part_type);
+		auto &pins = partInfo.pins;
+		for (auto &pin : part->pins) {
+			if (pins.count(std::string(pin->name)) == 0) continue;
+			auto &pinInfo = pins[std::string(pin->name)];
+			if (pinInfo.diode.size() > 0) pin->set_value(Pin::kValueDiode, pinInfo.diode);
+			if (pinInfo.voltage.size() > 0) pin->set_value(Pin::kValueVoltage, pinInfo.voltage);
+			if (pinInfo.ohm.size() > 0) pin->set_value(Pin::kValueOhm, pinInfo.ohm);
+			if (pinInfo.ohm_black.size() > 0) pin->set_value(Pin::kValueOhmBlack, pinInfo.ohm_black);
+			if (pinInfo.voltage_flag != PinVoltageFlag::unknown) pin->voltage_flag = pinInfo.voltage_flag;
+		}
+		part->angle = partInfo.angle;
+		if (partInfo.angle != PartAngle::unknown) {
+			auto& pins = part->pins;
+			// build from pins
+			auto A1PinIter = std::find_if(pins.cbegin(), pins.cend(), [](auto& p) {
+				return p->name == "A1";
+			});
+			if (A1PinIter != pins.cend()) {
+				auto& a1Pin = *A1PinIter;
+				auto& max = *std::max_element(pins.cbegin(), pins.cend(), [](auto& l, auto& r){
+					return l->name < r->name;
+				});
+
+				using namespace linalg::aliases;
+				using transformMatrix_t = int3x3;
+
+				transformMatrix_t logicScreenToDataMatrix = {
+				    {1, 0, 0},
+				    {0, -1, 0},
+				    {0, 0, 1},
+				};
+
+				auto key = max->name;
+				auto m = std::atoi(key.data() + 1); // index begin  1
+				auto n = key[0] - 'A' + 1; //index begin 0
+				if (key[0] > 'I')
+					n--;
+
+				auto aMaxIter = std::find_if(pins.cbegin(), pins.cend(), [t = "A" + std::to_string(m)](auto& p){
+					return p->name == t;
+				});
+				if (aMaxIter == pins.cend()) {
+					return;
+				}
+
+				auto& aMax = *aMaxIter;
+				float2 xAsixVec{a1Pin->position().x - aMax->position().x, a1Pin->position().y - aMax->position().y};
+				transformMatrix_t logicScreenToA1LogicMatrix;
+				if (abs(xAsixVec.x) > abs(xAsixVec.y)) {
+					logicScreenToA1LogicMatrix = {
+						{a1Pin->position().x > max->position().x ? -1 : 1, 0, xAsixVec.x > 0 ? n : -n},
+						{0, a1Pin->position().y > max->position().y ? -1 : 1, 0},
+						{0, 0, 1},
+					};
+				} else {
+					return;
+				}
+				
+				
+				auto o1 = linalg::mul(logicScreenToA1LogicMatrix, int3{n, m, 1});
+				transformMatrix_t a1LogincToLogicScreenMatrix = linalg::inverse(logicScreenToA1LogicMatrix);
+				
+				auto orgin = linalg::mul(a1LogincToLogicScreenMatrix, int3{0, 0, 1});
+				vector<vector<Pin*>> matrixPin(n, vector<Pin*>(m));
+				auto printMatrix = [](const auto& matrix) {
+					auto n = matrix.size();
+					auto m = matrix[0].size();
+					for (int i=0;i<n;i++) {
+						for (int j=0;j<m;j++) {
+							auto pin = matrix[i][j];
+							printf("%s ", pin ? pin->name.data(): "__");
+						}
+						printf("\n");
+					}
+				};
+
+				for (auto &pin : part->pins) {
+					auto& name = pin->name;
+					auto m1 = std::atoi(name.data() + 1) - 1;
+					auto n1 = name[0] - 'A';
+					if (name[0] > 'I')
+						n1--;
+						
+					if (partInfo.angle == PartAngle::_270) {
+						
+					}
+					matrixPin[n1][m1] = pin.get();
+				}
+				printMatrix(matrixPin);
+			}
+		}
+	}
+}
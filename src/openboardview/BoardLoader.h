@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Board.h"
+#include "FileFormats/BRDFileBase.h"
+#include "FileFormats/CacheFile.h"
+#include "annotations.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "filesystem_impl.h"
+
+/*
+ * Loads a board file on a worker thread so the UI keeps drawing while big files are opened.
+ * The whole pipeline runs there: read, parse, build the Board model, outline checks, annotations
+ * and pin infos. Parsed files are cached on disk (see CacheFile) when a cache directory is set,
+ * the worker writes the cache after the board is handed over.
+ * The UI polls TakeResult() once per frame and swaps the finished board in at once.
+ *
+ * Starting a new load cancels the one in progress. A cancelled load stops at the next line its
+ * parser reads or loop it checks (see load_cancelled()), or at the next phase boundary, and its thread
+ * is joined once it is done.
+ */
+class BoardLoader {
+  public:
+	enum class Phase { Read, Parse, BuildModel, Geometry, Annotations, Done };
+
+	struct Result {
+		filesystem::path filepath;
+		std::unique_ptr<BRDFileBase> file;
+		std::unique_ptr<Board> board;
+		Annotations annotations;
+		std::string error_msg;
+
+		bool valid() const {
+			return file && file->valid && board;
+		}
+	};
+
+	~BoardLoader();
+
+	void SetCacheDir(const filesystem::path &dir);
+	void SetFZKey(const uint32_t key[44]);
+	// Returns false and sets error_msg if the load can't start
+	bool Start(const filesystem::path &filepath, std::string &error_msg);
+	void Cancel();
+	bool Busy() const;
+	Phase CurrentPhase() const;
+	const filesystem::path &CurrentFilepath() const;
+
+	// Returns the finished load once, nullptr while loading or idle
+	std::unique_ptr<Result> TakeResult();
+
+	static const char *PhaseName(Phase phase);
+	static float PhaseProgress(Phase phase);
+
+  private:
+	struct Job {
+		filesystem::path filepath;
+		filesystem::path cache_dir;
+		std::array<uint32_t, 44> fzkey;
+		std::atomic<Phase> phase{Phase::Read};
+		std::atomic<bool> cancelled{false};
+		std::atomic<bool> finished{false};
+		std::atomic<bool> exited{false}; // the worker is done, the cache written
+		std::unique_ptr<Result> result;  // written by the worker before finished is set
+		filesystem::path cachepath;
+		std::vector<char> cache_image; // written to cachepath once the result is handed over
+	};
+
+	static void Run(std::shared_ptr<Job> job);
+	static std::unique_ptr<Result> Load(Job &job);
+	static std::unique_ptr<BRDFileBase> LoadCache(const filesystem::path &cachepath, const SourceStamp &stamp);
+	void Reap(bool wait);
+
+	filesystem::path cache_dir;
+	std::array<uint32_t, 44> fzkey{};
+	std::shared_ptr<Job> current;
+	std::vector<std::pair<std::thread, std::shared_ptr<Job>>> workers;
+};
+
+// Checks for a flipped board outline by counting pins outside of it for both orientations
+int EPCCheck(Board *board);
+
+// Reads the pin infos (.yaml) next to the board and applies them to its parts and pins
+void ReloadPinInfos(Annotations &m_annotations, Board *m_board);
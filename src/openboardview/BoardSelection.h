@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Board.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct BitVec {
+	std::vector<uint64_t> m_bits;
+	// length of the BitVec in bits
+	uint32_t m_size = 0;
+
+	void Resize(uint32_t new_size) {
+		m_bits.resize((new_size + 63) / 64, 0);
+		if (new_size & 63) m_bits.back() &= (uint64_t(1) << (new_size & 63)) - 1; // drop bits past the end
+		m_size = new_size;
+	}
+
+	bool operator[](uint32_t index) const {
+		return 0 != (m_bits[index >> 6] & (uint64_t(1) << (index & 63)));
+	}
+
+	void Set(uint32_t index, bool val) {
+		uint64_t &slot = m_bits[index >> 6];
+		uint64_t bit   = uint64_t(1) << (index & 63);
+		slot &= ~bit;
+		if (val) {
+			slot |= bit;
+		}
+	}
+
+	void Clear() {
+		std::fill(m_bits.begin(), m_bits.end(), 0);
+	}
+};
+
+/*
+ * A set of board elements of one kind: bits indexed by the element index (Pin::index,
+ * Component::index) so drawing looks each element up in constant time, and the elements in the
+ * order they were added for the lists and searches that go through them.
+ * generation() changes whenever the set does, for what is drawn from it.
+ */
+template <class T>
+class ElementSet {
+  public:
+	using iterator = typename SharedVector<T>::const_iterator;
+
+	// Empties the set, for a board of count elements
+	void reset(uint32_t count) {
+		elements.clear();
+		elements.reserve(count);
+		bits.Resize(0);
+		bits.Resize(count);
+		changes++;
+	}
+
+	bool contains(const std::shared_ptr<T> &element) const {
+		return element && contains(element->index);
+	}
+	bool contains(uint32_t index) const {
+		return index < bits.m_size && bits[index];
+	}
+
+	// false if it was already in, or isn't an element of the board the set was reset() for
+	bool insert(const std::shared_ptr<T> &element) {
+		assert(element && element->index < bits.m_size);
+		if (!element || element->index >= bits.m_size || contains(element)) return false;
+		bits.Set(element->index, true);
+		elements.push_back(element);
+		changes++;
+		return true;
+	}
+
+	// false if it wasn't in
+	bool erase(const std::shared_ptr<T> &element) {
+		if (!contains(element)) return false;
+		bits.Set(element->index, false);
+		elements.erase(std::find(elements.begin(), elements.end(), element));
+		changes++;
+		return true;
+	}
+
+	void clear() {
+		if (elements.empty()) return;
+		bits.Clear();
+		elements.clear();
+		changes++;
+	}
+
+	size_t size() const {
+		return elements.size();
+	}
+	bool empty() const {
+		return elements.empty();
+	}
+	iterator begin() const {
+		return elements.begin();
+	}
+	iterator end() const {
+		return elements.end();
+	}
+
+	uint32_t generation() const {
+		return changes;
+	}
+
+  private:
+	BitVec bits;
+	SharedVector<T> elements;
+	uint32_t changes = 0;
+};
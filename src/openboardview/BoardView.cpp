@@ -5,10 +5,12 @@
 #include "utils.h"
 #include "version.h"
 
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <climits>
 #include <memory>
+#include <numeric>
 #include <cstdio>
 #ifdef ENABLE_SDL2
 #include <SDL.h>
@@ -17,7 +19,6 @@
 
 #include "BRDBoard.h"
 #include "Board.h"
-#include "FileFormats/BVR3File.h"
 #include "annotations.h"
 #include "imgui/imgui.h"
 #include "imgui/misc/cpp/imgui_stdlib.h"
@@ -25,6 +26,7 @@
 #include "NetList.h"
 #include "PartList.h"
 #include "vectorhulls.h"
+#include "Renderers/Renderers.h"
 
 #include "../linalg.hpp"
 
@@ -290,12 +292,14 @@ int BoardView::ConfigParse(void) {
 	showPartName              = obvconfig.ParseBool("showPartName", true);
 	showPinName               = obvconfig.ParseBool("showPinName", true);
 	showPartType              = obvconfig.ParseBool("showPartType", true);
+	hideOverlappingLabels     = obvconfig.ParseBool("hideOverlappingLabels", false);
 	showMode                  = (ShowMode)obvconfig.ParseInt("showMode", ShowMode_Diode);
 	m_centerZoomSearchResults = obvconfig.ParseBool("centerZoomSearchResults", true);
 	flipMode                  = obvconfig.ParseInt("flipMode", 0);
 
 	boardFill        = obvconfig.ParseBool("boardFill", true);
 	boardFillSpacing = obvconfig.ParseInt("boardFillSpacing", 3);
+	tileCacheSize    = obvconfig.ParseInt("tileCacheSize", 64);
 
 	zoomFactor   = obvconfig.ParseInt("zoomFactor", 10) / 10.0f;
 	zoomModifier = obvconfig.ParseInt("zoomModifier", 5);
@@ -312,6 +316,7 @@ int BoardView::ConfigParse(void) {
 	annotationBoxOffset = DPI(annotationBoxOffset);
 
 	netWebThickness = obvconfig.ParseInt("netWebThickness", 2);
+	netWebStar      = obvconfig.ParseBool("netWebStar", false);
 
 	/*
 	 * Some machines (Atom etc) don't have enough CPU/GPU
@@ -416,179 +421,102 @@ static vector<vector<Pin*>> rotateMatrix90Counterclockwise(const vector<vector<P
     
     return result;
 }
-void ReloadPinInfos(Annotations &m_annotations, Board *m_board) {
-	m_annotations.RefreshPinInfos();
-	for (auto &part : m_board->Components()) {
-		if (m_annotations.partInfos.count(part->name) == 0) continue;
-		auto& partInfo = m_annotations.partInfos[part->name];
-		part->set_part_type(partInfo.part_type);
-		auto &pins = partInfo.pins;
-		for (auto &pin : part->pins) {
-			if (pins.count(pin->name) == 0) continue;
-			auto &pinInfo = pins[pin->name];
-			if (pinInfo.diode.size() > 0) pin->diode_value = pinInfo.diode;
-			if (pinInfo.voltage.size() > 0) pin->voltage_value = pinInfo.voltage;
-			if (pinInfo.ohm.size() > 0) pin->ohm_value = pinInfo.ohm;
-			if (pinInfo.ohm_black.size() > 0) pin->ohm_black_value = pinInfo.ohm_black;
-			if (pinInfo.voltage_flag != PinVoltageFlag::unknown) pin->voltage_flag = pinInfo.voltage_flag;
-		}
-		part->angle = partInfo.angle;
-		if (partInfo.angle != PartAngle::unknown) {
-			auto& pins = part->pins;
-			// build from pins
-			auto A1PinIter = std::find_if(pins.cbegin(), pins.cend(), [](auto& p) {
-				return p->name == "A1";
-			});
-			if (A1PinIter != pins.cend()) {
-				auto& a1Pin = *A1PinIter;
-				auto& max = *std::max_element(pins.cbegin(), pins.cend(), [](auto& l, auto& r){
-					return l->name < r->name;
-				});
-
-				using namespace linalg::aliases;
-				using transformMatrix_t = int3x3;
+/*
+ * Starts loading filepath in the background, the board is swapped in by
+ * UpdateBoardLoader() once it is ready. Cancels a load still in progress.
+ */
+int BoardView::LoadFile(const filesystem::path &filepath) {
+	if (filepath.empty()) return 1;
 
-				transformMatrix_t logicScreenToDataMatrix = {
-				    {1, 0, 0},
-				    {0, -1, 0},
-				    {0, 0, 1},
-				};
+	SetLastFileOpenName(filepath.string());
+	m_error_msg.clear();
+	if (!boardLoader.Start(filepath, m_error_msg)) {
+		m_lastFileOpenWasInvalid = true;
+		return 1;
+	}
 
-				auto key = max->name;
-				auto m = std::atoi(key.data() + 1); // index begin  1
-				auto n = key[0] - 'A' + 1; //index begin 0
-				if (key[0] > 'I')
-					n--;
+	return 0;
+}
 
-				auto aMaxIter = std::find_if(pins.cbegin(), pins.cend(), [t = "A" + std::to_string(m)](auto& p){
-					return p->name == t;
-				});
-				if (aMaxIter == pins.cend()) {
-					return;
-				}
+/*
+ * Publishes a finished load, the previous board is replaced within a single frame
+ */
+void BoardView::UpdateBoardLoader() {
+	auto result = boardLoader.TakeResult();
+	if (!result) return;
 
-				auto& aMax = *aMaxIter;
-				float2 xAsixVec{a1Pin->position.x - aMax->position.x, a1Pin->position.y - aMax->position.y};
-				transformMatrix_t logicScreenToA1LogicMatrix;
-				if (abs(xAsixVec.x) > abs(xAsixVec.y)) {
-					logicScreenToA1LogicMatrix = {
-						{a1Pin->position.x > max->position.x ? -1 : 1, 0, xAsixVec.x > 0 ? n : -n},
-						{0, a1Pin->position.y > max->position.y ? -1 : 1, 0},
-						{0, 0, 1},
-					};
-				} else {
-					return;
-				}
-				
-				
-				auto o1 = linalg::mul(logicScreenToA1LogicMatrix, int3{n, m, 1});
-				transformMatrix_t a1LogincToLogicScreenMatrix = linalg::inverse(logicScreenToA1LogicMatrix);
-				
-				auto orgin = linalg::mul(a1LogincToLogicScreenMatrix, int3{0, 0, 1});
-				vector<vector<Pin*>> matrixPin(n, vector<Pin*>(m));
-				auto printMatrix = [](const auto& matrix) {
-					auto n = matrix.size();
-					auto m = matrix[0].size();
-					for (int i=0;i<n;i++) {
-						for (int j=0;j<m;j++) {
-							auto pin = matrix[i][j];
-							printf("%s ", pin ? pin->name.c_str(): "__");
-						}
-						printf("\n");
-					}
-				};
-
-				for (auto &pin : part->pins) {
-					auto& name = pin->name;
-					auto m1 = std::atoi(name.data() + 1) - 1;
-					auto n1 = name[0] - 'A';
-					if (name[0] > 'I')
-						n1--;
-						
-					if (partInfo.angle == PartAngle::_270) {
-						
-					}
-					matrixPin[n1][m1] = pin.get();
-				}
-				printMatrix(matrixPin);
-			}
+	if (!result->valid()) {
+		m_error_msg = result->error_msg;
+		if (result->file && !result->file->error_msg.empty()) {
+			if (!m_error_msg.empty()) m_error_msg += "\n";
+			m_error_msg += result->file->error_msg;
 		}
+		m_lastFileOpenWasInvalid = true;
+		return;
 	}
-}
 
-int BoardView::LoadFile(const filesystem::path &filepath) {
-	m_lastFileOpenWasInvalid = true;
-	m_validBoard             = false;
-	if (!filepath.empty()) {
-		// clean up the previous file.
-		if (m_file && m_board) {
-			m_pinHighlighted.clear();
-			m_partHighlighted.clear();
-			m_annotations.Close();
-			m_board->Nets().clear();
-			m_board->Pins().clear();
-			m_board->Components().clear();
-			m_board->OutlinePoints().clear();
-			m_board->OutlineSegments().clear();
-			//	delete m_file;
-			// delete m_board;
-		}
-		delete m_file;
-		m_file = nullptr;
-		m_validBoard = false;
-		m_error_msg.clear();
-		pdfBridge.CloseDocument();
-
-		SetLastFileOpenName(filepath.string());
-		std::vector<char> buffer = file_as_buffer(filepath, m_error_msg);
-		if (!buffer.empty()) {
-			if (BVR3File::verifyFormat(buffer))
-				m_file = new BVR3File(buffer);
-			else
-				m_error_msg = "Unrecognized file format.";
-
-			if (m_file && m_file->valid) {
-				LoadBoard(m_file);
-				fhistory.Prepend_save(filepath.string());
-				history_file_has_changed = 1; // used by main to know when to update the window title
-				boardMinMaxDone          = false;
-				m_rotation               = 0;
-				m_current_side           = kBoardSideTop;
-				EPCCheck(); // check to see we don't have a flipped board outline
-
-				m_annotations.SetFilename(filepath.string());
-				m_annotations.Load();
-
-				auto conffilepath = filepath;
-				conffilepath.replace_extension("conf");
-				backgroundImage.loadFromConfig(conffilepath);
-				pdfFile.loadFromConfig(conffilepath);
-
-				pdfBridge.OpenDocument(pdfFile);
-
-				/*
-				 * Set pins to a known lower size, they get resized
-				 * in DrawParts() when the component is analysed
-				 */
-				for (auto &p : m_board->Pins()) {
-					//					auto p      = pin.get();
-					if (p->diameter <= 0)
-						p->diameter = 7;
-				}
+	// clean up the previous file.
+	if (m_file && m_board) {
+		m_pinHighlighted.clear();
+		m_partHighlighted.clear();
+		m_annotations.Close();
+		m_board->Nets().clear();
+		m_board->Pins().clear();
+		m_board->Components().clear();
+		m_board->OutlinePoints().clear();
+		m_board->OutlineSegments().clear();
+	}
+	// Nothing may point into the previous board once it is gone
+	m_pinSelected           = nullptr;
+	m_viaSelected           = nullptr;
+	m_pinHighlightedHovered = nullptr;
+	currentlyHoveredPin     = nullptr;
+	currentlyHoveredPart    = nullptr;
+	delete m_board;
+	delete m_file;
+	m_validBoard = false;
+	pdfBridge.CloseDocument();
+
+	m_file        = result->file.release();
+	m_annotations = std::move(result->annotations);
+	LoadBoard(result->board.release());
+
+	auto &filepath = result->filepath;
+	fhistory.Prepend_save(filepath.string());
+	history_file_has_changed = 1; // used by main to know when to update the window title
+	m_rotation               = 0;
+	m_current_side           = kBoardSideTop;
+
+	auto conffilepath = filepath;
+	conffilepath.replace_extension("conf");
+	backgroundImage.loadFromConfig(conffilepath);
+	pdfFile.loadFromConfig(conffilepath);
+
+	pdfBridge.OpenDocument(pdfFile);
+
+	CenterView();
+	m_lastFileOpenWasInvalid = false;
+	m_validBoard             = true;
+	m_error_msg.clear();
+}
 
-				ReloadPinInfos(m_annotations, m_board);
+/*
+ * Progress of the board being loaded, drawn over the current board
+ */
+void BoardView::ShowLoadingProgress() {
+	if (!boardLoader.Busy()) return;
 
-				CenterView();
-				m_lastFileOpenWasInvalid = false;
-				m_validBoard             = true;
-				m_error_msg.clear();
-			}
-		}
-	} else {
-		return 1;
-	}
+	ImGuiIO &io = ImGui::GetIO();
+	auto phase  = boardLoader.CurrentPhase();
 
-	return 0;
+	ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y * 0.5f), 0, ImVec2(0.5f, 0.5f));
+	ImGui::Begin("Loading",
+	             nullptr,
+	             ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_AlwaysAutoResize |
+	                 ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
+	ImGui::Text("Loading %s", boardLoader.CurrentFilepath().filename().string().c_str());
+	ImGui::ProgressBar(BoardLoader::PhaseProgress(phase), ImVec2(DPIF(300.0f), 0.0f), BoardLoader::PhaseName(phase));
+	ImGui::End();
 }
 
 void BoardView::SetFZKey(const char *keytext) {
@@ -622,6 +550,7 @@ void BoardView::SetFZKey(const char *keytext) {
 			}
 		}
 	}
+	boardLoader.SetFZKey(FZKey);
 }
 
 void RA(const char *t, int w) {
@@ -1006,6 +935,10 @@ void BoardView::Preferences(void) {
 			obvconfig.WriteBool("showNetWeb", showNetWeb);
 		}
 
+		if (ImGui::Checkbox("Net web from the selected pin", &netWebStar)) {
+			obvconfig.WriteBool("netWebStar", netWebStar);
+		}
+
 		if (ImGui::Checkbox("slowCPU", &slowCPU)) {
 			obvconfig.WriteBool("slowCPU", slowCPU);
 			style.AntiAliasedLines = !slowCPU;
@@ -1344,7 +1277,7 @@ void BoardView::ShowInfoPane(void) {
 
 			ImGui::Text(" ");
 
-			if (ImGui::SmallButton(part->name.c_str())) {
+			if (ImGui::SmallButton(part->name.data())) {
 				if (!BoardElementIsVisible(part)) FlipBoard();
 				if (part->centerpoint.x && part->centerpoint.y) {
 					ImVec2 psz;
@@ -1364,14 +1297,14 @@ void BoardView::ShowInfoPane(void) {
 
 					SetTarget(part->centerpoint.x, part->centerpoint.y);
 				} else {
-					SetTarget(part->pins[0]->position.x, part->pins[0]->position.y);
+					SetTarget(part->pins[0]->position().x, part->pins[0]->position().y);
 				}
 				m_needsRedraw = 1;
 			}
 			ImGui::SameLine();
 			{
 				char bn[128];
-				snprintf(bn, sizeof(bn), "Z##%s", part->name.c_str());
+				snprintf(bn, sizeof(bn), "Z##%s", part->name.data());
 				if (ImGui::SmallButton(bn)) {
 					if (!BoardElementIsVisible(part)) FlipBoard();
 					if (part->centerpoint.x && part->centerpoint.y) {
@@ -1390,7 +1323,7 @@ void BoardView::ShowInfoPane(void) {
 
 						SetTarget(part->centerpoint.x, part->centerpoint.y);
 					} else {
-						SetTarget(part->pins[0]->position.x, part->pins[0]->position.y);
+						SetTarget(part->pins[0]->position().x, part->pins[0]->position().y);
 					}
 					m_needsRedraw = 1;
 				}
@@ -1401,15 +1334,15 @@ void BoardView::ShowInfoPane(void) {
 			ImGui::SameLine();
 			{
 				char name_and_id[128];
-				snprintf(name_and_id, sizeof(name_and_id), "Copy##%s", part->name.c_str());
+				snprintf(name_and_id, sizeof(name_and_id), "Copy##%s", part->name.data());
 				if (ImGui::SmallButton(name_and_id)) {
 					// std::string speed is no concern here, since button action is not in UI rendering loop
-					std::string to_copy = part->name;
+					std::string to_copy(part->name);
 					if (part->mfgcode.size()) {
 						to_copy += " " + part->mfgcode;
 					}
 					for (const auto &pin : part->pins) {
-						to_copy += "\n" + pin->name + " " + pin->net->name;
+						to_copy += "\n" + std::string(pin->name) + " " + std::string(pin->net->name);
 					}
 					ImGui::SetClipboardText(to_copy.c_str());
 				}
@@ -1418,9 +1351,9 @@ void BoardView::ShowInfoPane(void) {
 			{
 				static bool wholeWordsOnly = true;
 				static bool caseSensitive = false;
-				std::string pdfButtonName = "PDF Search##" + part->name;
+				std::string pdfButtonName = "PDF Search##" + std::string(part->name);
 				if (ImGui::SmallButton(pdfButtonName.c_str())) {
-					pdfBridge.DocumentSearch(part->name, wholeWordsOnly, caseSensitive);
+					pdfBridge.DocumentSearch(std::string(part->name), wholeWordsOnly, caseSensitive);
 				}
 				ImGui::SameLine();
 				ImGui::Checkbox("Whole words only", &wholeWordsOnly);
@@ -1434,7 +1367,7 @@ void BoardView::ShowInfoPane(void) {
 			 * Generate the pin# and net table
 			 */
 			ImGui::PushItemWidth(-1);
-			std::string str = std::string("##") + part->name;
+			std::string str = "##" + std::string(part->name);
 			ImVec2 listSize;
 			int pc = part->pins.size();
 			if (pc > 20) pc = 20;
@@ -1442,21 +1375,18 @@ void BoardView::ShowInfoPane(void) {
 			if (ImGui::BeginListBox(str.c_str(), listSize)) { //, ImVec2(m_board_surface.x/3 -5, m_board_surface.y/2));
 				for (auto pin : part->pins) {
 					char ss[1024];
-					snprintf(ss, sizeof(ss), "%4s  %s", pin->name.c_str(), pin->net->name.c_str());
+					snprintf(ss, sizeof(ss), "%4s  %s", pin->name.data(), pin->net->name.data());
 					if (ImGui::Selectable(ss, (pin == m_pinSelected))) {
 						ClearAllHighlights();
 
 						if ((pin->type == Pin::kPinTypeNotConnected) || (pin->type == Pin::kPinTypeUnkown) || (pin->net->is_ground)) {
-							m_partHighlighted.push_back(pin->component);
+							m_partHighlighted.insert(pin->component);
 							// do nothing for now
 							//
 						} else {
 							m_pinSelected = pin;
-							for (auto p : m_partHighlighted) {
-								pin->component->visualmode = pin->component->CVMNormal;
-							};
-							m_partHighlighted.push_back(pin->component);
-							CenterZoomNet(pin->net->name);
+							m_partHighlighted.insert(pin->component);
+							CenterZoomNet(std::string(pin->net->name));
 						}
 						m_needsRedraw = true;
 					}
@@ -1529,15 +1459,20 @@ void BoardView::ContextMenu(void) {
 			 * find the closest pin, starting at no more than
 			 * 1 radius away
 			 */
+			float radius = min_dist;
 			min_dist *= min_dist; // all distance squared
 			Pin *selection = nullptr;
-			for (auto &pin : m_board->Pins()) {
-				if (BoardElementIsVisible(pin->component)) {
-					float dx   = pin->position.x - pos.x;
-					float dy   = pin->position.y - pos.y;
+			const auto &store = m_board->Store();
+			std::vector<uint32_t> hits;
+			Index().pins.query(ImVec2(pos.x - radius, pos.y - radius), ImVec2(pos.x + radius, pos.y + radius), hits);
+			for (uint32_t i : hits) {
+				uint32_t component = store.pin_component[i];
+				if (component == BoardStore::kNone || SideIsVisible(store.component_side[component])) {
+					float dx   = store.pin_x[i] - pos.x;
+					float dy   = store.pin_y[i] - pos.y;
 					float dist = dx * dx + dy * dy;
 					if (dist < min_dist) {
-						selection = pin.get();
+						selection = m_board->Pins()[i].get();
 						min_dist  = dist;
 					}
 				}
@@ -1561,23 +1496,14 @@ void BoardView::ContextMenu(void) {
 				* but haven't decided what to do in such a situation
 				*/
 
-			for (auto &part : m_board->Components()) {
-				int hit = 0;
-				//					auto p_part = part.get();
+			Index().parts.query(pos, hits);
+			for (uint32_t i : hits) {
+				auto &part = m_board->Components()[i];
 
 				if (!BoardElementIsVisible(part)) continue;
 
 				// Work out if the point is inside the hull
-				{
-					auto poly = part->outline;
-
-					for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
-						if (((poly[i].y > pos.y) != (poly[j].y > pos.y)) &&
-							(pos.x < (poly[j].x - poly[i].x) * (pos.y - poly[i].y) / (poly[j].y - poly[i].y) + poly[i].x))
-							hit = !hit;
-					}
-				} // hull test
-				if (hit) {
+				if (BoardIndex::part_contains(*part, pos)) {
 					selection_component = part.get();
 					if (selection != nullptr) {
 						partn = part->name;
@@ -1665,10 +1591,10 @@ void BoardView::ContextMenu(void) {
 					static bool inferValueMode;
 					static PartAngle partAngleNew;
 					auto init_fun = [](Pin* selection) {
-						memcpy(diodeNew, selection->diode_value.c_str(), std::min<size_t >(sizeof(diodeNew), selection->diode_value.size()));
-						memcpy(voltageNew, selection->voltage_value.c_str(), std::min<size_t>(sizeof(diodeNew), selection->voltage_value.size()));
-						memcpy(ohmNew, selection->ohm_value.c_str(), std::min<size_t>(sizeof(ohmNew), selection->ohm_value.size()));
-						memcpy(ohmBlackNew, selection->ohm_black_value.c_str(), std::min<size_t>(sizeof(ohmBlackNew), selection->ohm_black_value.size()));
+						memcpy(diodeNew, selection->value(Pin::kValueDiode).data(), std::min<size_t >(sizeof(diodeNew), selection->value(Pin::kValueDiode).size()));
+						memcpy(voltageNew, selection->value(Pin::kValueVoltage).data(), std::min<size_t>(sizeof(diodeNew), selection->value(Pin::kValueVoltage).size()));
+						memcpy(ohmNew, selection->value(Pin::kValueOhm).data(), std::min<size_t>(sizeof(ohmNew), selection->value(Pin::kValueOhm).size()));
+						memcpy(ohmBlackNew, selection->value(Pin::kValueOhmBlack).data(), std::min<size_t>(sizeof(ohmBlackNew), selection->value(Pin::kValueOhmBlack).size()));
 						voltageFlagNew = selection->voltage_flag;
 					};
 					if (m_annotationnew_retain == false) {
@@ -1756,21 +1682,26 @@ void BoardView::ContextMenu(void) {
 							fprintf(stderr, "DATA:'%s'\n\n", contextbufnew);
 						}
 						if (pinMode) {
-							auto& pinInfo = m_annotations.NewPinInfo(selection->component->name.c_str(), selection->name.c_str());
-							pinInfo.diode = selection->diode_value = diodeNew;
-							pinInfo.voltage = selection->voltage_value = voltageNew;
-							pinInfo.ohm = selection->ohm_value = ohmNew;
-							pinInfo.ohm_black = selection->ohm_black_value = ohmBlackNew;					
+							auto& pinInfo = m_annotations.NewPinInfo(selection->component->name.data(), selection->name.data());
+							pinInfo.diode     = diodeNew;
+							pinInfo.voltage   = voltageNew;
+							pinInfo.ohm       = ohmNew;
+							pinInfo.ohm_black = ohmBlackNew;
+							selection->set_value(Pin::kValueDiode, pinInfo.diode);
+							selection->set_value(Pin::kValueVoltage, pinInfo.voltage);
+							selection->set_value(Pin::kValueOhm, pinInfo.ohm);
+							selection->set_value(Pin::kValueOhmBlack, pinInfo.ohm_black);
 							pinInfo.voltage_flag = selection->voltage_flag = voltageFlagNew;					
 						}
 						if (selection_component) {
-							auto& partInfo = m_annotations.NewPartInfo(selection_component->name.c_str());;
+							auto& partInfo = m_annotations.NewPartInfo(selection_component->name.data());;
 							partInfo.part_type = partTypeNew;
 							selection_component->set_part_type(partTypeNew);
 							if (partAngleNew != selection_component->angle) {
 								partInfo.angle = selection_component->angle = partAngleNew;
 							}
 						}
+						m_labels.invalidate(); // edited values or part type
 						m_annotations.SavePinInfos();
 
 						if (!std::string_view {contextbufnew}.empty()) {
@@ -1841,7 +1772,7 @@ const char *getcname(const std::string &name) {
 
 template <class T>
 const char *getcname(const T &t) {
-	return t->name.c_str();
+	return t->name.data();
 }
 
 template <class T>
@@ -2060,9 +1991,7 @@ void BoardView::ClearAllHighlights(void) {
 	ResetSearch();
 	m_needsRedraw      = true;
 	m_tooltips_enabled = true;
-	if (m_board != NULL) {
-		for (auto part : m_board->Components()) part->visualmode = part->CVMNormal;
-	}
+	m_partSelected.clear();
 	m_partHighlighted.clear();
 	m_pinHighlighted.clear();
 }
@@ -2088,6 +2017,8 @@ void BoardView::Update() {
 	 * ** FIXME
 	 * This should be handled in the keyboard section, not here
 	 */
+	UpdateBoardLoader();
+
 	if (keybindings.isPressed("Open")) {
 		open_file = true;
 		// the dialog will likely eat our WM_KEYUP message for CTRL and O:
@@ -2227,6 +2158,11 @@ void BoardView::Update() {
 				m_needsRedraw = true;
 			}
 
+			if (ImGui::Checkbox("Hide overlapping pin names", &hideOverlappingLabels)) {
+				obvconfig.WriteBool("hideOverlappingLabels", hideOverlappingLabels);
+				m_needsRedraw = true;
+			}
+
 			if (ImGui::Checkbox("Background image", &backgroundImage.enabled)) {
 				obvconfig.WriteBool("showBackgroundImage", backgroundImage.enabled);
 				m_needsRedraw = true;
@@ -2457,14 +2393,14 @@ void BoardView::Update() {
 	if (m_file && m_board && m_pinSelected) {
 		auto pin = m_pinSelected;
 		ImGui::Text("Part: %s   Pin: %s   Net: %s   Probe: %d   (%s.) Voltage: %s  Ohm: %s OhmBlack: %s",
-		            pin->component->name.c_str(),
-		            pin->name.c_str(),
-		            pin->net->name.c_str(),
+		            pin->component->name.data(),
+		            pin->name.data(),
+		            pin->net->name.data(),
 		            pin->net->number,
 		            pin->component->mount_type_str().c_str(),
-		            pin->voltage_value.c_str(),
-		            pin->ohm_value.c_str(),
-		            pin->ohm_black_value.c_str()
+		            pin->value(Pin::kValueVoltage).data(),
+		            pin->value(Pin::kValueOhm).data(),
+		            pin->value(Pin::kValueOhmBlack).data()
 					);
 	} else {
 		ImVec2 spos = ImGui::GetMousePos();
@@ -2537,6 +2473,7 @@ void BoardView::Update() {
 
 	// Overlay
 	RenderOverlay();
+	ShowLoadingProgress();
 
 	ImGui::PopStyleVar();
 
@@ -2668,35 +2605,40 @@ void BoardView::HandleInput() {
 					// float min_dist = m_pinDiameter * 1.0f;
 					float min_dist = m_pinDiameter / 2.0f;
 					min_dist *= min_dist; // all distance squared
-					std::shared_ptr<Pin> selection = nullptr;
-					for (auto &pin : m_board->Pins()) {
-						if (!pin->net->is_ground && BoardElementIsVisible(pin)) {
-							float dx   = pin->position.x - pos.x;
-							float dy   = pin->position.y - pos.y;
+					const auto &store = m_board->Store();
+					size_t selection  = BoardStore::kNone;
+					float radius      = m_pinDiameter / 2.0f;
+					std::vector<uint32_t> hits;
+					Index().pins.query(ImVec2(pos.x - radius, pos.y - radius), ImVec2(pos.x + radius, pos.y + radius), hits);
+					for (uint32_t i : hits) {
+						if (!store.pin_ground[i] && SideIsVisible(store.pin_side[i])) {
+							float dx   = store.pin_x[i] - pos.x;
+							float dy   = store.pin_y[i] - pos.y;
 							float dist = dx * dx + dy * dy;
-							if ((dist < std::max(pin->diameter * pin->diameter, min_dist))) {
-								selection = pin;
+							float d    = store.pin_diameter[i];
+							if ((dist < std::max(d * d, min_dist))) {
+								selection = i;
 								min_dist  = dist;
 							}
 						}
 					}
 
-					m_pinSelected = selection;
+					m_pinSelected = selection != BoardStore::kNone ? m_board->Pins()[selection] : nullptr;
 					if (m_pinSelected) {
 						if (!io.KeyCtrl) {
-							for (auto p : m_board->Components()) {
-								p->visualmode = p->CVMNormal;
-							}
-							m_partHighlighted.resize(0);
-							m_pinHighlighted.resize(0);
+							m_partSelected.clear();
+							m_partHighlighted.clear();
+							m_pinHighlighted.clear();
 						}
-						m_pinSelected->component->visualmode = m_pinSelected->component->CVMSelected;
-						m_partHighlighted.push_back(m_pinSelected->component);
+						m_partSelected.insert(m_pinSelected->component);
+						m_partHighlighted.insert(m_pinSelected->component);
 					}
 
 					m_viaSelected = nullptr;
 					if (m_pinSelected == nullptr) {
-						for (auto &via : m_board->Vias()) {
+						Index().vias.query(pos, hits);
+						for (uint32_t i : hits) {
+							auto &via = m_board->Vias()[i];
 							if (BoardElementIsVisible(via)) {
 								float dx   = via->position.x - pos.x;
 								float dy   = via->position.y - pos.y;
@@ -2710,35 +2652,24 @@ void BoardView::HandleInput() {
 					}
 
 					if (m_viaSelected) {
-						for (auto& pin : m_viaSelected->net->pins) m_pinHighlighted.push_back(pin);
+						for (auto& pin : m_viaSelected->net->pins) m_pinHighlighted.insert(pin);
 					}
 
 					if (m_pinSelected == nullptr && m_viaSelected == nullptr) {
 						bool any_hits = false;
 
-						for (auto &part : m_board->Components()) {
-							int hit = 0;
-							//							auto p_part = part.get();
+						Index().parts.query(pos, hits);
+						for (uint32_t i : hits) {
+							auto &part = m_board->Components()[i];
 
 							if (!BoardElementIsVisible(part)) continue;
 							if (part->component_type == Component::kComponentTypeBoard) continue;
 
 							// Work out if the point is inside the hull
-							{
-								auto poly = part->outline;
-
-								for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
-									if (((poly[i].y > pos.y) != (poly[j].y > pos.y)) &&
-									    (pos.x <
-									     (poly[j].x - poly[i].x) * (pos.y - poly[i].y) / (poly[j].y - poly[i].y) + poly[i].x))
-										hit ^= 1;
-								}
-							}
-
-							if (hit) {
+							if (BoardIndex::part_contains(*part, pos)) {
 								any_hits = true;
 
-								bool partInList = contains(part, m_partHighlighted);
+								bool partInList = m_partHighlighted.contains(part);
 
 								/*
 								 * If the CTRL key isn't held down, then we have to
@@ -2746,43 +2677,22 @@ void BoardView::HandleInput() {
 								 */
 								if (io.KeyCtrl) {
 									if (!partInList) {
-										m_partHighlighted.push_back(part);
-										part->visualmode = part->CVMSelected;
+										m_partHighlighted.insert(part);
+										m_partSelected.insert(part);
 									} else {
-										remove(part, m_partHighlighted);
-										part->visualmode = part->CVMNormal;
+										m_partHighlighted.erase(part);
+										m_partSelected.erase(part);
 									}
 
 								} else {
-									for (auto p : m_board->Components()) {
-										p->visualmode = p->CVMNormal;
-									}
-									m_partHighlighted.resize(0);
-									m_pinHighlighted.resize(0);
+									m_partSelected.clear();
+									m_partHighlighted.clear();
+									m_pinHighlighted.clear();
 									if (!partInList) {
-										m_partHighlighted.push_back(part);
-										part->visualmode = part->CVMSelected;
+										m_partHighlighted.insert(part);
+										m_partSelected.insert(part);
 									}
 								}
-
-								/*
-								 * If this part has a non-selected visual mode (normal)
-								 * AND it's not in the existing part list, then add it
-								 */
-								/*
-								if (part->visualmode == part->CVMNormal) {
-								    if (!partInList) {
-								        m_partHighlighted.push_back(p_part);
-								    }
-								}
-
-								part->visualmode++;
-								part->visualmode %= part->CVMModeCount;
-
-								if (part->visualmode == part->CVMNormal) {
-								    remove(*part, m_partHighlighted);
-								}
-								*/
 							} // if hit
 						}     // for each part on the board
 
@@ -2791,10 +2701,7 @@ void BoardView::HandleInput() {
 						 * non pin, non part area, then we clear everything
 						 */
 						if ((!any_hits) && (!io.KeyCtrl)) {
-							for (auto &part : m_board->Components()) {
-								//								auto p        = part.get();
-								part->visualmode = part->CVMNormal;
-							}
+							m_partSelected.clear();
 							m_partHighlighted.clear();
 						}
 
@@ -2951,16 +2858,22 @@ void BoardView::CenterZoomNet(string netname) {
 	min.x = min.y = FLT_MAX;
 	max.x = max.y = FLT_MIN;
 
-	for (auto &pin : m_board->Pins()) {
-		if (pin->net->name == netname) {
-			auto p = pin->position;
+	// One hash probe for the name, then nets compare by id
+	StringPool::Id name_id = m_board->Names().find(netname);
+	if (name_id == StringPool::kNone) return;
+
+	const auto &store = m_board->Store();
+	for (auto &net : m_board->Nets()) {
+		if (net->name_id != name_id) continue;
+		for (uint32_t i : store.net_pin_range(net->index)) {
+			auto p = Point(store.pin_x[i], store.pin_y[i]);
 			if (p.x < min.x) min.x = p.x;
 			if (p.y < min.y) min.y = p.y;
 			if (p.x > max.x) max.x = p.x;
 			if (p.y > max.y) max.y = p.y;
-			if (!infoPanelSelectPartsOnNet || pin->type == Pin::kPinTypeTestPad) continue;
-			auto& cpt = pin->component;
-			if (contains(cpt, m_partHighlighted)) continue;
+			if (!infoPanelSelectPartsOnNet || store.pin_type[i] == Pin::kPinTypeTestPad) continue;
+			auto& cpt = m_board->Pins()[i]->component;
+			if (m_partHighlighted.contains(cpt)) continue;
 			if (infoPanelSelectPartsOnNetOnlyNotGround) {
 				auto has_ground = std::any_of(cpt->pins.cbegin(), cpt->pins.cend(), [](auto& pin) {
 					return pin->net->is_ground;
@@ -2969,8 +2882,8 @@ void BoardView::CenterZoomNet(string netname) {
 					continue;
 				}
 			}
-			cpt->visualmode = cpt->CVMSelected;
-			m_partHighlighted.push_back(cpt);
+			m_partSelected.insert(cpt);
+			m_partHighlighted.insert(cpt);
 		}
 	}
 
@@ -3021,7 +2934,7 @@ void BoardView::CenterZoomSearchResults(void) {
 	max.x = max.y = FLT_MIN;
 
 	for (auto &pp : m_pinHighlighted) {
-		auto &p = pp->position;
+		Point p = pp->position();
 		if (p.x < min.x) min.x = p.x;
 		if (p.y < min.y) min.y = p.y;
 		if (p.x > max.x) max.x = p.x;
@@ -3031,7 +2944,7 @@ void BoardView::CenterZoomSearchResults(void) {
 
 	for (auto &pp : m_partHighlighted) {
 		for (auto &pn : pp->pins) {
-			auto &p = pn->position;
+			Point p = pn->position();
 			if (p.x < min.x) min.x = p.x;
 			if (p.y < min.y) min.y = p.y;
 			if (p.x > max.x) max.x = p.x;
@@ -3067,93 +2980,6 @@ void BoardView::CenterZoomSearchResults(void) {
  * the outline and flips the board outline if required, as it seems some
  * brd2 files are coming with a y-flipped outline
  */
-int BoardView::EPCCheck(void) {
-	int epc[2] = {0, 0};
-	int side;
-	auto &outline = m_board->OutlinePoints();
-	ImVec2 min, max;
-
-	if (outline.empty()) {
-		return 1;
-	};
-
-	// find the orthagonal bounding box
-	// probably can put this as a predefined
-	min.x = min.y = FLT_MAX;
-	max.x = max.y = FLT_MIN;
-	for (auto &p : outline) {
-		if (p->x < min.x) min.x = p->x;
-		if (p->y < min.y) min.y = p->y;
-		if (p->x > max.x) max.x = p->x;
-		if (p->y > max.y) max.y = p->y;
-	}
-
-	for (side = 0; side < 2; side++) {
-		for (auto &p : m_board->Pins()) {
-			// auto p = pin.get();
-			int l, r;
-			int jump = 1;
-			Point fp;
-
-			l = 0;
-			r = 0;
-
-			for (size_t i = 0; i < outline.size() - 1; i++) {
-				Point &pa = *outline[i];
-				Point &pb = *outline[i + 1];
-
-				// jump double/dud points
-				if (pa.x == pb.x && pa.y == pb.y) continue;
-
-				// if we encounter our hull/poly start point, then we've now created the
-				// closed
-				// hull, jump the next segment and reset the first-point
-				if ((!jump) && (fp.x == pb.x) && (fp.y == pb.y)) {
-					if (i < outline.size() - 2) {
-						fp   = *outline[i + 2];
-						jump = 1;
-						i++;
-					}
-				} else {
-					jump = 0;
-				}
-
-				// test to see if this segment makes the scan-cut.
-				if ((pa.y > pb.y && p->position.y < pa.y && p->position.y > pb.y) ||
-				    (pa.y < pb.y && p->position.y > pa.y && p->position.y < pb.y)) {
-					ImVec2 intersect;
-
-					intersect.y = p->position.y;
-					if (pa.x == pb.x)
-						intersect.x = pa.x;
-					else
-						intersect.x = (pb.x - pa.x) / (pb.y - pa.y) * (p->position.y - pa.y) + pa.x;
-
-					if (intersect.x > p->position.x)
-						r++;
-					else if (intersect.x < p->position.x)
-						l++;
-				}
-			} // if we did get an intersection
-
-			// If either side has no intersections, then it's out of bounds (likely)
-			if ((l % 2 == 0) && (r % 2 == 0)) epc[side]++;
-		} // pins
-
-		if (debug) fprintf(stderr, "EPC[%d]: %d\n", side, epc[side]);
-
-		// flip the outline
-		for (auto &p : outline) p->y = max.y - p->y;
-
-	} // side
-
-	if ((epc[0] || epc[1]) && (epc[0] > epc[1])) {
-		for (auto &p : outline) p->y = max.y - p->y;
-	}
-
-	return 0;
-}
-
 /*
  * Experimenting to see how much CPU hit rescanning and
  * drawing the flood fill is (as pin-stripe) each time
@@ -3167,42 +2993,16 @@ void BoardView::OutlineGenFillDraw(ImDrawList *draw, int ydelta, double thicknes
 
 	auto io = ImGui::GetIO();
 	vector<ImVec2> scanhits;
-	static ImVec2 min, max; // board min/max points
-	                        //	double steps = 500;
 	double vdelta;
 	double y, ystart, yend;
 
 	if (!boardFill || slowCPU) return;
-	if (!m_file) return;
+	if (!m_file || m_outlineEdges.empty()) return;
 
 	scanhits.reserve(20);
 
 	draw->ChannelsSetCurrent(kChannelFill);
 
-	// find the orthagonal bounding box
-	// probably can put this as a predefined
-	if (!boardMinMaxDone) {
-		min.x = min.y = 100000000000;
-		max.x = max.y = -100000000000;
-		for (auto &p : m_board->OutlinePoints()) {
-			if (p->x < min.x) min.x = p->x;
-			if (p->y < min.y) min.y = p->y;
-			if (p->x > max.x) max.x = p->x;
-			if (p->y > max.y) max.y = p->y;
-		}
-		for (auto &s: m_board->OutlineSegments()) {
-			if (s.first.x < min.x) min.x = s.first.x;
-			if (s.second.x < min.x) min.x = s.second.x;
-			if (s.first.y < min.y) min.y = s.first.y;
-			if (s.second.y < min.y) min.y = s.second.y;
-			if (s.first.x > max.x) max.x = s.first.x;
-			if (s.second.x > max.x) max.x = s.second.x;
-			if (s.first.y > max.y) max.y = s.first.y;
-			if (s.second.y > max.y) max.y = s.second.y;
-		}
-		boardMinMaxDone = true;
-	}
-
 	// Get the viewport limits, so we don't waste time scanning what we don't need
 	ImVec2 vpa = ScreenToCoord(0, 0);
 	ImVec2 vpb = ScreenToCoord(io.DisplaySize.x, io.DisplaySize.y);
@@ -3215,104 +3015,28 @@ void BoardView::OutlineGenFillDraw(ImDrawList *draw, int ydelta, double thicknes
 		yend   = vpb.y;
 	}
 
-	if (ystart < min.y) ystart = min.y;
-	if (yend > max.y) yend = max.y;
-
-	//	vdelta = (ystart - yend) / steps;
+	if (ystart < m_outlineEdges.min().y) ystart = m_outlineEdges.min().y;
+	if (yend > m_outlineEdges.max().y) yend = m_outlineEdges.max().y;
 
 	vdelta = ydelta / m_scale;
+	if (vdelta <= 0) return;
 
 	/*
-	 * Go through each scan line
+	 * Go through each scan line, up the edge table
 	 */
+	OutlineEdges::Scanner scanner(m_outlineEdges);
 	y = ystart;
 	while (y < yend) {
 
-		scanhits.resize(0);
-		// scan outline segments to see if any intersect with our horizontal scan line
-
-		/*
-		 * While we haven't yet exhausted possible scan hits
-		 */
+		scanner.hits(y, scanhits);
 
+		// now finally generate the lines.
 		{
-
-			int jump = 1;
-			Point fp;
-
-			auto &outline_points = m_board->OutlinePoints();
-
-			// set our initial draw point, so we can detect when we encounter it again
-			if (!outline_points.empty()) {
-				fp = *outline_points[0];
-
-				for (size_t i = 0; i < outline_points.size() - 1; i++) {
-					Point &pa = *outline_points[i];
-					Point &pb = *outline_points[i + 1];
-
-					// jump double/dud points
-					if (pa.x == pb.x && pa.y == pb.y) continue;
-
-					// if we encounter our hull/poly start point, then we've now created the
-					// closed
-					// hull, jump the next segment and reset the first-point
-					if ((!jump) && (fp.x == pb.x) && (fp.y == pb.y)) {
-						if (i < outline_points.size() - 2) {
-							fp   = *outline_points[i + 2];
-							jump = 1;
-							i++;
-						}
-					} else {
-						jump = 0;
-					}
-
-					// test to see if this segment makes the scan-cut.
-					if ((pa.y > pb.y && y < pa.y && y > pb.y) || (pa.y < pb.y && y > pa.y && y < pb.y)) {
-						ImVec2 intersect;
-
-						intersect.y = y;
-						if (pa.x == pb.x)
-							intersect.x = pa.x;
-						else
-							intersect.x = (pb.x - pa.x) / (pb.y - pa.y) * (y - pa.y) + pa.x;
-						scanhits.push_back(intersect);
-					}
-				} // if we did get an intersection
-			}
-
-			for (auto &s: m_board->OutlineSegments()) {
-				auto pa = s.first;
-				auto pb = s.second;
-
-				// jump double/dud segments
-				if (pa.x == pb.x && pa.y == pb.y) continue;
-
-				// test to see if this segment makes the scan-cut.
-				if ((pa.y > pb.y && y < pa.y && y > pb.y) || (pa.y < pb.y && y > pa.y && y < pb.y)) {
-					ImVec2 intersect;
-
-					intersect.y = y;
-					if (pa.x == pb.x)
-						intersect.x = pa.x;
-					else
-						intersect.x = (pb.x - pa.x) / (pb.y - pa.y) * (y - pa.y) + pa.x;
-					scanhits.push_back(intersect);
-				}
-			}
-
-			sort(scanhits.begin(), scanhits.end(), [](ImVec2 const &a, ImVec2 const &b) { return a.x < b.x; });
-			// Some boards contain duplicate outline segments (possibly with points swapped) that generate duplicate intersections
-			// which interferes with the process of generating alterating segments for the scanlines, so remove duplicates.
-			scanhits.erase(std::unique(scanhits.begin(), scanhits.end(), [](const ImVec2 &a, const ImVec2 &b) {return a.x == b.x && a.y == b.y;}), scanhits.end());
-
-			// now finally generate the lines.
-			{
-				int i = 0;
-				int l = scanhits.size() - 1;
-				for (i = 0; i < l; i += 2) {
-					draw->AddLine(
-					    CoordToScreen(scanhits[i].x, y), CoordToScreen(scanhits[i + 1].x, y), m_colors.boardFillColor, thickness);
-				}
+			int i = 0;
+			int l = scanhits.size() - 1;
+			for (i = 0; i < l; i += 2) {
+				draw->AddLine(
+				    CoordToScreen(scanhits[i].x, y), CoordToScreen(scanhits[i + 1].x, y), m_colors.boardFillColor, thickness);
 			}
 		}
 		y += vdelta;
@@ -3423,6 +3147,10 @@ void BoardView::DrawOutline(ImDrawList *draw) {
 	DrawOutlinePoints(draw);
 }
 
+/*
+ * Lines joining the pins on the selected pin's net: its ratsnest, the shortest connections between
+ * them, or with netWebStar a line from the selected pin to each. Only lines crossing the view are drawn.
+ */
 void BoardView::DrawNetWeb(ImDrawList *draw) {
 	if (!showNetWeb) return;
 
@@ -3434,32 +3162,67 @@ void BoardView::DrawNetWeb(ImDrawList *draw) {
 	if (m_pinSelected->type == Pin::kPinTypeUnkown) return;
 	if (m_pinSelected->net->is_ground) return;
 
-	for (auto &p : m_board->Pins()) {
+	const auto &store = m_board->Store();
+	uint32_t net      = m_pinSelected->net->index;
 
-		if (p->net == m_pinSelected->net) {
-			uint32_t col = m_colors.pinNetWebColor;
-			if (!BoardElementIsVisible(p->component)) {
-				col = m_colors.pinNetWebOSColor;
-				draw->AddCircle(CoordToScreen(p->position.x, p->position.y), p->diameter * m_scale, col, 16);
-			}
+	ImVec2 view_min, view_max;
+	VisibleBoardRect(view_min, view_max);
+	auto in_view = [&](ImVec2 a, ImVec2 b) {
+		return std::max(a.x, b.x) >= view_min.x && std::min(a.x, b.x) <= view_max.x && std::max(a.y, b.y) >= view_min.y &&
+		       std::min(a.y, b.y) <= view_max.y;
+	};
+	auto side_shown = [&](uint32_t i) {
+		uint32_t component = store.pin_component[i];
+		return component == BoardStore::kNone || SideIsVisible(store.component_side[component]);
+	};
 
-			draw->AddLine(CoordToScreen(m_pinSelected->position.x, m_pinSelected->position.y),
-			              CoordToScreen(p->position.x, p->position.y),
-			              ImColor(col),
-			              netWebThickness);
+	// Pins on the other side are circled
+	for (uint32_t i : store.net_pin_range(net)) {
+		ImVec2 pos(store.pin_x[i], store.pin_y[i]);
+		if (side_shown(i) || !in_view(pos, pos)) continue;
+		draw->AddCircle(CoordToScreen(pos.x, pos.y), store.pin_diameter[i] * m_scale, m_colors.pinNetWebOSColor, 16);
+	}
+
+	if (netWebStar) {
+		ImVec2 from(m_pinSelected->position().x, m_pinSelected->position().y);
+		for (uint32_t i : store.net_pin_range(net)) {
+			ImVec2 to(store.pin_x[i], store.pin_y[i]);
+			if (!in_view(from, to)) continue;
+			uint32_t col = side_shown(i) ? m_colors.pinNetWebColor : m_colors.pinNetWebOSColor;
+			draw->AddLine(CoordToScreen(from.x, from.y), CoordToScreen(to.x, to.y), col, netWebThickness);
 		}
+		return;
+	}
+
+	for (auto &edge : m_ratsnest.net(store, net)) {
+		ImVec2 a(store.pin_x[edge.a], store.pin_y[edge.a]);
+		ImVec2 b(store.pin_x[edge.b], store.pin_y[edge.b]);
+		if (!in_view(a, b)) continue;
+		uint32_t col = side_shown(edge.a) && side_shown(edge.b) ? m_colors.pinNetWebColor : m_colors.pinNetWebOSColor;
+		draw->AddLine(CoordToScreen(a.x, a.y), CoordToScreen(b.x, b.y), col, netWebThickness);
 	}
+}
 
-	return;
+// Pin values shown in pin labels, Pin::kValueNone if none
+static Pin::EValue ShownPinValue(BoardView::ShowMode mode) {
+	switch (mode) {
+		case BoardView::ShowMode_Ohm: return Pin::kValueOhm;
+		case BoardView::ShowMode_Voltage: return Pin::kValueVoltage;
+		case BoardView::ShowMode_Diode: return Pin::kValueDiode;
+		default: return Pin::kValueNone;
+	}
 }
 
-static Pin* InferPin(Pin* pin, string Pin::* show_value_ptr) {
-	auto iter = std::find_if(pin->net->pins.cbegin(), pin->net->pins.cend(), [show_value_ptr](auto& opin) {
-						return !((*opin).*show_value_ptr).empty();
-					});
-	if (iter != pin->net->pins.cend())
-		return (*iter).get();
-	return nullptr;
+// Segments for a circle of radius pixels, so its chords stay within half a pixel of it
+static int CircleSegments(float radius) {
+	if (radius <= 1.0f) return 4;
+	int segments = static_cast<int>(ceilf(M_PI / acosf(1.0f - 0.5f / radius)));
+	return std::clamp(segments, 4, 128);
+}
+
+// Segments for an arc of radius pixels going from start_angle to end_angle
+static int ArcSegments(float radius, float start_angle, float end_angle) {
+	return std::max(1, static_cast<int>(ceilf(CircleSegments(radius) * fabsf(end_angle - start_angle) / (2.0f * M_PI))));
 }
 
 inline void BoardView::DrawPins(ImDrawList *draw) {
@@ -3493,33 +3256,78 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 
 	if (m_pinSelected) DrawNetWeb(draw);
 
-	for (auto &pin : m_board->Pins()) {
-		float psz           = pin->diameter * m_scale;
-		uint32_t fill_color = 0xFFFF8888; // fallback fill colour
-		uint32_t text_color = m_colors.pinDefaultTextColor;
-		uint32_t color      = (m_colors.pinDefaultColor & cmask) | omask;
-		bool fill_pin       = false;
-		bool show_text      = false;
-		bool draw_ring      = true;
-		bool show_net_name  = true;
+	// Cull with the grid and the packed arrays, only pins that get drawn touch their Pin object
+	ImVec2 view_min, view_max;
+	std::vector<uint32_t> visible;
+	VisibleBoardRect(view_min, view_max);
+	Index().pins.query(view_min, view_max, visible);
+
+	const auto &store      = m_board->Store();
+	auto &pins             = m_board->Pins();
+	const BoardLod::Level *lod = m_drawRetained ? nullptr : m_lod.level(*m_board, m_scale);
+
+	/*
+	 * The retained layer has the pins as they look by default, only those that stand
+	 * out and pin names are left to draw, if there are any
+	 */
+	bool highlights = m_pinSelected || !m_pinHighlighted.empty() || !m_partHighlighted.empty();
+	if (m_drawRetained && !highlights && !(showPinName && Index().pins.max_extent() * m_scale > 3)) return;
+
+	/*
+	 * Zoomed out, pins under a pixel are drawn as density cells, one
+	 * rectangle per few pixels shaded by how much of it the pins cover
+	 */
+	if (lod) {
+		uint32_t color    = (m_colors.pinDefaultColor & cmask) | omask;
+		uint32_t alpha    = (color & IM_COL32_A_MASK) >> IM_COL32_A_SHIFT;
+		float half_cell   = lod->cell_size * m_scale / 2;
+		for (auto &cell : lod->pin_cells) {
+			if (!SideIsVisible(cell.side)) continue;
+			if ((!m_pinSelected) && (cell.diameter * m_scale < threshold)) continue;
+			if (cell.center.x < view_min.x || cell.center.x > view_max.x || cell.center.y < view_min.y || cell.center.y > view_max.y) continue;
+
+			ImVec2 pos = CoordToScreen(cell.center.x, cell.center.y);
+			uint32_t cell_color = (color & ~IM_COL32_A_MASK) | (static_cast<uint32_t>(alpha * cell.coverage) << IM_COL32_A_SHIFT);
+			draw->AddRectFilled(ImVec2(pos.x - half_cell, pos.y - half_cell), ImVec2(pos.x + half_cell, pos.y + half_cell), cell_color);
+		}
+	}
+
+	for (uint32_t i : visible) {
+		float psz = store.pin_diameter[i] * m_scale;
 
 		// continue if pin is not visible anyway
-		if (!BoardElementIsVisible(pin)) continue;
+		if (!SideIsVisible(store.pin_side[i])) continue;
 
-		ImVec2 pos = CoordToScreen(pin->position.x, pin->position.y);
+		ImVec2 pos = CoordToScreen(store.pin_x[i], store.pin_y[i]);
 		{
 			if (!IsVisibleScreen(pos.x, pos.y, psz, io)) continue;
 		}
 
 		if ((!m_pinSelected) && (psz < threshold)) continue;
 
+		// Already in a density cell, unless it stands out
+		if (lod && store.pin_diameter[i] < lod->pin_diameter_limit && !PinStandsOut(i)) continue;
+
+		// Already in the retained layer, only its name may be left to draw
+		bool in_layer = m_drawRetained && !PinStandsOut(i);
+		if (in_layer && !(showPinName && psz > 3)) continue;
+
+		auto &pin           = pins[i];
+		uint32_t fill_color = 0xFFFF8888; // fallback fill colour
+		uint32_t text_color = m_colors.pinDefaultTextColor;
+		uint32_t color      = (m_colors.pinDefaultColor & cmask) | omask;
+		bool fill_pin       = false;
+		bool show_text      = false;
+		bool draw_ring      = true;
+		bool show_net_name  = true;
+
 		// color & text depending on app state & pin type
 
 		{
 			/*
 			 * Pins resulting from a net search
 			 */
-			if (contains(pin, m_pinHighlighted)) {
+			if (m_pinHighlighted.contains(pin)) {
 				if (psz < fontSize / 2) psz = fontSize / 2;
 				text_color = m_colors.pinSelectedTextColor;
 				fill_color = m_colors.pinSelectedFillColor;
@@ -3550,9 +3358,8 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 				show_text  = false;
 			}
 
-			// If the part itself is highlighted ( CVMShowPins )
-			// if (p_pin->component->visualmode == p_pin->component->CVMSelected) {
-			if (pin->component->visualmode == pin->component->CVMSelected) {
+			// If the part itself is selected
+			if (m_partSelected.contains(pin->component)) {
 				color      = m_colors.pinDefaultColor;
 				text_color = m_colors.pinDefaultTextColor;
 				fill_pin   = false;
@@ -3632,9 +3439,7 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 
 			// for the round pin representations, choose how many circle segments need
 			// based on the pin size
-			segments = round(psz);
-			if (segments > 32) segments = 32;
-			if (segments < 8) segments = 8;
+			segments = std::min(CircleSegments(psz), 32);
 			float h = psz / 2 + 0.5f;
 			float w = h;
 			if (pin->shape == kShapeTypeRect) {
@@ -3652,7 +3457,7 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 			 */
 			if ((show_text) && (psz < fontSize / 2)) psz = fontSize / 2;
 
-			switch (pin->type) {
+			if (!in_layer) switch (pin->type) {
 				case Pin::kPinTypeTestPad:
 					if ((psz > 3) && (!slowCPU)) {
 						draw->AddCircleFilled(ImVec2(pos.x, pos.y), psz, fill_color, segments);
@@ -3689,51 +3494,46 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 
 			// Show all pin names when showPinName is enabled and pin diameter is above threshold or show pin name only for selected part
 			if ((showPinName && psz > 3) || show_text) {
-				std::string text = pin->name + "\n" + pin->net->name;
+				auto &label = m_labels.pin(*pin);
 				ImFont *font = ImGui::GetIO().Fonts->Fonts[0]; // Default font
-				ImVec2 text_size_normalized = font->CalcTextSizeA(1.0f, FLT_MAX, 0.0f, text.c_str());
+				ImVec2 text_size_normalized = label.text;
 
 				float maxfontwidth = psz * 2.125/ text_size_normalized.x; // Fit horizontally with 6.75% overflow (should still avoid colliding with neighbours)
 				float maxfontheight = psz * 1.5/ text_size_normalized.y; // Fit vertically with 25% top/bottom padding
 				float maxfontsize = min(maxfontwidth, maxfontheight);
 
 				// Font size for pin name only depends on height of text (rather than width of full text incl. net name) to scale to pin bounding box
-				ImVec2 size_pin_name = font->CalcTextSizeA(maxfontheight, FLT_MAX, 0.0f, pin->name.c_str());
+				ImVec2 size_pin_name = ImVec2(label.name.x * maxfontheight, label.name.y * maxfontheight);
 				// Font size for net name also depends on width of full text to avoid overflowing too much and colliding with text from other pin
-				ImVec2 size_net_name = font->CalcTextSizeA(maxfontsize, FLT_MAX, 0.0f, pin->net->name.c_str());
-
-				string show_value;
-				if (showMode != ShowMode_None) {
-					auto show_value_ptr = [this]{
-						switch (showMode) {
-							case ShowMode_Ohm:
-								return &Pin::ohm_value;
-							case ShowMode_Voltage:
-								return &Pin::voltage_value;
-							case ShowMode_Diode:
-								return &Pin::diode_value;
-							default:
-								return &Pin::diode_value;
-						}
-					}();
-					show_value = ((*pin).*show_value_ptr);
-					if (show_value.empty() && inferValue) {
-						auto inferPin = InferPin(pin.get(), show_value_ptr);
-						if (inferPin) {
-							show_value = ((*inferPin).*show_value_ptr);
-							show_value += " (";
-							show_value += inferPin->component->name;
-							show_value += ")";
-						}
-					}
-				}
-				ImVec2 size_show_value = font->CalcTextSizeA(maxfontheight, FLT_MAX, 0.0f, show_value.c_str());
+				ImVec2 size_net_name = ImVec2(label.net.x * maxfontsize, label.net.y * maxfontsize);
+
+				const string &show_value = label.value;
+				ImVec2 size_show_value = ImVec2(label.value_size.x * maxfontheight, label.value_size.y * maxfontheight);
 
 				// Show pin name above net name, full text is centered vertically
 				ImVec2 pos_pin_name   = ImVec2(pos.x - size_pin_name.x * 0.5f, pos.y - size_pin_name.y);
 				ImVec2 pos_net_name   = ImVec2(pos.x - size_net_name.x * 0.5f, pos.y);
 				ImVec2 pos_show_value = ImVec2(pos.x - size_show_value.x*0.5f, pos_pin_name.y - size_show_value.y);
 
+				/*
+				 * Names shown only because all pin names are go where they don't overlap one
+				 * drawn before, those of highlighted pins and parts are always drawn
+				 */
+				ImVec2 label_min = pos_pin_name;
+				ImVec2 label_max = ImVec2(pos_pin_name.x + size_pin_name.x, pos.y);
+				if (show_net_name) {
+					label_min.x = std::min(label_min.x, pos_net_name.x);
+					label_max.x = std::max(label_max.x, pos_net_name.x + size_net_name.x);
+					label_max.y = pos_net_name.y + size_net_name.y;
+				}
+				if (!show_value.empty()) {
+					label_min.x = std::min(label_min.x, pos_show_value.x);
+					label_max.x = std::max(label_max.x, pos_show_value.x + size_show_value.x);
+					label_min.y = pos_show_value.y;
+				}
+				if (hideOverlappingLabels && !show_text && !m_labelGrid.fits(label_min, label_max)) continue;
+				m_labelGrid.place(label_min, label_max);
+
 				ImFont *font_pin_name = font;
 				if (maxfontheight < font->FontSize * 0.75) {
 					font_pin_name = ImGui::GetIO().Fonts->Fonts[2]; // Use smaller font for pin name
@@ -3764,9 +3564,9 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 											m_scale * 0.5f/*rounding*/);
 
 				draw->ChannelsSetCurrent(kChannelText);
-				draw->AddText(font_pin_name, maxfontheight, pos_pin_name, text_color, pin->name.c_str());
+				draw->AddText(font_pin_name, maxfontheight, pos_pin_name, text_color, pin->name.data());
 				if (show_net_name)
-					draw->AddText(font_net_name, maxfontsize, pos_net_name, text_color, pin->net->name.c_str());
+					draw->AddText(font_net_name, maxfontsize, pos_net_name, text_color, pin->net->name.data());
 				if (!show_value.empty()) {
 					draw->AddText(font_show_value, maxfontheight, pos_show_value, m_colors.annotationBoxColor, show_value.c_str());
 				}
@@ -3778,12 +3578,7 @@ inline void BoardView::DrawPins(ImDrawList *draw) {
 
 inline void BoardView::DrawParts(ImDrawList *draw) {
 	// float psz = (float)m_pinDiameter * 0.5f * m_scale;
-	double angle;
-	double distance = 0;
 	uint32_t color = m_colors.partOutlineColor;
-	//	int rendered   = 0;
-	char p0, p1; // first two characters of the part name, code-writing
-	             // convenience more than anything else
 
 	draw->ChannelsSetCurrent(kChannelPolylines);
 	/*
@@ -3794,301 +3589,39 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 		color = (m_colors.partOutlineColor & m_colors.selectedMaskParts) | m_colors.orMaskParts;
 	}
 
-	for (auto &part : m_board->Components()) {
-		int pincount = 0;
-		double min_x, min_y, max_x, max_y, aspect;
-		std::vector<ImVec2> pva;
-		std::array<ImVec2, 4> dbox; // default box, if there's nothing else claiming to render the part different.
+	/*
+	 * Parts overlapping the screen, and those without an outline wherever they are
+	 * so they get marked below, in board order
+	 */
+	std::vector<uint32_t> visible;
+	{
+		ImVec2 view_min, view_max;
+		auto &index = Index();
+		VisibleBoardRect(view_min, view_max);
+		index.parts.query(view_min, view_max, visible);
+		size_t placed = visible.size();
+		visible.insert(visible.end(), index.unplaced_parts.begin(), index.unplaced_parts.end());
+		std::inplace_merge(visible.begin(), visible.begin() + placed, visible.end());
+	}
+
+	for (uint32_t part_index : visible) {
+		auto &part = m_board->Components()[part_index];
 
 		if (part->is_dummy()) continue;
 
 		/*
-		 *
-		 * When we first load the board, the outline of each part isn't (yet) rendered
-		 * or determined/calculated.  So, the first time we display the board we
-		 * compute the outline and store it for later.
-		 *
-		 * This also sets the pin diameters too.
-		 *
+		 * Parts are outlined when the board loads (OutlineParts()), those
+		 * without pins have no outline, mark where they are
 		 */
-		if (!part->outline_done) { // should only need to do this once for most parts
-			if (part->pins.size() == 0) {
-				if (debug) fprintf(stderr, "WARNING: Drawing empty part %s\n", part->name.c_str());
-				draw->AddRect(CoordToScreen(part->p1.x + DPIF(10), part->p1.y + DPIF(10)),
-				              CoordToScreen(part->p2.x - DPIF(10), part->p2.y - DPIF(10)),
-				              0xff0000ff);
-				draw->AddText(
-				    CoordToScreen(part->p1.x + DPIF(10), part->p1.y - DPIF(50)), m_colors.partTextColor, part->name.c_str());
-				continue;
-			}
-
-			for (auto &pin : part->pins) {
-				pincount++;
-
-				// scale box around pins as a fallback, else either use polygon or convex
-				// hull for better shape fidelity
-				if (pincount == 1) {
-					min_x = pin->position.x;
-					min_y = pin->position.y;
-					max_x = min_x;
-					max_y = min_y;
-				}
-
-				pva.push_back({pin->position.x, pin->position.y});
-
-				if (pin->position.x > max_x) {
-					max_x = pin->position.x;
-
-				} else if (pin->position.x < min_x) {
-					min_x = pin->position.x;
-				}
-				if (pin->position.y > max_y) {
-					max_y = pin->position.y;
-
-				} else if (pin->position.y < min_y) {
-					min_y = pin->position.y;
-				}
-			}
-
-			part->omin        = ImVec2(min_x, min_y);
-			part->omax        = ImVec2(max_x, max_y);
-			part->centerpoint = ImVec2((max_x - min_x) / 2 + min_x, (max_y - min_y) / 2 + min_y);
-
-			distance = sqrt((max_x - min_x) * (max_x - min_x) + (max_y - min_y) * (max_y - min_y));
-
-			float pin_radius = m_pinDiameter / 2.0f;
-
-			/*
-			 *
-			 * Determine the size of our part's pin radius based on the distance
-			 * between the extremes of the pin coordinates.
-			 *
-			 * All the figures below are determined empirically rather than any
-			 * specific formula.
-			 *
-			 */
-			if ((pincount < 4) && (part->name[0] != 'U') && (part->name[0] != 'Q')) {
-
-				if ((distance > 52) && (distance < 57)) {
-					// 0603
-					pin_radius = 15;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 247) && (distance < 253)) {
-					// SMC diode?
-					pin_radius = 50;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 195) && (distance < 199)) {
-					// Inductor?
-					pin_radius = 50;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 165) && (distance < 169)) {
-					// SMB diode?
-					pin_radius = 35;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 101) && (distance < 109)) {
-					// SMA diode / tant cap
-					pin_radius = 30;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 108) && (distance < 112)) {
-					// 1206
-					pin_radius = 30;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 64) && (distance < 68)) {
-					// 0805
-					pin_radius = 25;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-
-				} else if ((distance > 18) && (distance < 22)) {
-					// 0201 cap/resistor?
-					pin_radius = 5;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-				} else if ((distance > 28) && (distance < 32)) {
-					// 0402 cap/resistor
-					pin_radius = 10;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-				}
-			}
-
-			// TODO: pin radius is stored in Pin object
-			//
-			//
-			//
-			min_x -= pin_radius;
-			max_x += pin_radius;
-			min_y -= pin_radius;
-			max_y += pin_radius;
-
-			if ((max_y - min_y) < 0.01)
-				aspect = 0;
-			else
-				aspect = (max_x - min_x) / (max_y - min_y);
-
-			dbox[0].x = dbox[3].x = min_x;
-			dbox[1].x = dbox[2].x = max_x;
-			dbox[0].y = dbox[1].y = min_y;
-			dbox[3].y = dbox[2].y = max_y;
-
-			p0 = part->name[0];
-			p1 = part->name[1];
-
-			/*
-			 * Draw all 2~3 pin devices as if they're not orthagonal.  It's a bit more
-			 * CPU
-			 * overhead but it keeps the code simpler and saves us replicating things.
-			 */
-
-			if ((pincount == 3) && (abs(aspect) > 0.5) &&
-			    ((strchr("DQZ", p0) || (strchr("DQZ", p1)) || strcmp(part->name.c_str(), "LED")))) {
-
-				part->outline = dbox;
-				part->outline_done = true;
-
-				part->hull.clear();
-				for (auto &pin : part->pins) {
-					part->hull.push_back({pin->position.x, pin->position.y});
-				}
-
-				/*
-				 * handle all other devices not specifically handled above
-				 */
-			} else if ((pincount > 1) && (pincount < 4) && ((strchr("CRLD", p0) || (strchr("CRLD", p1))))) {
-				double dx, dy;
-				double tx, ty;
-				double armx, army;
-
-				dx    = part->pins[1]->position.x - part->pins[0]->position.x;
-				dy    = part->pins[1]->position.y - part->pins[0]->position.y;
-				angle = atan2(dy, dx);
-
-				if (((p0 == 'L') || (p1 == 'L')) && (distance > 50)) {
-					pin_radius = 15;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-					army = distance / 2;
-					armx = pin_radius;
-				} else if (((p0 == 'C') || (p1 == 'C')) && (distance > 90)) {
-					double mpx, mpy;
-
-					pin_radius = 15;
-					for (auto &pin : part->pins) {
-						pin->diameter = pin_radius; // * 0.05;
-					}
-					army = distance / 2 - distance / 4;
-					armx = pin_radius;
-
-					mpx = dx / 2 + part->pins[0]->position.x;
-					mpy = dy / 2 + part->pins[0]->position.y;
-					VHRotateV(&mpx, &mpy, dx / 2 + part->pins[0]->position.x, dy / 2 + part->pins[0]->position.y, angle);
-
-					part->expanse        = distance;
-					part->centerpoint.x  = mpx;
-					part->centerpoint.y  = mpy;
-					part->component_type = part->kComponentTypeCapacitor;
-
-				} else {
-					armx = army = pin_radius;
-				}
-
-				// TODO: Compact this bit of code, maybe. It works at least.
-				tx = part->pins[0]->position.x - armx;
-				ty = part->pins[0]->position.y - army;
-				VHRotateV(&tx, &ty, part->pins[0]->position.x, part->pins[0]->position.y, angle);
-				// a = CoordToScreen(tx, ty);
-				part->outline[0].x = tx;
-				part->outline[0].y = ty;
-
-				tx = part->pins[0]->position.x - armx;
-				ty = part->pins[0]->position.y + army;
-				VHRotateV(&tx, &ty, part->pins[0]->position.x, part->pins[0]->position.y, angle);
-				// b = CoordToScreen(tx, ty);
-				part->outline[1].x = tx;
-				part->outline[1].y = ty;
-
-				tx = part->pins[1]->position.x + armx;
-				ty = part->pins[1]->position.y + army;
-				VHRotateV(&tx, &ty, part->pins[1]->position.x, part->pins[1]->position.y, angle);
-				// c = CoordToScreen(tx, ty);
-				part->outline[2].x = tx;
-				part->outline[2].y = ty;
-
-				tx = part->pins[1]->position.x + armx;
-				ty = part->pins[1]->position.y - army;
-				VHRotateV(&tx, &ty, part->pins[1]->position.x, part->pins[1]->position.y, angle);
-				// d = CoordToScreen(tx, ty);
-				part->outline[3].x = tx;
-				part->outline[3].y = ty;
-
-				part->outline_done = true;
-
-				// rendered = 1;
-
-			} else {
-
-				/*
-				 * If we have (typically) a connector with a non uniform pin distribution
-				 * then we can try use the minimal bounding box algorithm
-				 * to give it a more sane outline
-				 */
-				if ((pincount >= 4) && ((strchr("UJL", p0) || strchr("UJL", p1) || (strncmp(part->name.c_str(), "CN", 2) == 0)))) {
-					// Find our hull
-					std::vector<ImVec2> hull = VHConvexHull(pva);
-
-					// If we had a valid hull, then find the MBB for it
-					if (hull.size() > 0) {
-						part->hull = hull;
-
-						std::array<ImVec2, 4> bbox = VHMBBCalculate(hull, pin_radius);
-						part->outline = bbox;
-						part->outline_done = true;
-
-						/*
-						 * Tighten the hull, removes any small angle segments
-						 * such as a sequence of pins in a line, might be an overkill
-						 */
-						// hpc = TightenHull(hull, hpc, 0.1f);
-					}
-				} else {
-					// if it wasn't at an odd angle, or wasn't large, or wasn't a connector,
-					// just an ordinary
-					// type part, then this is where we'll likely end up
-					part->outline = dbox;
-					part->outline_done = true;
-				}
-			}
-
-			//			if (rendered == 0) {
-			//				fprintf(stderr, "Part wasn't rendered (%s)\n", part->name.c_str());
-			//			}
-
-			if (part->is_special_outline) {
-				part->outline = part->special_outline;
-			}
-		} // if !outline_done
+		if (!part->outline_done && part->pins.size() == 0) {
+			if (debug) fprintf(stderr, "WARNING: Drawing empty part %s\n", part->name.data());
+			draw->AddRect(CoordToScreen(part->p1.x + DPIF(10), part->p1.y + DPIF(10)),
+			              CoordToScreen(part->p2.x - DPIF(10), part->p2.y - DPIF(10)),
+			              0xff0000ff);
+			draw->AddText(
+			    CoordToScreen(part->p1.x + DPIF(10), part->p1.y - DPIF(50)), m_colors.partTextColor, part->name.data());
+			continue;
+		}
 
 		if (!BoardElementIsVisible(part) && !PartIsHighlighted(part)) continue;
 
@@ -4105,20 +3638,22 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 			d = ImVec2(CoordToScreen(part->outline[3].x, part->outline[3].y));
 
 			// if (fillParts) draw->AddQuadFilled(a, b, c, d, color & 0xffeeeeee);
-			if (fillParts && !slowCPU) draw->AddQuadFilled(a, b, c, d, m_colors.partFillColor);
-			draw->AddQuad(a, b, c, d, color);
+			if (!m_drawRetained) { // else the retained layer has the outline, board fill, hull and marks
+				if (fillParts && !slowCPU) draw->AddQuadFilled(a, b, c, d, m_colors.partFillColor);
+				draw->AddQuad(a, b, c, d, color);
+			}
 			if (PartIsHighlighted(part)) {
 				if (fillParts && !slowCPU) draw->AddQuadFilled(a, b, c, d, m_colors.partHighlightedFillColor);
 				draw->AddQuad(a, b, c, d, m_colors.partHighlightedColor);
 			}
 
-			if (part->component_type == Component::kComponentTypeBoard) {
+			if (!m_drawRetained && part->component_type == Component::kComponentTypeBoard) {
 				draw->AddQuadFilled(a, b, c, d, m_colors.boardFillColor);
 			}
 			/*
 			 * Draw the convex hull of the part if it has one
 			 */
-			if (!part->hull.empty()) {
+			if (!m_drawRetained && !part->hull.empty()) {
 				draw->PathClear();
 				for (size_t i = 0; i < part->hull.size(); i++) {
 					ImVec2 p = CoordToScreen(part->hull[i].x, part->hull[i].y);
@@ -4130,7 +3665,7 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 			/*
 			 * Draw any icon/mark featuers to illustrate the part better
 			 */
-			if (part->component_type == part->kComponentTypeCapacitor) {
+			if (!m_drawRetained && part->component_type == part->kComponentTypeCapacitor) {
 				if (part->expanse > 90) {
 					int segments = trunc(part->expanse);
 					if (segments < 8) segments = 8;
@@ -4143,14 +3678,14 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 			}
 
 			if (!part->is_dummy() && !part->name.empty()) {
-				const auto& text  = showPartType && !part->part_type.empty() ? part->part_type : part->name;
+				std::string_view text = showPartType && !part->part_type.empty() ? std::string_view(part->part_type) : part->name;
 
 				/*
 				 * Draw part name inside part bounding box
 				 */
 				if (showPartName) {
 					ImFont *font = ImGui::GetIO().Fonts->Fonts[0]; // Default font
-					ImVec2 text_size_normalized	= font->CalcTextSizeA(1.0f, FLT_MAX, 0.0f, text.c_str());
+					ImVec2 text_size_normalized	= m_labels.part(*part, text).text;
 
 					// Find max width and height of bounding box, not perfect for non-straight bounding box but good enough
 					float minx = std::min({a.x, b.x, c.x, d.x});
@@ -4179,7 +3714,7 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 					}
 
 					draw->ChannelsSetCurrent(kChannelText);
-					draw->AddText(font, maxfontsize, pos, m_colors.partTextColor, text.c_str());
+					draw->AddText(font, maxfontsize, pos, m_colors.partTextColor, text.data());
 					draw->ChannelsSetCurrent(kChannelPolylines);
 				}
 
@@ -4189,7 +3724,7 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 				if (PartIsHighlighted(part)) {
 					std::string mcode = part->mfgcode;
 
-					ImVec2 text_size    = ImGui::CalcTextSize(text.c_str());
+					ImVec2 text_size    = ImGui::CalcTextSize(text.data());
 					ImVec2 mfgcode_size = ImGui::CalcTextSize(mcode.c_str());
 
 					if ((!showInfoPanel) && (mfgcode_size.x > text_size.x)) text_size.x = mfgcode_size.x;
@@ -4210,7 +3745,7 @@ inline void BoardView::DrawParts(ImDrawList *draw) {
 										ImVec2(pos.x + text_size.x + DPIF(2.0f), pos.y + text_size.y + DPIF(2.0f)),
 										m_colors.partHighlightedTextBackgroundColor,
 										0.0f);
-					draw->AddText(pos, m_colors.partHighlightedTextColor, text.c_str());
+					draw->AddText(pos, m_colors.partHighlightedTextColor, text.data());
 					if ((!showInfoPanel) && (mcode.size())) {
 						//	pos.y += text_size.y;
 						pos.y += text_size.y + DPIF(2.0f);
@@ -4240,8 +3775,40 @@ inline void BoardView::DrawTracks(ImDrawList *draw) {
 	}
 	draw->ChannelsSetCurrent(kChannelPolylines);
 
+	// The retained layer has the tracks, only the selected net's are drawn over it
+	if (m_drawRetained && !m_pinSelected && !m_viaSelected) return;
+
+	// Only the tracks overlapping the screen, in board order
+	ImVec2 view_min, view_max;
+	std::vector<uint32_t> visible;
+	VisibleBoardRect(view_min, view_max);
+	Index().tracks.query(view_min, view_max, visible);
+
+	/*
+	 * Zoomed out, draw connected tracks as simplified paths, only those of
+	 * the selected net are still drawn one by one, highlighted, below
+	 */
+	const BoardLod::Level *lod = m_drawRetained ? nullptr : m_lod.level(*m_board, m_scale);
+	auto isSelectedNet         = [this](const Net *net) {
+		return (m_pinSelected && m_pinSelected->net == net) || (m_viaSelected && m_viaSelected->net == net);
+	};
+	if (lod) {
+		std::vector<ImVec2> points;
+		for (auto &path : lod->track_paths) {
+			if (path.max.x < view_min.x || path.min.x > view_max.x || path.max.y < view_min.y || path.min.y > view_max.y) continue;
+			if (isSelectedNet(path.net) || !SideIsVisible(path.side)) continue;
+
+			points.clear();
+			for (auto &p : path.points) points.push_back(CoordToScreen(p.x, p.y));
+			uint32_t color = (m_colors.layerColor[path.side][0] & cmask) | omask;
+			draw->AddPolyline(points.data(), static_cast<int>(points.size()), color, false, path.width * m_scale);
+		}
+	}
+
 	const auto& tracks = m_board->Tracks();
-	for (const auto &track : tracks) {
+	for (uint32_t i : visible) {
+		const auto &track = tracks[i];
+		if ((lod || m_drawRetained) && !isSelectedNet(track->net)) continue;
 		if (!(m_pinSelected && m_pinSelected->net == track->net) && !(m_viaSelected && m_viaSelected->net == track->net) && !BoardElementIsVisible(track)) continue;
 		ImVec2 pos_start = CoordToScreen(track->position_start.x, track->position_start.y);
 		ImVec2 pos_end = CoordToScreen(track->position_end.x, track->position_end.y);
@@ -4256,20 +3823,13 @@ inline void BoardView::DrawTracks(ImDrawList *draw) {
 	}
 }
 
-static void DrawArc(ImDrawList* draw_list, ImVec2 center, float radius, ImU32 color, float start_angle, float end_angle, int num_segments = 50, float thickness = 1.0f)
-{
-	ImVec2* points = new ImVec2[num_segments + 1];
-
-	float slice_angle = (end_angle - start_angle) / (float)num_segments;
-	for (int i = 0; i <= num_segments; i++)
-	{
-		float angle = start_angle + slice_angle * (float)i;
-		points[i].x = center.x + cosf(angle) * radius;
-		points[i].y = center.y - sinf(angle) * radius;
+// Points along an arc in board coordinates, board y goes up the screen
+static void ArcPoints(const PcbArc &arc, int segments, std::vector<ImVec2> &points) {
+	points.resize(segments + 1);
+	for (int j = 0; j <= segments; j++) {
+		float angle = arc.startAngle + (arc.endAngle - arc.startAngle) * j / segments;
+		points[j]   = ImVec2(arc.position.x + cosf(angle) * arc.radius, arc.position.y + sinf(angle) * arc.radius);
 	}
-
-	draw_list->AddPolyline(points, num_segments + 1, color, false, thickness);
-	delete[] points;
 }
 
 inline void BoardView::DrawArcs(ImDrawList *draw) {
@@ -4285,17 +3845,32 @@ inline void BoardView::DrawArcs(ImDrawList *draw) {
 	}
 	draw->ChannelsSetCurrent(kChannelPolylines);
 
+	// The retained layer has the arcs, only the selected net's are drawn over it
+	if (m_drawRetained && !m_pinSelected && !m_viaSelected) return;
+
+	ImVec2 view_min, view_max;
+	std::vector<uint32_t> visible;
+	VisibleBoardRect(view_min, view_max);
+	Index().arcs.query(view_min, view_max, visible);
+
+	// Points go through the view transform as the retained layer's do, so rotation and side flips apply
+	std::vector<ImVec2> points;
 	const auto& arcs = m_board->arcs();
-	for (const auto &arc : arcs) {
-		if (!(m_pinSelected && m_pinSelected->net == arc->net) && !(m_viaSelected && m_viaSelected->net == arc->net) && !BoardElementIsVisible(arc)) continue;
-		ImVec2 pos = CoordToScreen(arc->position.x, arc->position.y);
+	for (uint32_t i : visible) {
+		const auto &arc = arcs[i];
+		bool selected = (m_pinSelected && m_pinSelected->net == arc->net) || (m_viaSelected && m_viaSelected->net == arc->net);
+		if (m_drawRetained && !selected) continue;
+		if (!selected && !BoardElementIsVisible(arc)) continue;
 
 		uint32_t color      = (m_colors.layerColor[arc->board_side][0] & cmask) | omask;
 		auto radius = arc->radius * m_scale;
-		if ((m_pinSelected && m_pinSelected->net == arc->net ) || (m_viaSelected && m_viaSelected->net == arc->net)) {
-			DrawArc(draw, pos, radius, m_colors.defaultBoardSelectColor, arc->startAngle, arc->endAngle, 50, m_scale*1.5);
+		int segments = ArcSegments(radius, arc->startAngle, arc->endAngle);
+		ArcPoints(*arc, segments, points);
+		for (auto &point : points) point = CoordToScreen(point.x, point.y);
+		if (selected) {
+			draw->AddPolyline(points.data(), segments + 1, m_colors.defaultBoardSelectColor, false, m_scale*1.5);
 		}
-		DrawArc(draw, pos, radius, color, arc->startAngle, arc->endAngle, 50, m_scale);
+		draw->AddPolyline(points.data(), segments + 1, color, false, m_scale);
 		//draw->AddText(pos, color, std::to_string(arc->startAngle * 180 / 3.1415).c_str());
 		//draw->AddText(ImVec2(pos.x, pos.y - 10), color, std::to_string(arc->endAngle * 180 / 3.1415).c_str());
 	}
@@ -4332,26 +3907,37 @@ inline void BoardView::DrawVies(ImDrawList *draw) {
 	}
 	draw->ChannelsSetCurrent(kChannelPolylines);
 
+	// The retained layer has the vias, only the selected net's and side labels are drawn over it
+	if (m_drawRetained && !m_pinSelected && !m_viaSelected && Index().vias.max_extent() * 0.5 * m_scale <= 3) return;
+
+	ImVec2 view_min, view_max;
+	std::vector<uint32_t> visible;
+	VisibleBoardRect(view_min, view_max);
+	Index().vias.query(view_min, view_max, visible);
+
 	const auto& vias = m_board->Vias();
-	for (const auto &via : vias) {
-		if (!(m_pinSelected && m_pinSelected->net == via->net) && !(m_viaSelected && m_viaSelected->net == via->net) && !BoardElementIsVisible(via)) continue;
+	for (uint32_t i : visible) {
+		const auto &via = vias[i];
+		bool selected = (m_pinSelected && m_pinSelected->net == via->net) || (m_viaSelected && m_viaSelected->net == via->net);
+		if (!selected && !BoardElementIsVisible(via)) continue;
 		auto pos = CoordToScreen(via->position.x, via->position.y);
 		auto radius = via->size * 0.5 * m_scale;
+		if (m_drawRetained && !selected && radius <= 3) continue;
 		if (!IsVisibleScreen(pos.x, pos.y, radius, io)) continue;
 
 		uint32_t color      = (m_colors.viaColor & cmask) | omask;
-		if ((m_pinSelected && m_pinSelected->net == via->net) || (m_viaSelected && m_viaSelected->net == via->net)) {
+		if (selected) {
 			color      = m_colors.pinSelectedColor;
 		}
-		draw->AddCircleFilled(pos, radius, color);
+		if (!m_drawRetained || selected) draw->AddCircleFilled(pos, radius, color, CircleSegments(radius));
 		if (radius > 3) {
 			const auto offset = radius * 0.5;
 			const auto leftPos = ImVec2(pos.x - offset, pos.y - offset);
 			const auto rightPos = ImVec2(pos.x + 0.5f, pos.y - offset);
-			auto text = std::to_string(via->board_side);
-			auto text1 = std::to_string(via->target_side);
+			auto &text = m_labels.side(via->board_side);
+			auto &text1 = m_labels.side(via->target_side);
 			ImFont *font = ImGui::GetIO().Fonts->Fonts[0]; // Default font
-			ImVec2 text_size_normalized = font->CalcTextSizeA(1.0f, FLT_MAX, 0.0f, text.c_str());
+			ImVec2 text_size_normalized = text.size;
 
 			float maxfontwidth = radius * 1/ text_size_normalized.x; // Fit horizontally with 6.75% overflow (should still avoid colliding with neighbours)
 			float maxfontheight = radius * 1/ text_size_normalized.y; // Fit vertically with 25% top/bottom padding
@@ -4364,12 +3950,13 @@ inline void BoardView::DrawVies(ImDrawList *draw) {
 				font = ImGui::GetIO().Fonts->Fonts[1]; // Use larger font for pin name
 			}
 
-			DrawFilledSemiCircle(draw, pos, radius*0.8, m_colors.layerColor[via->board_side][0], false);
-			DrawFilledSemiCircle(draw, pos, radius*0.8, m_colors.layerColor[via->target_side][0], true);
+			int segments = std::max(2, CircleSegments(radius * 0.8) / 2);
+			DrawFilledSemiCircle(draw, pos, radius*0.8, m_colors.layerColor[via->board_side][0], false, segments);
+			DrawFilledSemiCircle(draw, pos, radius*0.8, m_colors.layerColor[via->target_side][0], true, segments);
 
 			draw->ChannelsSetCurrent(kChannelText);
-			draw->AddText(font, maxfontsize, leftPos, 0xFFFFFFFF, text.c_str());
-			draw->AddText(font, maxfontsize, rightPos, 0xFFFFFFFF, text1.c_str());
+			draw->AddText(font, maxfontsize, leftPos, 0xFFFFFFFF, text.text.c_str());
+			draw->AddText(font, maxfontsize, rightPos, 0xFFFFFFFF, text1.text.c_str());
 			draw->ChannelsSetCurrent(kChannelPins);
 		}
 	}
@@ -4386,20 +3973,24 @@ void BoardView::DrawPartTooltips(ImDrawList *draw) {
 	 * I am loathing that I have to add this, but basically check every pin on the board so we can
 	 * determine if we're hovering over a testpad
 	 */
-	for (auto &pin : m_board->Pins()) {
-
-		if (pin->type == Pin::kPinTypeTestPad) {
-			float dx   = pin->position.x - pos.x;
-			float dy   = pin->position.y - pos.y;
+	const auto &store = m_board->Store();
+	std::vector<uint32_t> hits;
+	Index().pins.query(pos, hits);
+	for (uint32_t i : hits) {
+
+		if (store.pin_type[i] == Pin::kPinTypeTestPad) {
+			float dx   = store.pin_x[i] - pos.x;
+			float dy   = store.pin_y[i] - pos.y;
 			float dist = dx * dx + dy * dy;
-			if ((dist < (pin->diameter * pin->diameter))) {
-				float pd = pin->diameter * m_scale;
+			if ((dist < (store.pin_diameter[i] * store.pin_diameter[i]))) {
+				auto &pin = m_board->Pins()[i];
+				float pd  = pin->diameter() * m_scale;
 
-				draw->AddCircle(CoordToScreen(pin->position.x, pin->position.y), pd, m_colors.pinHaloColor, 32, pinHaloThickness);
+				draw->AddCircle(CoordToScreen(pin->position().x, pin->position().y), pd, m_colors.pinHaloColor, 32, pinHaloThickness);
 				ImGui::PushStyleColor(ImGuiCol_Text, m_colors.annotationPopupTextColor);
 				ImGui::PushStyleColor(ImGuiCol_PopupBg, m_colors.annotationPopupBackgroundColor);
 				ImGui::BeginTooltip();
-				ImGui::Text("TP[%s]%s", pin->name.c_str(), pin->net->name.c_str());
+				ImGui::Text("TP[%s]%s", pin->name.data(), pin->net->name.data());
 				ImGui::EndTooltip();
 				ImGui::PopStyleColor(2);
 				break;
@@ -4408,25 +3999,13 @@ void BoardView::DrawPartTooltips(ImDrawList *draw) {
 	}
 
 	currentlyHoveredPart = nullptr;
-	for (auto &part : m_board->Components()) {
+	Index().parts.query(pos, hits);
+	for (uint32_t part_index : hits) {
+		auto &part = m_board->Components()[part_index];
 		if (part->component_type == Component::kComponentTypeBoard) continue;
-		int hit = 0;
-		//		auto p_part = part.get();
-
-
-		// Work out if the point is inside the hull
-		{
-			auto poly = part->outline;
-
-			for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
-				if (((poly[i].y > pos.y) != (poly[j].y > pos.y)) &&
-				    (pos.x < (poly[j].x - poly[i].x) * (pos.y - poly[i].y) / (poly[j].y - poly[i].y) + poly[i].x))
-					hit ^= 1;
-			}
-		}
 
 		// If we're inside a part
-		if (hit) {
+		if (BoardIndex::part_contains(*part, pos)) {
 			currentlyHoveredPart = part;
 			//			fprintf(stderr,"InPart: %s\n", currentlyHoveredPart->name.c_str());
 
@@ -4434,18 +4013,17 @@ void BoardView::DrawPartTooltips(ImDrawList *draw) {
 			min_dist *= min_dist; // all distance squared
 			currentlyHoveredPin = nullptr;
 
-			for (auto &pin : currentlyHoveredPart->pins) {
-				// auto p     = pin;
-				float dx   = pin->position.x - pos.x;
-				float dy   = pin->position.y - pos.y;
+			for (uint32_t i : store.component_pin_range(currentlyHoveredPart->index)) {
+				float dx   = store.pin_x[i] - pos.x;
+				float dy   = store.pin_y[i] - pos.y;
 				float dist = dx * dx + dy * dy;
 
-				if (pin->net->is_ground || !BoardElementIsVisible(pin)) {
+				if (store.pin_ground[i] || !SideIsVisible(store.pin_side[i])) {
 					continue;
 				}
 
-				if ((dist < (pin->diameter * pin->diameter)) && (dist < min_dist)) {
-					currentlyHoveredPin = pin;
+				if ((dist < (store.pin_diameter[i] * store.pin_diameter[i])) && (dist < min_dist)) {
+					currentlyHoveredPin = m_board->Pins()[i];
 					//					fprintf(stderr,"Pinhit: %s\n",pin->number.c_str());
 					min_dist = dist;
 				} // if in the required diameter
@@ -4472,8 +4050,8 @@ void BoardView::DrawPartTooltips(ImDrawList *draw) {
 			draw->ChannelsSetCurrent(kChannelAnnotations);
 
 			if (currentlyHoveredPin)
-				draw->AddCircle(CoordToScreen(currentlyHoveredPin->position.x, currentlyHoveredPin->position.y),
-				                currentlyHoveredPin->diameter * m_scale,
+				draw->AddCircle(CoordToScreen(currentlyHoveredPin->position().x, currentlyHoveredPin->position().y),
+				                currentlyHoveredPin->diameter() * m_scale,
 				                m_colors.pinHaloColor,
 				                32,
 				                pinHaloThickness);
@@ -4482,11 +4060,11 @@ void BoardView::DrawPartTooltips(ImDrawList *draw) {
 			ImGui::BeginTooltip();
 			if (currentlyHoveredPin) {
 				ImGui::Text("%s\n[%s]%s",
-				            currentlyHoveredPart->name.c_str(),
-				            (currentlyHoveredPin ? currentlyHoveredPin->name.c_str() : " "),
-				            (currentlyHoveredPin ? currentlyHoveredPin->net->name.c_str() : " "));
+				            currentlyHoveredPart->name.data(),
+				            (currentlyHoveredPin ? currentlyHoveredPin->name.data() : " "),
+				            (currentlyHoveredPin ? currentlyHoveredPin->net->name.data() : " "));
 			} else {
-				ImGui::Text("%s", currentlyHoveredPart->name.c_str());
+				ImGui::Text("%s", currentlyHoveredPart->name.data());
 			}
 			ImGui::EndTooltip();
 			ImGui::PopStyleColor(2);
@@ -4504,9 +4082,9 @@ inline void BoardView::DrawPinTooltips(ImDrawList *draw) {
 		ImGui::PushStyleColor(ImGuiCol_PopupBg, m_colors.annotationPopupBackgroundColor);
 		ImGui::BeginTooltip();
 		ImGui::Text("%s[%s]\n%s",
-		            m_pinHighlightedHovered->component->name.c_str(),
-		            m_pinHighlightedHovered->name.c_str(),
-		            m_pinHighlightedHovered->net->name.c_str());
+		            m_pinHighlightedHovered->component->name.data(),
+		            m_pinHighlightedHovered->name.data(),
+		            m_pinHighlightedHovered->net->name.data());
 		ImGui::EndTooltip();
 		ImGui::PopStyleColor(2);
 	}
@@ -4571,24 +4149,36 @@ bool BoardView::HighlightedPinIsHovered(void) {
 	 * See if any of the pins listed in the m_pinHighlighted vector are hovered over
 	 */
 	for (auto &p : m_pinHighlighted) {
-		ImVec2 a = ImVec2(p->position.x, p->position.y);
-		double r = p->diameter / 2.0f;
+		ImVec2 a = ImVec2(p->position().x, p->position().y);
+		double r = p->diameter() / 2.0f;
 		if ((mpc.x > a.x - r) && (mpc.x < a.x + r) && (mpc.y > a.y - r) && (mpc.y < a.y + r)) {
 			m_pinHighlightedHovered = p;
 			return true;
 		}
 	}
 
+	/*
+	 * The rest only looks at pins under the mouse, within the largest scaled pin radius
+	 */
+	const auto &store = m_board->Store();
+	auto &index       = Index();
+	float radius      = index.pins.max_extent() / 2.0f * m_scale;
+	std::vector<uint32_t> hits;
+	index.pins.query(ImVec2(mpc.x - radius, mpc.y - radius), ImVec2(mpc.x + radius, mpc.y + radius), hits);
+
+	auto is_hovered = [&](uint32_t i) {
+		double r = store.pin_diameter[i] / 2.0f * m_scale;
+		ImVec2 a = ImVec2(store.pin_x[i], store.pin_y[i]);
+		return (mpc.x > a.x - r) && (mpc.x < a.x + r) && (mpc.y > a.y - r) && (mpc.y < a.y + r);
+	};
+
 	/*
 	 * See if any of the pins in the same network as the SELECTED pin (single) are hovered
 	 */
-	for (auto &p : m_board->Pins()) {
-		//	auto p   = pin.get();
-		double r = p->diameter / 2.0f * m_scale;
-		if (m_pinSelected && p->net == m_pinSelected->net) {
-			ImVec2 a = ImVec2(p->position.x, p->position.y);
-			if ((mpc.x > a.x - r) && (mpc.x < a.x + r) && (mpc.y > a.y - r) && (mpc.y < a.y + r)) {
-				m_pinHighlightedHovered = p;
+	if (m_pinSelected) {
+		for (uint32_t i : hits) {
+			if (store.pin_net[i] == m_pinSelected->net->index && is_hovered(i)) {
+				m_pinHighlightedHovered = m_board->Pins()[i];
 				return true;
 			}
 		}
@@ -4598,11 +4188,9 @@ bool BoardView::HighlightedPinIsHovered(void) {
 	 * See if any pins of a highlighted part are hovered
 	 */
 	for (auto &part : m_partHighlighted) {
-		for (auto &p : part->pins) {
-			double r = p->diameter / 2.0f * m_scale;
-			ImVec2 a = ImVec2(p->position.x, p->position.y);
-			if ((mpc.x > a.x - r) && (mpc.x < a.x + r) && (mpc.y > a.y - r) && (mpc.y < a.y + r)) {
-				m_pinHighlightedHovered = p;
+		for (uint32_t i : hits) {
+			if (store.pin_component[i] == part->index && is_hovered(i)) {
+				m_pinHighlightedHovered = m_board->Pins()[i];
 				return true;
 			}
 		}
@@ -4645,7 +4233,7 @@ void BoardView::DrawSelectedPins(ImDrawList *draw) {
 	std::vector<ImVec2> pl;
 	if ((m_pinHighlighted.size()) < 3) return;
 	for (auto &p : m_pinHighlighted) {
-		pl.push_back(CoordToScreen(p->position.x, p->position.y));
+		pl.push_back(CoordToScreen(p->position().x, p->position().y));
 	}
 	std::vector<ImVec2> hull = VHConvexHull(pl);
 	if (hull.size() > 3) {
@@ -4653,9 +4241,398 @@ void BoardView::DrawSelectedPins(ImDrawList *draw) {
 	}
 }
 
+/*
+ * Draws the board geometry that only changes with the view settings, in board coordinates, for the
+ * retained layer or a tile. pixel is the size of a screen pixel in board units at the zoom octave the
+ * layer is built for, it sizes what is measured in pixels on screen (hairlines, pin size thresholds).
+ * With a region, only what overlaps it is drawn.
+ * The selection masks, highlights, labels, board outline and fill stay with the Draw* functions.
+ */
+void BoardView::BuildBoardLayer(ImDrawList *draw, float pixel, const SpatialGrid::Box *region) {
+	uint32_t cmask = 0xFFFFFFFF;
+	uint32_t omask = 0x00000000;
+	uint32_t part_color = m_colors.partOutlineColor;
+	if (LayerMasked()) {
+		cmask      = m_colors.selectedMaskPins;
+		omask      = m_colors.orMaskPins;
+		part_color = (m_colors.partOutlineColor & m_colors.selectedMaskParts) | m_colors.orMaskParts;
+	}
+	const BoardLod::Level *lod = m_lod.level(*m_board, 1.0f / pixel);
+
+	// Indices of the elements of a grid in the region, or of all count of them
+	std::vector<uint32_t> items;
+	auto select = [&](const SpatialGrid &grid, size_t count) -> const std::vector<uint32_t> & {
+		if (region) {
+			grid.query(region->min, region->max, items);
+		} else {
+			items.resize(count);
+			std::iota(items.begin(), items.end(), 0);
+		}
+		return items;
+	};
+	auto overlaps = [region](ImVec2 min, ImVec2 max) {
+		return !region || (min.x <= region->max.x && max.x >= region->min.x && min.y <= region->max.y && max.y >= region->min.y);
+	};
+
+	// Tracks
+	if (lod) {
+		for (auto &path : lod->track_paths) {
+			if (!SideIsVisible(path.side) || !overlaps(path.min, path.max)) continue;
+			uint32_t color = (m_colors.layerColor[path.side][0] & cmask) | omask;
+			draw->AddPolyline(path.points.data(), static_cast<int>(path.points.size()), color, false, path.width);
+		}
+	} else {
+		auto &tracks = m_board->Tracks();
+		for (uint32_t i : select(Index().tracks, tracks.size())) {
+			auto &track = tracks[i];
+			if (!SideIsVisible(track->board_side)) continue;
+			uint32_t color = (m_colors.layerColor[track->board_side][0] & cmask) | omask;
+			draw->AddLine(ImVec2(track->position_start.x, track->position_start.y), ImVec2(track->position_end.x, track->position_end.y), color, track->width);
+		}
+	}
+
+	// Arcs
+	std::vector<ImVec2> points;
+	auto &arcs = m_board->arcs();
+	for (uint32_t i : select(Index().arcs, arcs.size())) {
+		auto &arc = arcs[i];
+		if (!SideIsVisible(arc->board_side)) continue;
+		uint32_t color = (m_colors.layerColor[arc->board_side][0] & cmask) | omask;
+		int segments   = ArcSegments(arc->radius / pixel, arc->startAngle, arc->endAngle);
+		ArcPoints(*arc, segments, points);
+		draw->AddPolyline(points.data(), segments + 1, color, false, 1.0f);
+	}
+
+	// Vias
+	auto &vias = m_board->Vias();
+	for (uint32_t i : select(Index().vias, vias.size())) {
+		auto &via = vias[i];
+		if (!SideIsVisible(via->board_side)) continue;
+		float radius = via->size * 0.5f;
+		draw->AddCircleFilled(ImVec2(via->position.x, via->position.y), radius, (m_colors.viaColor & cmask) | omask, CircleSegments(radius / pixel));
+	}
+
+	// Parts
+	auto &components = m_board->Components();
+	for (uint32_t i : select(Index().parts, components.size())) {
+		auto &part = components[i];
+		if (part->is_dummy() || !part->outline_done || !SideIsVisible(part->board_side)) continue;
+
+		ImVec2 a(part->outline[0].x, part->outline[0].y), b(part->outline[1].x, part->outline[1].y);
+		ImVec2 c(part->outline[2].x, part->outline[2].y), d(part->outline[3].x, part->outline[3].y);
+		if (fillParts && !slowCPU) draw->AddQuadFilled(a, b, c, d, m_colors.partFillColor);
+		draw->AddQuad(a, b, c, d, part_color, pixel);
+		if (part->component_type == Component::kComponentTypeBoard) draw->AddQuadFilled(a, b, c, d, m_colors.boardFillColor);
+
+		if (!part->hull.empty()) {
+			draw->PathClear();
+			for (auto &p : part->hull) draw->PathLineTo(ImVec2(p.x, p.y));
+			draw->PathStroke(m_colors.partHullColor, true, pixel);
+		}
+
+		if (part->component_type == part->kComponentTypeCapacitor && part->expanse > 90) {
+			int segments = std::clamp(static_cast<int>(trunc(part->expanse)), 8, 36);
+			draw->AddCircle(ImVec2(part->centerpoint.x, part->centerpoint.y), part->expanse / 3, m_colors.partOutlineColor & 0x8fffffff, segments, pixel);
+		}
+	}
+
+	if (!showPins) return;
+
+	// Pins, as DrawPins() draws them when nothing is highlighted
+	float threshold = m_pinSelected ? 0.0f : PinSizeThreshold();
+
+	if (lod) {
+		uint32_t color  = (m_colors.pinDefaultColor & cmask) | omask;
+		uint32_t alpha  = (color & IM_COL32_A_MASK) >> IM_COL32_A_SHIFT;
+		float half_cell = lod->cell_size / 2;
+		for (auto &cell : lod->pin_cells) {
+			if (!SideIsVisible(cell.side) || cell.diameter / pixel < threshold) continue;
+			if (!overlaps(ImVec2(cell.center.x - half_cell, cell.center.y - half_cell), ImVec2(cell.center.x + half_cell, cell.center.y + half_cell))) continue;
+			uint32_t cell_color = (color & ~IM_COL32_A_MASK) | (static_cast<uint32_t>(alpha * cell.coverage) << IM_COL32_A_SHIFT);
+			draw->AddRectFilled(ImVec2(cell.center.x - half_cell, cell.center.y - half_cell), ImVec2(cell.center.x + half_cell, cell.center.y + half_cell), cell_color);
+		}
+	}
+
+	auto &pins = m_board->Pins();
+	for (uint32_t i : select(Index().pins, pins.size())) {
+		auto &pin = pins[i];
+		float psz = pin->diameter() / pixel;
+		if (!SideIsVisible(pin->board_side) || psz < threshold) continue;
+		if (lod && pin->diameter() < lod->pin_diameter_limit) continue;
+
+		uint32_t fill_color = 0xFFFF8888;
+		uint32_t color      = (m_colors.pinDefaultColor & cmask) | omask;
+		bool fill_pin       = false;
+		bool draw_ring      = true;
+
+		if (pin->type == Pin::kPinTypeTestPad) {
+			color      = (m_colors.pinTestPadColor & cmask) | omask;
+			fill_color = (m_colors.pinTestPadFillColor & cmask) | omask;
+		}
+		if (!pin->net || pin->type == Pin::kPinTypeNotConnected) {
+			color = fill_color = (m_colors.pinNotConnectedColor & cmask) | omask;
+			fill_pin           = true;
+		}
+		if (pin->net && pin->net->is_ground) {
+			color = fill_color = m_colors.pinGroundColor;
+			fill_pin           = true;
+		}
+		if (pin->name == "A1" || (pin->number == "1" && pin->component->pins.size() >= static_cast<unsigned int>(pinA1threshold))) {
+			color = fill_color = m_colors.pinA1PadColor;
+			fill_pin           = true;
+			draw_ring          = false;
+		}
+
+		ImVec2 pos(pin->position().x, pin->position().y);
+		float r        = pin->diameter();
+		int segments   = std::min(CircleSegments(psz), 32);
+		float h        = r / 2 + 0.5f * pixel;
+		float w        = h;
+		if (pin->shape == kShapeTypeRect) {
+			w = pin->size.x / 2 + 0.5f * pixel;
+			h = pin->size.y / 2 + 0.5f * pixel;
+		}
+		if (pin->angle == 90 || pin->angle == 270) std::swap(w, h);
+		ImVec2 min(pos.x - w, pos.y - h), max(pos.x + w, pos.y + h);
+
+		if (pin->type == Pin::kPinTypeTestPad) {
+			if ((psz > 3) && (!slowCPU)) {
+				draw->AddCircleFilled(pos, r, fill_color, segments);
+				draw->AddCircle(pos, r, color, segments, pixel);
+			} else if (psz > threshold) {
+				draw->AddRectFilled(min, max, fill_color);
+			}
+		} else if ((psz > 3) && !(pinShapeSquare || slowCPU || pin->shape == kShapeTypeRect)) {
+			if (fill_pin) draw->AddCircleFilled(pos, r, fill_color, segments);
+			if (draw_ring) draw->AddCircle(pos, r, color, segments, pixel);
+		} else if (psz > threshold) {
+			if (fill_pin) draw->AddRectFilled(min, max, fill_color);
+			if (draw_ring) draw->AddRect(min, max, color, 0.0f, 0, pixel);
+		}
+	}
+}
+
+// Pixels under which pins are left out of the layer and the tiles, unless a pin is selected
+float BoardView::PinSizeThreshold() {
+	float threshold = slowCPU ? 2.0f : 0.0f;
+	if (pinSizeThresholdLow > threshold) threshold = pinSizeThresholdLow;
+	return threshold;
+}
+
+// Whether the selection masks recolour the layer and the tiles, they are the identity by default
+bool BoardView::LayerMasked() {
+	bool identity = m_colors.selectedMaskPins == 0xFFFFFFFF && m_colors.orMaskPins == 0 && m_colors.selectedMaskParts == 0xFFFFFFFF &&
+	                m_colors.orMaskParts == 0;
+	return pinSelectMasks && (m_pinSelected || m_pinHighlighted.size()) && !identity;
+}
+
+/*
+ * Hash of the view settings the retained layer and the tiles are drawn with. The selection only
+ * comes in through masks that recolour everything, pin selection changes are left to the callers.
+ */
+size_t BoardView::BoardLayerKey() {
+	size_t key   = 0;
+	auto combine = [&key](size_t value) { key ^= value + 0x9e3779b9 + (key << 6) + (key >> 2); };
+	combine(m_current_side);
+	combine(m_track_mode);
+	combine(LayerMasked());
+	combine(showPins);
+	combine(pinShapeSquare);
+	combine(slowCPU);
+	combine(fillParts);
+	combine(pinA1threshold);
+	combine(std::hash<float>()(pinSizeThresholdLow));
+	combine(std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *>(&m_colors), sizeof(m_colors))));
+	return key;
+}
+
+/*
+ * Queues the retained layer, rebuilt first if the board or the view settings it depends on
+ * changed. Panning, rotating and zooming within an octave only change its transform.
+ */
+void BoardView::DrawBoardLayer(ImDrawList *draw) {
+	int octave  = static_cast<int>(std::ceil(std::log2(1.0f / m_scale)));
+	float pixel = std::exp2(static_cast<float>(octave));
+	size_t key  = BoardLayerKey() ^ (std::hash<int>()(octave) << 1);
+	key ^= std::hash<bool>()(m_pinSelected && PinSizeThreshold() > 0.0f) << 2; // shows the small pins, the layer is rebuilt whole
+
+	if (m_boardLayerDirty || key != m_boardLayerKey) {
+		ImDrawList layer(ImGui::GetDrawListSharedData());
+		layer._ResetForNewFrame();
+		layer.Flags        = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill | ImDrawListFlags_AllowVtxOffset;
+		layer._FringeScale = pixel; // antialias over a screen pixel, not a board unit
+		layer.PushTextureID(ImGui::GetIO().Fonts->TexID);
+		layer.PushClipRect(ImVec2(-FLT_MAX, -FLT_MAX), ImVec2(FLT_MAX, FLT_MAX));
+		BuildBoardLayer(&layer, pixel);
+		m_boardLayer->upload(layer);
+
+		m_boardLayerKey   = key;
+		m_boardLayerDirty = false;
+	}
+
+	// Above the board fill, under everything else
+	draw->ChannelsSetCurrent(kChannelFill);
+	ImVec2 origin = CoordToScreen(0.0f, 0.0f);
+	m_boardLayer->draw(draw, origin, CoordToScreen(1.0f, 0.0f, 0.0f), CoordToScreen(0.0f, 1.0f, 0.0f));
+}
+
+/*
+ * Board fill lines of the region for a tile, as OutlineGenFillDraw() draws them but on scan lines
+ * every boardFillSpacing pixels of the whole board, so neighbouring tiles line up
+ */
+void BoardView::BuildBoardFill(ImDrawList *draw, float pixel, const SpatialGrid::Box &region) {
+	if (!boardFill || slowCPU || boardFillSpacing <= 0) return;
+
+	std::vector<ImVec2> scanhits;
+	OutlineEdges::Scanner scanner(m_outlineEdges);
+	double vdelta = boardFillSpacing * static_cast<double>(pixel);
+	for (double y = std::ceil(region.min.y / vdelta) * vdelta; y <= region.max.y; y += vdelta) {
+		scanner.hits(y, scanhits);
+		for (size_t i = 0; i + 1 < scanhits.size(); i += 2) {
+			if (scanhits[i + 1].x < region.min.x || scanhits[i].x > region.max.x) continue;
+			draw->AddLine(scanhits[i], scanhits[i + 1], m_colors.boardFillColor, pixel);
+		}
+	}
+}
+
+/*
+ * Without a retained layer, the board is drawn from a pyramid of rendered tiles, in the orientation
+ * of the view, at the zoom octave just above the scale so they are shrunk at most by half.
+ * Missing and stale tiles are rendered a few per frame while the tiles around them or a coarser
+ * level stand in, m_tilesPending keeps frames coming until they are all done.
+ * The tiles are opaque, they have the background, board fill and what the retained layer would draw.
+ */
+void BoardView::DrawBoardTiles(ImDrawList *draw) {
+	constexpr int kTileSize         = TileCache::kTileSize;
+	constexpr int kFallbackLevels   = 4;   // coarser levels looked at for a missing tile
+	constexpr double kFrameBudgetMs = 8.0; // spent rendering tiles per frame, at least one is
+	auto frame_start                = std::chrono::steady_clock::now();
+
+	int level    = static_cast<int>(std::floor(std::log2(1.0f / m_scale)));
+	double scale = std::exp2(-static_cast<double>(level)); // level pixels per board unit
+	float pixel  = static_cast<float>(1.0 / scale);
+	float zoom   = static_cast<float>(m_scale / scale); // from tile to screen pixels
+
+	// Board units to level pixels, a rotation and maybe a flip
+	ImVec2 axis_x = CoordToScreen(1.0f, 0.0f, 0.0f), axis_y = CoordToScreen(0.0f, 1.0f, 0.0f);
+	axis_x        = ImVec2(std::round(axis_x.x / m_scale), std::round(axis_x.y / m_scale));
+	axis_y        = ImVec2(std::round(axis_y.x / m_scale), std::round(axis_y.y / m_scale));
+	ImVec2 origin = CoordToScreen(0.0f, 0.0f);
+
+	int view = m_rotation + 4 * (m_current_side * 2 + m_track_mode);
+	if (m_boardLayerDirty) {
+		m_tilesGeneration++;
+		m_boardLayerDirty = false;
+	}
+	size_t state = BoardLayerKey();
+	state ^= std::hash<size_t>()(m_tilesGeneration) + 0x9e3779b9 + (state << 6) + (state >> 2);
+	state ^= (boardFill ? boardFillSpacing : 0) + 0x9e3779b9 + (state << 6) + (state >> 2);
+
+	// Selecting a pin shows the pins under the size threshold, only the tiles with such pins change
+	if ((m_pinSelected != nullptr) != m_tilesPinSelected) {
+		m_tilesPinSelected = m_pinSelected != nullptr;
+		float threshold    = PinSizeThreshold();
+		if (threshold > 0.0f) {
+			auto &store = m_board->Store();
+			std::vector<uint32_t> found;
+			m_tiles->invalidate([&](const TileCache::Key &key, const ImVec2 &min, const ImVec2 &max) {
+				float tile_pixel = std::exp2(static_cast<float>(key.level));
+				// Zoomed out, a pin is drawn as part of a cell that reaches past it
+				const BoardLod::Level *lod = m_lod.level(*m_board, 1.0f / tile_pixel);
+				float grow                 = lod ? lod->cell_size : 0.0f;
+				Index().pins.query(ImVec2(min.x - grow, min.y - grow), ImVec2(max.x + grow, max.y + grow), found);
+				return std::any_of(found.begin(), found.end(), [&](uint32_t i) { return store.pin_diameter[i] / tile_pixel < threshold; });
+			});
+		}
+	}
+
+	// Tiles over the surface
+	ImVec2 win_min = ImGui::GetWindowPos();
+	ImVec2 win_max(win_min.x + ImGui::GetWindowSize().x, win_min.y + ImGui::GetWindowSize().y);
+	int x0 = static_cast<int>(std::floor((win_min.x - origin.x) / zoom / kTileSize));
+	int x1 = static_cast<int>(std::floor((win_max.x - origin.x) / zoom / kTileSize));
+	int y0 = static_cast<int>(std::floor((win_min.y - origin.y) / zoom / kTileSize));
+	int y1 = static_cast<int>(std::floor((win_max.y - origin.y) / zoom / kTileSize));
+
+	auto floor_div = [](int a, int b) { return a / b - (a % b != 0 && (a < 0) != (b < 0)); };
+	ImVec4 background = ImGui::ColorConvertU32ToFloat4(m_colors.backgroundColor);
+
+	m_tiles->beginFrame();
+	int rendered = 0;
+	draw->ChannelsSetCurrent(kChannelImages);
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			TileCache::Key key{view, level, x, y};
+			bool fresh     = false;
+			GLuint texture = m_tiles->find(key, state, &fresh);
+
+			auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+			if (!fresh && (rendered == 0 || elapsed < kFrameBudgetMs)) {
+				// Board rectangle of the tile, with some room for the antialiasing fringe
+				SpatialGrid::Box region{{FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX}};
+				for (int corner = 0; corner < 4; corner++) {
+					double qx = (x + (corner & 1)) * kTileSize / scale, qy = (y + (corner >> 1)) * kTileSize / scale;
+					ImVec2 b(static_cast<float>(axis_x.x * qx + axis_x.y * qy), static_cast<float>(axis_y.x * qx + axis_y.y * qy));
+					region.min = ImVec2(std::min(region.min.x, b.x), std::min(region.min.y, b.y));
+					region.max = ImVec2(std::max(region.max.x, b.x), std::max(region.max.y, b.y));
+				}
+				region.min = ImVec2(region.min.x - 2 * pixel, region.min.y - 2 * pixel);
+				region.max = ImVec2(region.max.x + 2 * pixel, region.max.y + 2 * pixel);
+
+				ImDrawList list(ImGui::GetDrawListSharedData());
+				list._ResetForNewFrame();
+				list.Flags        = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill | ImDrawListFlags_AllowVtxOffset;
+				list._FringeScale = pixel;
+				list.PushTextureID(ImGui::GetIO().Fonts->TexID);
+				list.PushClipRect(ImVec2(-FLT_MAX, -FLT_MAX), ImVec2(FLT_MAX, FLT_MAX));
+				BuildBoardFill(&list, pixel, region);
+				BuildBoardLayer(&list, pixel, &region);
+
+				// From board units to the tile's pixels, in double as level pixels get large zoomed in
+				for (auto &v : list.VtxBuffer) {
+					double qx = (axis_x.x * v.pos.x + axis_y.x * v.pos.y) * scale;
+					double qy = (axis_x.y * v.pos.x + axis_y.y * v.pos.y) * scale;
+					v.pos     = ImVec2(static_cast<float>(qx - x * kTileSize), static_cast<float>(qy - y * kTileSize));
+				}
+				for (auto &cmd : list.CmdBuffer) cmd.ClipRect = ImVec4(0.0f, 0.0f, kTileSize, kTileSize);
+
+				GLuint result = m_tiles->render(key, state, list, background, region.min, region.max);
+				if (result) {
+					texture = result;
+					fresh   = true;
+				}
+				rendered++;
+			}
+			if (!fresh) m_tilesPending = true;
+
+			// Texture rows go bottom up
+			ImVec2 min(origin.x + zoom * x * kTileSize, origin.y + zoom * y * kTileSize);
+			ImVec2 max(min.x + zoom * kTileSize, min.y + zoom * kTileSize);
+			if (texture) {
+				draw->AddImage(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(texture)), min, max, ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f));
+				continue;
+			}
+
+			// Part of a coarser tile in the meantime
+			for (int up = 1; up <= kFallbackLevels; up++) {
+				int n = 1 << up;
+				TileCache::Key coarse{view, level + up, floor_div(x, n), floor_div(y, n)};
+				texture = m_tiles->find(coarse, state, &fresh);
+				if (!texture) continue;
+				float u0 = static_cast<float>(x - coarse.x * n) / n, v0 = static_cast<float>(y - coarse.y * n) / n;
+				draw->AddImage(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(texture)), min, max, ImVec2(u0, 1.0f - v0), ImVec2(u0 + 1.0f / n, 1.0f - v0 - 1.0f / n));
+				break;
+			}
+		}
+	}
+}
+
 void BoardView::DrawBoard() {
 	if (!m_file || !m_board) return;
 
+	// Highlights change from many places, e.g. searches, not all of them ask for a redraw
+	if (SelectionGeneration() != m_drawnSelection) m_needsRedraw = true;
+
 	ImDrawList *draw = ImGui::GetWindowDrawList();
 	if (!m_needsRedraw) {
 		memcpy(draw, m_cachedDrawList, sizeof(ImDrawList));
@@ -4666,6 +4643,15 @@ void BoardView::DrawBoard() {
 	// Splitting channels, drawing onto those and merging back.
 	draw->ChannelsSplit(NUM_DRAW_CHANNELS);
 
+	// With a retained layer or tiles, the Draw* functions only add what differs from them
+	bool tiled     = !m_boardLayer && m_tiles && !backgroundImage.shown() && m_tiles->canRender();
+	m_drawRetained = m_boardLayer != nullptr || tiled;
+	m_tilesPending = false;
+
+	// Labels measured for other settings or another font are measured again
+	m_labels.update(ImGui::GetIO().Fonts->Fonts[0], ShownPinValue(showMode), inferValue, showPartType);
+	m_labelGrid.clear();
+
 	// We draw the Parts before the Pins so that we can ascertain the needed pin
 	// size for the parts based on the part/pad geometry and spacing. -Inflex
 	// OutlineGenerateFill();
@@ -4676,12 +4662,16 @@ void BoardView::DrawBoard() {
 	//	DrawSelectedPins(draw);
 	DrawPins(draw);
 	DrawVies(draw);
-	OutlineGenFillDraw(draw, boardFillSpacing, 1);
+	if (!tiled) OutlineGenFillDraw(draw, boardFillSpacing, 1);
 	DrawOutline(draw);
 	// DrawPinTooltips(draw);
 	DrawPartTooltips(draw);
 	DrawAnnotations(draw);
 
+	// After DrawParts() computed the part outlines they need
+	if (m_boardLayer) DrawBoardLayer(draw);
+	if (tiled) DrawBoardTiles(draw);
+
 	draw->ChannelsMerge();
 
 	// Copy the new draw list and cmd buffer:
@@ -4689,7 +4679,8 @@ void BoardView::DrawBoard() {
 	int cmds_size = draw->CmdBuffer.size() * sizeof(ImDrawCmd);
 	m_cachedDrawCommands.resize(cmds_size);
 	memcpy(m_cachedDrawCommands.Data, draw->CmdBuffer.Data, cmds_size);
-	m_needsRedraw = false;
+	m_needsRedraw = m_tilesPending; // until the tiles in view are all rendered
+	m_drawnSelection = SelectionGeneration();
 }
 /** end of drawing region **/
 
@@ -4723,47 +4714,15 @@ void BoardView::CenterView(void) {
 	m_needsRedraw = true;
 }
 
-void BoardView::LoadBoard(BRDFileBase *file) {
-	delete m_board;
-
-	// Check board outline (format) point count.
-	//		If we don't have an outline, generate one
-	//
-	if (file->outline_segments.size() < 3 && file->format.size() < 3) {
-		auto pins = file->pins;
-		int minx, maxx, miny, maxy;
-		int margin = 200; // #define or leave this be? Rather arbritary.
-
-		minx = miny = INT_MAX;
-		maxx = maxy = INT_MIN;
-
-		for (auto a : pins) {
-			if (a.pos.x > maxx) maxx = a.pos.x;
-			if (a.pos.y > maxy) maxy = a.pos.y;
-			if (a.pos.x < minx) minx = a.pos.x;
-			if (a.pos.y < miny) miny = a.pos.y;
-		}
-
-		maxx += margin;
-		maxy += margin;
-		minx -= margin;
-		miny -= margin;
-
-		file->format.push_back({minx, miny});
-		file->format.push_back({maxx, miny});
-		file->format.push_back({maxx, maxy});
-		file->format.push_back({minx, maxy});
-		file->format.push_back({minx, miny});
-	}
-
-	m_board = new BRDBoard(file);
+void BoardView::LoadBoard(Board *board) {
+	m_board = board;
 	searcher.setParts(m_board->Components());
 	searcher.setNets(m_board->Nets());
 
 	std::vector<std::string> netnames;
-	for (auto &n : m_board->Nets()) netnames.push_back(n->name);
+	for (auto &n : m_board->Nets()) netnames.emplace_back(n->name);
 	std::vector<std::string> partnames;
-	for (auto &p : m_board->Components()) netnames.push_back(p->name);
+	for (auto &p : m_board->Components()) netnames.emplace_back(p->name);
 
 	scnets.setDictionary(netnames);
 	scparts.setDictionary(partnames);
@@ -4804,14 +4763,28 @@ void BoardView::LoadBoard(BRDFileBase *file) {
 	m_boardHeight           = max_y - min_y;
 	SetTarget(m_mx, m_my);
 
-	m_pinHighlighted.reserve(m_board->Components().size());
-	m_partHighlighted.reserve(m_board->Components().size());
-	m_pinSelected = nullptr;
+	m_pinHighlighted.reset(m_board->Pins().size());
+	m_partHighlighted.reset(m_board->Components().size());
+	m_partSelected.reset(m_board->Components().size());
 
 	m_firstFrame  = true;
 	m_needsRedraw = true;
 
 	m_track_mode = !m_board->Tracks().empty();
+
+	m_index.build(*m_board);
+	m_lod.clear();
+	m_labels.reset(*m_board);
+	m_outlineEdges.build(*m_board);
+	m_ratsnest.clear();
+
+	if (!m_boardLayer && Renderers::current) m_boardLayer = Renderers::current->createRetainedLayer();
+	if (!m_boardLayer && !m_tiles && Renderers::current) m_tiles = std::make_unique<TileCache>(*Renderers::current);
+	if (m_tiles) {
+		m_tiles->clear();
+		m_tiles->setLimit(tileCacheSize);
+	}
+	m_boardLayerDirty = true;
 }
 
 ImVec2 BoardView::CoordToScreen(float x, float y, float w) {
@@ -4919,10 +4892,11 @@ void BoardView::Mirror(void) {
 		p->x = max.x - p->x;
 	}
 
-	for (auto &p : m_board->Pins()) {
-		//	auto p        = pin.get();
-		p->position.x = max.x - p->position.x;
-	}
+	m_board->Store().mirror_x(max.x);
+	m_index.pins_dirty = m_index.parts_dirty = true;
+	m_lod.invalidate_pins();
+	m_outlineEdges.build(*m_board);
+	m_boardLayerDirty = true;
 
 	for (auto &part : m_board->Components()) {
 
@@ -4952,18 +4926,40 @@ void BoardView::SetTarget(float x, float y) {
 	m_dy += coord.y - y;
 }
 
-inline bool BoardView::BoardElementIsVisible(const std::shared_ptr<BoardElement> be) {
-	if (!be) return true; // no element? => no board side info
-
-	if (be->board_side == m_current_side) return true;
+inline bool BoardView::SideIsVisible(EBoardSide side) {
+	if (side == m_current_side) return true;
 
 	if (m_track_mode) {
 		const auto sz = m_board->AllSide().size();
-		if (sz + 1 - be->board_side == m_current_side)
+		if (sz + 1 - side == m_current_side)
 			return true;
 	}
 
-	if (be->board_side == kBoardSideBoth) return true;
+	return side == kBoardSideBoth;
+}
+
+BoardIndex &BoardView::Index() {
+	m_index.update(*m_board);
+	return m_index;
+}
+
+void BoardView::VisibleBoardRect(ImVec2 &min, ImVec2 &max) {
+	const float margin = DPIF(50.0f);
+	const ImVec2 corners[] = {ScreenToCoord(-margin, -margin),
+	                          ScreenToCoord(m_board_surface.x + margin, -margin),
+	                          ScreenToCoord(-margin, m_board_surface.y + margin),
+	                          ScreenToCoord(m_board_surface.x + margin, m_board_surface.y + margin)};
+	min = max = corners[0];
+	for (auto &c : corners) {
+		min = ImVec2(std::min(min.x, c.x), std::min(min.y, c.y));
+		max = ImVec2(std::max(max.x, c.x), std::max(max.y, c.y));
+	}
+}
+
+inline bool BoardView::BoardElementIsVisible(const std::shared_ptr<BoardElement> be) {
+	if (!be) return true; // no element? => no board side info
+
+	if (SideIsVisible(be->board_side)) return true;
 
 	if (auto via = dynamic_pointer_cast<Via>(be); via != nullptr) {
 		auto minLayer = std::min(via->board_side, via->target_side);
@@ -4987,7 +4983,7 @@ inline bool BoardView::IsVisibleScreen(float x, float y, float radius, const ImG
 }
 
 bool BoardView::PartIsHighlighted(const std::shared_ptr<Component> component) {
-	bool highlighted = contains(component, m_partHighlighted);
+	bool highlighted = m_partHighlighted.contains(component);
 
 	// is any pin of this part selected?
 	if (m_pinSelected) highlighted |= m_pinSelected->component == component;
@@ -4995,6 +4991,21 @@ bool BoardView::PartIsHighlighted(const std::shared_ptr<Component> component) {
 	return highlighted;
 }
 
+bool BoardView::PinStandsOut(uint32_t pin) {
+	const auto &store = m_board->Store();
+	if (m_pinSelected && store.pin_net[pin] == m_pinSelected->net->index) return true;
+	if (m_pinHighlighted.contains(pin)) return true;
+
+	uint32_t c = store.pin_component[pin];
+	if (c == BoardStore::kNone) return false;
+	return m_partSelected.contains(c) || PartIsHighlighted(m_board->Components()[c]);
+}
+
+// Changes whenever the highlighted or selected pins and parts do
+uint32_t BoardView::SelectionGeneration() {
+	return m_pinHighlighted.generation() + m_partHighlighted.generation() + m_partSelected.generation();
+}
+
 bool BoardView::AnyItemVisible(void) {
 	bool any_visible = false;
 
@@ -5021,7 +5032,7 @@ void BoardView::FindNetNoClear(const char *name) {
 	auto results = searcher.nets(name);
 
 	for (auto &net : results) {
-		for (auto &pin : net->pins) m_pinHighlighted.push_back(pin);
+		for (auto &pin : net->pins) m_pinHighlighted.insert(pin);
 	}
 }
 
@@ -5036,10 +5047,10 @@ void BoardView::FindComponentNoClear(const char *name) {
 	auto results = searcher.parts(name);
 
 	for (auto &p : results) {
-		m_partHighlighted.push_back(p);
+		m_partHighlighted.insert(p);
 
 		for (auto &pin : p->pins) {
-			m_pinHighlighted.push_back(pin);
+			m_pinHighlighted.insert(pin);
 		}
 	}
 	m_needsRedraw = true;
@@ -5131,24 +5142,3 @@ void BoardView::HandlePDFBridgeSelection() {
 		}
 	};
 }
-
-BitVec::~BitVec() {
-	free(m_bits);
-}
-
-void BitVec::Resize(uint32_t new_size) {
-	if (new_size > m_size) {
-		uint32_t bytelen     = 4 * ((m_size + 31) / 32);
-		uint32_t new_bytelen = 4 * ((new_size + 31) / 32);
-		uint32_t *new_bits   = (uint32_t *)malloc(new_bytelen);
-		if (m_bits) {
-			memcpy(new_bits, m_bits, bytelen);
-			free(m_bits);
-			memset((char *)new_bits + bytelen, 0, new_bytelen - bytelen);
-		} else {
-			memset(new_bits, 0, new_bytelen);
-		}
-		m_bits = new_bits;
-	}
-	m_size = new_size;
-}
@@ -1,7 +1,17 @@
 #pragma once
 
 #include "Board.h"
+#include "BoardLoader.h"
+#include "BoardSelection.h"
+#include "LabelCache.h"
+#include "LevelOfDetail.h"
+#include "OutlineEdges.h"
+#include "PartOutline.h"
+#include "Ratsnest.h"
+#include "Renderers/RetainedLayer.h"
+#include "Renderers/TileCache.h"
 #include "Searcher.h"
+#include "SpatialIndex.h"
 #include "SpellCorrector.h"
 #include "annotations.h"
 #include "confparse.h"
@@ -25,35 +35,6 @@
 struct BRDPart;
 class BRDFile;
 
-struct BitVec {
-	uint32_t *m_bits;
-	// length of the BitVec in bits
-	uint32_t m_size;
-
-	~BitVec();
-	void Resize(uint32_t new_size);
-
-	bool operator[](uint32_t index) {
-		return 0 != (m_bits[index >> 5] & (1u << (index & 0x1f)));
-	}
-
-	void Set(uint32_t index, bool val) {
-		uint32_t &slot = m_bits[index >> 5];
-		uint32_t bit   = (1u << (index & 0x1f));
-		slot &= ~bit;
-		if (val) {
-			slot |= bit;
-		}
-	}
-
-	void Clear() {
-		uint32_t num_ints = m_size >> 5;
-		for (uint32_t i = 0; i < num_ints; i++) {
-			m_bits[i] = 0;
-		}
-	}
-};
-
 struct ColorScheme {
 	/*
 	 * Take note, because these are directly set
@@ -142,6 +123,21 @@ enum FlipModes { flipModeVP = 0, flipModeMP = 1, NUM_FLIP_MODES };
 struct BoardView {
 	BRDFileBase *m_file;
 	Board *m_board;
+	BoardIndex m_index; // use Index(), grids go stale until it rebuilds them
+	BoardLod m_lod;     // zoomed out stand-ins for pins and tracks
+	LabelCache m_labels;         // pin, via and part label text, measured
+	LabelGrid m_labelGrid;       // pin labels drawn this frame
+	OutlineEdges m_outlineEdges; // board outline edge table, for the fill scan lines
+	Ratsnest m_ratsnest;         // net webs, per net
+	std::unique_ptr<RetainedLayer> m_boardLayer; // static board geometry on the GPU, if the renderer can keep it
+	size_t m_boardLayerKey   = 0;                // view settings the layer was built for
+	bool m_boardLayerDirty   = true;             // board geometry changed since the layer or tiles were built
+	std::unique_ptr<TileCache> m_tiles;          // rendered board tiles, without a retained layer
+	size_t m_tilesGeneration = 0;                // board geometry changes the tiles were rendered after
+	bool m_tilesPending      = false;            // visible tiles left to render in the next frames
+	bool m_tilesPinSelected  = false;            // a pin was selected when the tiles were last drawn
+	bool m_drawRetained      = false;            // Draw*() leave out what the layer or the tiles draw
+	BoardLoader boardLoader;
 	BackgroundImage backgroundImage{m_current_side};
 
 	Confparse obvconfig;
@@ -180,6 +176,7 @@ struct BoardView {
 
 	int pinA1threshold = 3; // pincount of package to show 1/A1 pin
 	int netWebThickness = 2;
+	bool netWebStar     = false; // lines from the selected pin instead of the net's ratsnest
 
 	float pinSizeThresholdLow = 0.0f;
 	bool pinShapeSquare       = false;
@@ -199,7 +196,7 @@ struct BoardView {
 	bool showPartName         = true;
 	bool showPinName          = true;
 	int boardFillSpacing      = 3;
-	bool boardMinMaxDone      = false;
+	int tileCacheSize         = 64; // MB of board tiles
 
 	bool showPosition  = true;
 	bool reloadConfig  = false;
@@ -211,6 +208,7 @@ struct BoardView {
 	ShowMode showMode = ShowMode::ShowMode_Diode;
 	bool inferValue = true;
 	bool showPartType = true;
+	bool hideOverlappingLabels = false; // of pin names not shown for a highlight
 
 
 	int ConfigParse(void);
@@ -246,7 +244,6 @@ struct BoardView {
 
 	bool m_centerZoomSearchResults = true;
 	void CenterZoomSearchResults(void);
-	int EPCCheck(void);
 	void OutlineGenFillDraw(ImDrawList *draw, int ydelta, double thickness);
 
 	/* Context menu, sql stuff */
@@ -276,8 +273,10 @@ struct BoardView {
 	std::shared_ptr<Pin> m_pinSelected = nullptr;
 	std::shared_ptr<Via> m_viaSelected = nullptr;
 	//	vector<Net *> m_netHiglighted;
-	SharedVector<Pin> m_pinHighlighted;
-	SharedVector<Component> m_partHighlighted;
+	ElementSet<Pin> m_pinHighlighted;        // e.g. a net search
+	ElementSet<Component> m_partHighlighted; // e.g. a part search, or parts picked on the board
+	ElementSet<Component> m_partSelected;    // parts picked on the board, drawn with their pins
+	uint32_t m_drawnSelection = 0;           // SelectionGeneration() the board was drawn with
 	char m_cachedDrawList[sizeof(ImDrawList)];
 	ImVector<char> m_cachedDrawCommands;
 	SharedVector<Net> m_nets;
@@ -310,7 +309,7 @@ struct BoardView {
 	// TODO: save settings to disk
 	// pinDiameter: diameter for all pins.  Unit scale: 1 = 0.025mm, boards are
 	// done in "thou" (1/1000" = 0.0254mm)
-	int m_pinDiameter     = 20;
+	int m_pinDiameter     = kDefaultPinDiameter;
 	bool m_flipVertically = true;
 
 	// Annotation layer specific
@@ -359,9 +358,18 @@ struct BoardView {
 	void DrawTracks(ImDrawList *draw);
 	void DrawArcs(ImDrawList *draw);
 	void DrawBoard();
+	float PinSizeThreshold();
+	bool LayerMasked();
+	size_t BoardLayerKey();
+	void BuildBoardLayer(ImDrawList *draw, float pixel, const SpatialGrid::Box *region = nullptr);
+	void BuildBoardFill(ImDrawList *draw, float pixel, const SpatialGrid::Box &region);
+	void DrawBoardLayer(ImDrawList *draw);
+	void DrawBoardTiles(ImDrawList *draw);
 	void DrawNetWeb(ImDrawList *draw);
-	void LoadBoard(BRDFileBase *file);
+	void LoadBoard(Board *board);
 	int LoadFile(const filesystem::path &filepath);
+	void UpdateBoardLoader();
+	void ShowLoadingProgress();
 	ImVec2 CoordToScreen(float x, float y, float w = 1.0f);
 	ImVec2 ScreenToCoord(float x, float y, float w = 1.0f);
 	// void Move(float x, float y);
@@ -376,6 +384,12 @@ struct BoardView {
 	// Returns true if the part is shown on the currently displayed side of the
 	// board.
 	bool BoardElementIsVisible(const std::shared_ptr<BoardElement> be);
+	// Same for an element on the given side, without its object (see BoardStore)
+	bool SideIsVisible(EBoardSide side);
+	// The spatial index of the board, up to date
+	BoardIndex &Index();
+	// Board coordinates bounding the board surface, with a margin for labels and outlines drawn past elements
+	void VisibleBoardRect(ImVec2 &min, ImVec2 &max);
 	bool IsVisibleScreen(float x, float y, float radius, const ImGuiIO &io);
 	// Returns true if the circle described by screen coordinates x, y, and radius
 	// is visible in the
@@ -383,6 +397,9 @@ struct BoardView {
 	// bool IsVisibleScreen(float x, float y, float radius = 0.0f);
 
 	bool PartIsHighlighted(const std::shared_ptr<Component> component);
+	uint32_t SelectionGeneration();
+	// True if pin (index in Board::Pins()) is drawn unlike its default because of highlights or the selection
+	bool PinStandsOut(uint32_t pin);
 	void FindNet(const char *net);
 	void FindNetNoClear(const char *name);
 	void FindComponent(const char *name);
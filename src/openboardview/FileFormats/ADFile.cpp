@@ -3,7 +3,6 @@
 #include <algorithm>
 #include <cmath>
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 #include <cstring>
 #include <vector>
@@ -20,10 +19,7 @@
 #define ADFILE_BLOCK_TRACKS 5
 #define ADFILE_BLOCK_ARC 6
 
-char *arena;
-char *arena_end;
-
-char *read_item(char *p) {
+char *read_item(char *p, Utf8Arena &arena) {
 	char *s;
 	char *r;
 
@@ -33,40 +29,27 @@ char *read_item(char *p) {
 	*p = 0;
 	r  = strdup(s);
 	*p = '|';
-	return fix_to_utf8(r, &arena, arena_end);
+	return fix_to_utf8(r, arena);
 }
 
-bool ADFile::verifyFormat(std::vector<char> &buf) {
+bool ADFile::verifyFormat(const ParseBuffer &buf) {
 	bool isBinary  = find_str_in_buf("Binary", buf);
 	bool versionOK = find_str_in_buf("|KIND=Protel_Advanced_PCB", buf);
 	return versionOK && !isBinary;
 }
 
-ADFile::ADFile(std::vector<char> &buf) {
+ADFile::ADFile(ParseBuffer &buf) {
 	auto buffer_size = buf.size();
 
-	char *saved_locale;
-	saved_locale = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
-
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	arena     = &file_buf[buffer_size + 1];
-	arena_end = file_buf + file_buf_size - 1;
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	*arena_end            = 0;
+	file_buf = adopt_buffer(buf);
 
 	int current_block = 0;
 	int net_count     = 0;
 
-	std::vector<char *> lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(file_buf, buffer_size);
 
-	std::vector<char *>::iterator line_it = lines.begin();
+	LineSplitter::iterator line_it = lines.begin();
 	while (line_it != lines.end()) {
 		char *line = *line_it;
 		char *p;
@@ -105,7 +88,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				if (!p)
 					continue;
 				p += 7;
-				layer = read_item(p);
+				layer = read_item(p, arena);
 
 				if (!layer)
 					continue;
@@ -165,7 +148,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				p = strstr(line, "|LAYER=");
 				if (p) {
 					p += 7;
-					layer = read_item(p);
+					layer = read_item(p, arena);
 				}
 
 				p = strstr(line, "|COMPONENT=");
@@ -261,7 +244,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				net_count++;
 				p = strstr(p, "|NAME=");
 				if (p) p += 6;
-				net.name = read_item(p);
+				net.name = read_item(p, arena);
 				ad_nets.push_back(net);
 				current_block = ADFILE_BLOCK_NONE;
 
@@ -281,7 +264,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				part.part_id++;
 				p = strstr(p, "|LAYER=");
 				if (p) p += 7;
-				part.layer = read_item(p);
+				part.layer = read_item(p, arena);
 				p          = strstr(p, "|X=");
 				if (p) p += 3;
 				part.x = READ_DOUBLE();
@@ -294,7 +277,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				p                = strstr(p, "|SOURCEDESIGNATOR=");
 				if (p) {
 					p += 18;
-					part.name = read_item(p);
+					part.name = read_item(p, arena);
 				} else {
 					char tn[1024];
 					snprintf(tn, sizeof(tn), "UNKNOWN-%d", part.part_id);
@@ -304,7 +287,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				if (p) {
 					char *t;
 					p += 19;
-					t                = read_item(p);
+					t                = read_item(p, arena);
 					part.description = t;
 				}
 
@@ -329,7 +312,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 				p = strstr(line, "|NAME=");
 				if (p) {
 					p += 6;
-					pad.snum = read_item(p);
+					pad.snum = read_item(p, arena);
 					*p       = '|';
 				}
 
@@ -368,7 +351,7 @@ ADFile::ADFile(std::vector<char> &buf) {
 					p += sizeof("|ROTATION=") - 1;
 					q            = strchr(p, '|');
 					*q           = '\0';
-					pad.rotation = strtod(p, &p);
+					pad.rotation = parse_double(p, &p);
 					*q           = '|';
 				}
 
@@ -393,14 +376,14 @@ ADFile::ADFile(std::vector<char> &buf) {
 				p = strstr(line, "|UNIQUEID=");
 				if (p) {
 					p += sizeof("|UNIQUEID=") - 1;
-					pad.unique_id = read_item(p);
+					pad.unique_id = read_item(p, arena);
 					*p            = '|';
 				}
 
 				p = strstr(line, "|LAYER=");
 				if (p) {
 					p += sizeof("|LAYER=") - 1;
-					pad.layer = read_item(p);
+					pad.layer = read_item(p, arena);
 					if (strcmp(pad.layer, "MULTILAYER") == 0) {
 						pad.type = 1;
 					}
@@ -489,7 +472,5 @@ ADFile::ADFile(std::vector<char> &buf) {
 	num_format = format.size();
 	num_nails  = nails.size();
 
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
-
 	valid = 1;
 }
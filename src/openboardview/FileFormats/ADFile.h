@@ -34,12 +34,12 @@ struct AD_BRDPad {
 };
 
 struct ADFile : public BRDFileBase {
-	ADFile(std::vector<char> &buf);
+	ADFile(ParseBuffer &buf);
 
 	struct {
 		bool operator()(BRDPin a, BRDPin b) const {
 			char *pEnd;
-			return strtod(a.snum, &pEnd) < strtod(b.snum, &pEnd);
+			return parse_double(a.snum, &pEnd) < parse_double(b.snum, &pEnd);
 		}
 	} customLess;
 
@@ -47,6 +47,6 @@ struct ADFile : public BRDFileBase {
 	std::vector<AD_BRDPart> ad_parts;
 	std::vector<AD_BRDPad> ad_pads;
 
-	static bool verifyFormat(std::vector<char> &buf);
+	static bool verifyFormat(const ParseBuffer &buf);
 	void outline_order_segments(std::vector<BRDPoint> &format);
 };
@@ -3,15 +3,14 @@
 #include "utils.h"
 #include <cstring>
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 
-/*bool ASCFile::verifyFormat(std::vector<char> &buf) {
+/*bool ASCFile::verifyFormat(const ParseBuffer &buf) {
     return find_str_in_buf("dd:1.3?,r?-=bb", buf) || ( find_str_in_buf("<<format.asc>>", buf) && find_str_in_buf("<<pins.asc>>",
 buf) );
 }*/
 
-void ASCFile::parse_format(char *&p, char *&s, char *&arena, char *&arena_end, line_iterator_t &line_it) {
+void ASCFile::parse_format(char *&p, char *&s, line_iterator_t &line_it) {
 	if (m_firstformat) {
 		line_it += 7; // Skip 7+1 unused lines before 1st point. Might not work with all files.
 		m_firstformat = false;
@@ -26,7 +25,7 @@ void ASCFile::parse_format(char *&p, char *&s, char *&arena, char *&arena_end, l
 	format.push_back(point);
 }
 
-void ASCFile::parse_pin(char *&p, char *&s, char *&arena, char *&arena_end, line_iterator_t &line_it) {
+void ASCFile::parse_pin(char *&p, char *&s, line_iterator_t &line_it) {
 	if (m_firstpin) {
 		line_it += 7; // Skip 7+1 unused lines before 1st part
 		m_firstpin = false;
@@ -68,7 +67,7 @@ void ASCFile::parse_pin(char *&p, char *&s, char *&arena, char *&arena_end, line
 	}
 }
 
-void ASCFile::parse_nail(char *&p, char *&s, char *&arena, char *&arena_end, line_iterator_t &line_it) {
+void ASCFile::parse_nail(char *&p, char *&s, line_iterator_t &line_it) {
 	if (m_firstnail) {
 		line_it += 6; // Skip 6+1 unused lines before 1st nail
 		m_firstnail = false;
@@ -99,27 +98,18 @@ void ASCFile::parse_nail(char *&p, char *&s, char *&arena, char *&arena_end, lin
  * pins.asc, parts.asc (not supported), nets.asc (not supported), nails.asc, format.asc
  * *.bom files not supported either
  */
-bool ASCFile::read_asc(const filesystem::path &filepath, void (ASCFile::*parser)(char *&, char *&, char *&, char *&, line_iterator_t&)) {
+bool ASCFile::read_asc(const filesystem::path &filepath, void (ASCFile::*parser)(char *&, char *&, line_iterator_t&)) {
 	if (filepath.empty()) return false;
-	std::vector<char> buf = file_as_buffer(filepath, error_msg);
-	if (buf.empty()) return false;
+	ParseBuffer buf;
+	if (!buf.open(filepath, error_msg)) return false;
 
-	ENSURE_OR_FAIL(buf.size() > 4, error_msg, return false);
-	size_t file_buf_size = 3 * (1 + buf.size());
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return false);
+	auto buffer_size = buf.size();
+	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return false);
+	file_buf = adopt_buffer(buf);
 
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buf.size()] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buf.size() + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	LineSplitter lines(file_buf, buffer_size);
 
-	std::vector<char *> lines;
-	stringfile(file_buf, lines);
-
-	std::vector<char *>::iterator line_it = lines.begin();
+	LineSplitter::iterator line_it = lines.begin();
 	while (line_it != lines.end()) {
 		char *line = *line_it;
 		++line_it;
@@ -130,7 +120,7 @@ bool ASCFile::read_asc(const filesystem::path &filepath, void (ASCFile::*parser)
 		char *p = line;
 		char *s = nullptr;
 
-		(this->*parser)(p, s, arena, arena_end, line_it);
+		(this->*parser)(p, s, line_it);
 	}
 	return true;
 }
@@ -145,7 +135,7 @@ void ASCFile::update_counts() {
 	num_nails  = nails.size();
 }
 
-bool ASCFile::load_and_parse(const filesystem::path &path, const std::string &filename, void (ASCFile::*parser)(char *&, char *&, char *&, char *&, line_iterator_t&)) {
+bool ASCFile::load_and_parse(const filesystem::path &path, const std::string &filename, void (ASCFile::*parser)(char *&, char *&, line_iterator_t&)) {
 	auto filepath = lookup_file_insensitive(path, filename, error_msg);
 	if (filepath.empty() || !error_msg.empty()) {
 		return false;
@@ -153,11 +143,26 @@ bool ASCFile::load_and_parse(const filesystem::path &path, const std::string &fi
 	return read_asc(filepath, parser);
 }
 
+std::vector<filesystem::path> ASCFile::input_files(const filesystem::path &filepath) {
+	std::vector<filesystem::path> files;
+	std::error_code ec;
+	auto directory = filesystem::weakly_canonical(filepath, ec);
+	if (ec) return files;
+	directory = directory.parent_path();
+
+	for (auto filename : {"format.asc", "pins.asc", "nails.asc"}) {
+		std::string error_msg;
+		auto path = lookup_file_insensitive(directory, filename, error_msg);
+		if (!path.empty()) files.push_back(path);
+	}
+	return files;
+}
+
 /*
  * buf unused for now, read all files even if one of the supported *.asc was
  * passed
  */
-ASCFile::ASCFile(std::vector<char> &buf, const filesystem::path &filepath) {
+ASCFile::ASCFile(ParseBuffer &buf, const filesystem::path &filepath) {
 	std::error_code ec;
 	auto directory = filesystem::weakly_canonical(filepath, ec);
 	if (ec) {
@@ -166,8 +171,6 @@ ASCFile::ASCFile(std::vector<char> &buf, const filesystem::path &filepath) {
 	}
 	directory = directory.parent_path();
 
-	char *saved_locale = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
-
 	if (!load_and_parse(directory, "format.asc", &ASCFile::parse_format)
 		|| !load_and_parse(directory, "pins.asc", &ASCFile::parse_pin)
 		|| !load_and_parse(directory, "nails.asc", &ASCFile::parse_nail)) {
@@ -177,5 +180,4 @@ ASCFile::ASCFile(std::vector<char> &buf, const filesystem::path &filepath) {
 	}
 
 	update_counts();
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
 }
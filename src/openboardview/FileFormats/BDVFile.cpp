@@ -2,7 +2,6 @@
 
 #include "utils.h"
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 #include <cstring>
 
@@ -17,37 +16,24 @@ void decode_bdv(char *buf, size_t buffer_size) {
 	}
 }
 
-bool BDVFile::verifyFormat(std::vector<char> &buf) {
+bool BDVFile::verifyFormat(const ParseBuffer &buf) {
 	return find_str_in_buf("dd:1.3?,r?-=bb", buf) ||
 	       (find_str_in_buf("<<format.asc>>", buf) && find_str_in_buf("<<pins.asc>>", buf));
 }
 
-BDVFile::BDVFile(std::vector<char> &buf) {
+BDVFile::BDVFile(ParseBuffer &buf) {
 	auto buffer_size = buf.size();
 
-	char *saved_locale;
-	saved_locale = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
-
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	file_buf = adopt_buffer(buf);
 
 	decode_bdv(file_buf, buffer_size);
 
 	int current_block = 0;
 
-	std::vector<char *> lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(file_buf, buffer_size);
 
-	std::vector<char *>::iterator line_it = lines.begin();
+	LineSplitter::iterator line_it = lines.begin();
 	while (line_it != lines.end()) {
 		char *line = *line_it;
 		++line_it;
@@ -148,7 +134,5 @@ BDVFile::BDVFile(std::vector<char> &buf) {
 	num_format = format.size();
 	num_nails  = nails.size();
 
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
-
 	valid = current_block != 0;
 }
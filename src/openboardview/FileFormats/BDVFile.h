@@ -3,7 +3,7 @@
 #include "BRDFileBase.h"
 
 struct BDVFile : public BRDFileBase {
-	BDVFile(std::vector<char> &buf);
+	BDVFile(ParseBuffer &buf);
 
-	static bool verifyFormat(std::vector<char> &buf);
+	static bool verifyFormat(const ParseBuffer &buf);
 };
@@ -7,32 +7,22 @@
 #include <cstring>
 #include <unordered_map>
 
-bool BRD2File::verifyFormat(std::vector<char> &buf) {
+bool BRD2File::verifyFormat(const ParseBuffer &buf) {
 	return find_str_in_buf("BRDOUT:", buf) && find_str_in_buf("NETS:", buf);
 }
 
-BRD2File::BRD2File(std::vector<char> &buf) {
+BRD2File::BRD2File(ParseBuffer &buf) {
 	auto buffer_size = buf.size();
 	std::unordered_map<int, char *> nets; // Map between net id and net name
 	unsigned int num_nets = 0;
 	BRDPoint max{0, 0}; // Top-right board boundary
 
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	file_buf = adopt_buffer(buf);
 
 	int current_block = 0;
 
-	std::vector<char *>  lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(file_buf, buffer_size);
 
 	for (char *line : lines) {
 		while (isspace((uint8_t)*line)) line++;
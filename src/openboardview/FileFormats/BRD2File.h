@@ -2,7 +2,7 @@
 
 #include "BRDFileBase.h"
 struct BRD2File : public BRDFileBase {
-	BRD2File(std::vector<char> &buf);
+	BRD2File(ParseBuffer &buf);
 
-	static bool verifyFormat(std::vector<char> &buf);
+	static bool verifyFormat(const ParseBuffer &buf);
 };
@@ -14,7 +14,7 @@ decltype(BRDFile::signature) constexpr BRDFile::signature;
  * Returns true if the file format seems to be BRD.
  * Uses std::string::find() on a std::string rather than strstr() on the buffer because the latter expects a null-terminated string.
  */
-bool BRDFile::verifyFormat(std::vector<char> &buf) {
+bool BRDFile::verifyFormat(const ParseBuffer &buf) {
 	if (buf.size() < signature.size()) return false; // C++14 implements a safer std::equal where this is not needed
 	if (std::equal(signature.begin(), signature.end(), buf.begin(), [](const uint8_t &i, const char &j) {
 		    return i == reinterpret_cast<const uint8_t &>(j);
@@ -23,19 +23,10 @@ bool BRDFile::verifyFormat(std::vector<char> &buf) {
 	return find_str_in_buf("str_length:", buf) && find_str_in_buf("var_data:", buf);
 }
 
-BRDFile::BRDFile(std::vector<char> &buf) {
+BRDFile::BRDFile(ParseBuffer &buf) {
 	auto buffer_size = buf.size();
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	file_buf = adopt_buffer(buf);
 
 	// decode the file if it appears to be encoded:
 	static const uint8_t encoded_header[] = {0x23, 0xe2, 0x63, 0x28};
@@ -51,8 +42,7 @@ BRDFile::BRDFile(std::vector<char> &buf) {
 	}
 
 	int current_block = 0;
-	std::vector<char*> lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(file_buf, buffer_size);
 
 	for (char *line : lines) {
 		while (isspace((uint8_t)*line)) line++;
@@ -96,8 +86,8 @@ BRDFile::BRDFile(std::vector<char> &buf) {
 			case 3: { // Format
 				ENSURE(format.size() < num_format, error_msg);
 				BRDPoint fmt;
-				fmt.x = strtol(p, &p, 10);
-				fmt.y = strtol(p, &p, 10);
+				fmt.x = parse_long(p, &p);
+				fmt.y = parse_long(p, &p);
 				format.push_back(fmt);
 			} break;
 			case 4: { // Parts
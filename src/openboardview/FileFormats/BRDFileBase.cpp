@@ -1,77 +1,239 @@
+#include "platform.h" // Should be kept first
 #include "BRDFileBase.h"
 
+#include "parallel.h"
+#include "utils.h"
 #include "utf8/utf8.h"
+#include <algorithm>
+#include <cerrno>
 #include <cstdint>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 double BRDFileBase::arc_slice_angle_rad = 0.1;
 
-// from stb.h
-void stringfile(char *buffer, std::vector<char*> &lines) {
-	char *s;
-	size_t count, i;
-
-	// two passes through: first time count lines, second time set them
-	for (i = 0; i < 2; ++i) {
-		s                   = buffer;
-		if (i == 1) lines[0] = s;
-		count               = 1; // was '1',  but C arrays are 0-indexed
-		while (*s) {
-			if (*s == '\n' || *s == '\r') {
-
-				// If this is the 2nd pass, then terminate the line at the first line break char
-				if (i == 1) *s = 0;
-
-				s++; // next char
-
-				// if the termination is a CRLF combo, then jump to the next char
-				if ((*s == '\r') || (*s == '\n')) s++;
-
-				// if the char is valid (first after line break), set up the next item in the line array
-				if (*s) { // it's not over yet
-					if (i == 1) {
-						lines[count] = s;
-						//					  list[count+1] = NULL;
-						// fprintf(stdout,"%s\n",list[count]);
-					}
-					++count;
-				}
+namespace {
+
+inline bool is_break(char c) {
+	return c == '\r' || c == '\n' || c == 0;
+}
+
+inline unsigned lowest_bit(uint64_t mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+// Bit i is set when p[i] is a line break, for the 64 bytes at p
+inline uint64_t break_mask(const char *p) {
+	uint64_t mask = 0;
+#if defined(__AVX2__)
+	const __m256i cr = _mm256_set1_epi8('\r'), lf = _mm256_set1_epi8('\n'), nul = _mm256_setzero_si256();
+	for (int i = 0; i < 64; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+		__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)), _mm256_cmpeq_epi8(v, nul));
+		mask |= uint64_t(uint32_t(_mm256_movemask_epi8(m))) << i;
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	const __m128i cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n'), nul = _mm_setzero_si128();
+	for (int i = 0; i < 64; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)), _mm_cmpeq_epi8(v, nul));
+		mask |= uint64_t(uint16_t(_mm_movemask_epi8(m))) << i;
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+	const uint8x16_t bits = vld1q_u8(weights);
+	for (int i = 0; i < 64; i += 16) {
+		uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p + i));
+		uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')), vceqq_u8(v, vdupq_n_u8('\n'))), vceqzq_u8(v));
+		m            = vandq_u8(m, bits);
+		uint64_t lo  = vaddv_u8(vget_low_u8(m));
+		uint64_t hi  = vaddv_u8(vget_high_u8(m));
+		mask |= (lo | hi << 8) << i;
+	}
+#else
+	for (int i = 0; i < 64; i++)
+		if (is_break(p[i])) mask |= uint64_t(1) << i;
+#endif
+	return mask;
+}
+
+} // namespace
+
+LineSplitter::LineSplitter(char *buffer, size_t size) : buffer(buffer), size(size), pending(buffer), cancel(load_cancel_flag()) {}
+
+// Position of the first break at or after from, size if there is none
+size_t LineSplitter::find_break(size_t from) {
+	while (from < size) {
+		size_t base = from & ~size_t(63);
+		if (base != mask_base) {
+			mask_base = base;
+			if (base + 64 <= size) {
+				mask = break_mask(buffer + base);
+			} else {
+				mask = 0;
+				for (size_t i = base; i < size; i++)
+					if (is_break(buffer[i])) mask |= uint64_t(1) << (i - base);
 			}
-			s++;
-		} // while s
+		}
+		uint64_t m = mask & (~uint64_t(0) << (from - base));
+		if (m) return base + lowest_bit(m);
+		from = base + 64;
+	}
+	return size;
+}
 
-		// Generate the required array to hold all the line starting points
-		if (i == 0) {
-			lines.resize(count);
+char *LineSplitter::next() {
+	char *line = pending;
+	if (!line) return nullptr;
+	if (cancel && cancel->load(std::memory_order_relaxed)) {
+		pending = nullptr;
+		return nullptr;
+	}
+
+	// As stringfile() did, a NUL ends the text, except right after a line break: then it is skipped
+	// with the text following it up to the next break
+	size_t i = find_break(check_from);
+	pending  = nullptr;
+	while (i < size && buffer[i] != 0) {
+		buffer[i] = 0;
+
+		size_t j = i + 1;
+		if (j < size && (buffer[j] == '\r' || buffer[j] == '\n')) j++;
+		if (j >= size) break;
+		if (buffer[j] != 0) {
+			pending = buffer + j;
+			// As stb's stringfile() did, the first character of a line is never taken as its end
+			check_from = j + 1;
+			break;
 		}
+		i = j + 1 < size ? find_break(j + 1) : size;
 	}
+	return line;
 }
 
-char *fix_to_utf8(char *s, char **arena, char *arena_end) {
+char *fix_to_utf8(char *s, Utf8Arena &arena) {
 	if (!utf8valid(s)) {
 		return s;
 	}
-	char *p     = *arena;
+	// Latin-1 fallback: every byte >= 0x80 becomes 2 bytes
+	size_t size = 1;
+	for (const char *c = s; *c; ++c) size += ((uint8_t)*c < 0x80) ? 1 : 2;
+
+	char *p     = arena.alloc(size);
 	char *begin = p;
 	while (*s) {
 		uint32_t c = (uint8_t)*s;
 		if (c < 0x80) {
-			if (p + 1 >= arena_end) goto done;
 			*p++ = c;
 		} else {
-			if (p + 2 >= arena_end) goto done;
 			*p++ = 0xc0 | (c >> 6);
 			*p++ = 0x80 | (c & 0x3f);
 		}
 		++s;
 	}
-	if (p + 1 >= arena_end) goto done;
-	*p++ = 0;
-done:
-	*arena = p;
+	*p = 0;
 	return begin;
 }
 
+void BRDFileBase::release_elements() {
+	// swap with empty vectors, clear() keeps the capacity
+	std::vector<BRDPoint>().swap(format);
+	std::vector<std::pair<BRDPoint, BRDPoint>>().swap(outline_segments);
+	std::vector<BRDPart>().swap(parts);
+	std::vector<BRDPin>().swap(pins);
+	std::vector<BRDNail>().swap(nails);
+	std::vector<BRDTrack>().swap(tracks);
+	std::vector<BRDVia>().swap(vias);
+	std::vector<BRDArc>().swap(arcs);
+
+	file_buf = nullptr;
+	std::vector<ParseBuffer>().swap(buffers);
+	arena = Utf8Arena();
+}
+
+char *Utf8Arena::alloc(size_t size) {
+	static constexpr size_t block_size = 64 * 1024;
+
+	if (static_cast<size_t>(end - pos) < size) {
+		size_t n = std::max(block_size, size);
+		blocks.emplace_back(new char[n]);
+		pos = blocks.back().get();
+		end = pos + n;
+	}
+	char *p = pos;
+	pos += size;
+	return p;
+}
+
+void Utf8Arena::merge(Utf8Arena &&other) {
+	// Keeps allocating from our current block, the rest of other's is left unused
+	for (auto &block : other.blocks) blocks.push_back(std::move(block));
+	other.blocks.clear();
+	other.pos = other.end = nullptr;
+}
+
+ParseBuffer::ParseBuffer(std::vector<char> &&buf) : heap(std::move(buf)) {
+	if (!heap.empty()) heap.resize(heap.size() + kPadding, 0);
+}
+
+bool ParseBuffer::open(const filesystem::path &filepath, std::string &error_msg) {
+	heap.clear();
+
+	std::error_code ec;
+	if (!filesystem::is_regular_file(filepath, ec)) {
+		error_msg = "Not a regular file";
+		return false;
+	}
+	size_t file_size = filesystem::file_size(filepath, ec);
+	if (ec) {
+		error_msg = ec.message();
+		return false;
+	}
+
+	ifstream file;
+	file.open(filepath, std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+		error_msg = strerror(errno);
+		return false;
+	}
+
+	// Zero filled, the padding included
+	std::vector<char> contents(file_size + kPadding);
+	file.read(contents.data(), file_size);
+	if (static_cast<size_t>(file.gcount()) != file_size) {
+		error_msg = "The file was shortened while it was read";
+		return false;
+	}
+	if (file_size > 0) heap = std::move(contents);
+	return true;
+}
+
+// Returns true if the given str was found in buf
+bool find_str_in_buf(const std::string str, const ParseBuffer &buf) {
+	return std::search(buf.begin(), buf.end(), str.begin(), str.end()) != buf.end();
+}
+
+char *BRDFileBase::adopt_buffer(ParseBuffer &buf) {
+	buffers.push_back(std::move(buf));
+	return buffers.back().data();
+}
+
 void BRDFileBase::AddNailsAsPins() {
 	for (auto &nail : nails) {
 		BRDPin pin;
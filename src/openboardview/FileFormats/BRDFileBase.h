@@ -1,18 +1,26 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 
-#define READ_INT() strtol(p, &p, 10);
+#include "NumberParser.h"
+#include "filesystem_impl.h"
+
+#define READ_INT() parse_long(p, &p);
 // Warning: read as int then cast to uint if positive
 #define READ_UINT                                \
 	[&]() {                                      \
-		int value = strtol(p, &p, 10);           \
+		int value = parse_long(p, &p);           \
 		ENSURE(value >= 0, error_msg);           \
 		return static_cast<unsigned int>(value); \
 	}
-#define READ_DOUBLE() strtod(p, &p)
+#define READ_DOUBLE() parse_double(p, &p)
 #define READ_STR                                     \
 	[&]() {                                          \
 		while ((*p) && (isspace((uint8_t)*p))) ++p;  \
@@ -20,7 +28,7 @@
 		while ((*p) && (!isspace((uint8_t)*p))) ++p; \
 		*p = 0;                                      \
 		p++;                                         \
-		return fix_to_utf8(s, &arena, arena_end);    \
+		return fix_to_utf8(s, arena);                \
 	}
 
 struct BRDPoint {
@@ -108,6 +116,131 @@ struct BRDArc {
 	const char *net = "UNCONNECTED";
 };
 
+/*
+ * Contents of a board file that loaders tokenize in place, always followed by kPadding zero bytes.
+ * The file is read into the buffer at once, with the padding allocated along with it.
+ */
+class ParseBuffer {
+  public:
+	static constexpr size_t kPadding = 64;
+
+	ParseBuffer() = default;
+	explicit ParseBuffer(std::vector<char> &&buf);
+	ParseBuffer(ParseBuffer &&other) noexcept = default;
+	ParseBuffer &operator=(ParseBuffer &&other) noexcept = default;
+	ParseBuffer(const ParseBuffer &) = delete;
+	ParseBuffer &operator=(const ParseBuffer &) = delete;
+
+	// Reads filepath. Returns false and sets error_msg on failure.
+	bool open(const filesystem::path &filepath, std::string &error_msg);
+
+	char *data() {
+		return heap.data();
+	}
+	const char *data() const {
+		return heap.data();
+	}
+	const char *begin() const {
+		return heap.data();
+	}
+	const char *end() const {
+		return heap.data() + size();
+	}
+	size_t size() const {
+		return heap.empty() ? 0 : heap.size() - kPadding;
+	}
+	bool empty() const {
+		return size() == 0;
+	}
+
+  private:
+	std::vector<char> heap; // the contents then kPadding zeros, empty when there are none
+};
+
+/*
+ * Storage for the strings fix_to_utf8() has to rewrite.
+ * Nothing is allocated until the first non UTF-8 string is found.
+ */
+class Utf8Arena {
+  public:
+	char *alloc(size_t size);
+	// Takes over the strings of other, they stay where they are
+	void merge(Utf8Arena &&other);
+
+  private:
+	std::vector<std::unique_ptr<char[]>> blocks;
+	char *pos = nullptr;
+	char *end = nullptr;
+};
+
+/*
+ * Cuts a buffer into NUL-terminated lines in place, one line at a time as the parser asks for it.
+ * A line break is '\r' or '\n'; a second '\r' or '\n' right after it belongs to the same break
+ * (CRLF). As for stringfile(), a NUL ends the text, unless right after a break: then it and the text
+ * up to the next break are skipped. Breaks are searched 64 bytes at a time with SSE2, AVX2 or NEON compares.
+ * Single pass: iterators share the splitter's position, begin() can only be called once.
+ * Made during a board load, there are no more lines once the load is cancelled (see load_cancelled()).
+ */
+class LineSplitter {
+  public:
+	class iterator {
+	  public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type        = char *;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = char **;
+		using reference         = char *;
+
+		iterator(LineSplitter *splitter, char *line) : splitter(splitter), line(line) {}
+
+		char *operator*() const {
+			return line;
+		}
+		iterator &operator++() {
+			line = splitter->next();
+			return *this;
+		}
+		// Skips n lines, stops at the end
+		iterator &operator+=(size_t n) {
+			while (n-- && line) line = splitter->next();
+			return *this;
+		}
+		bool operator==(const iterator &other) const {
+			return line == other.line;
+		}
+		bool operator!=(const iterator &other) const {
+			return line != other.line;
+		}
+
+	  private:
+		LineSplitter *splitter;
+		char *line;
+	};
+
+	LineSplitter(char *buffer, size_t size);
+
+	// Returns the next line, nullptr after the last one
+	char *next();
+
+	iterator begin() {
+		return iterator(this, next());
+	}
+	iterator end() {
+		return iterator(this, nullptr);
+	}
+
+  private:
+	size_t find_break(size_t from);
+
+	char *buffer;
+	size_t size;
+	char *pending;             // start of the next line to hand out, nullptr after the last one
+	size_t check_from = 0;     // first position that can hold the next break
+	size_t mask_base  = SIZE_MAX;
+	uint64_t mask     = 0;     // breaks in the 64 bytes from mask_base
+	const std::atomic<bool> *cancel;
+};
+
 class BRDFileBase {
   public:
 	unsigned int num_format = 0;
@@ -128,17 +261,22 @@ class BRDFileBase {
 	bool valid = false;
 	std::string error_msg = "";
 
-	virtual ~BRDFileBase()
-	{
-		free(file_buf);
-		file_buf = nullptr;
-	}
+	virtual ~BRDFileBase() {}
+
+	// Frees the elements and the file buffer once a board has been built from them, keeps valid and error_msg
+	virtual void release_elements();
+
   protected:
 	void AddNailsAsPins();
 	BRDFileBase() {}
-	// file_buf is used by some implementations. But since the derived class constructurs
-	// are already passed a memory buffer most usages are "historic unneeded extra copies".
+
+	// Takes ownership of buf, strings parsed from it stay valid for the lifetime of the file
+	char *adopt_buffer(ParseBuffer &buf);
+
+	// Buffer of the file being parsed, owned by buffers
 	char *file_buf = nullptr;
+	std::vector<ParseBuffer> buffers;
+	Utf8Arena arena;
 
 	std::vector<std::pair<BRDPoint, BRDPoint>> arc_to_segments(double startAngle, double endAngle, double r, BRDPoint p1, BRDPoint p2, BRDPoint pc);
 
@@ -147,5 +285,7 @@ class BRDFileBase {
 	double distance(const BRDPoint &p1, const BRDPoint &p2);
 };
 
-void stringfile(char *buffer, std::vector<char*> &lines);
-char *fix_to_utf8(char *s, char **arena, char *arena_end);
+char *fix_to_utf8(char *s, Utf8Arena &arena);
+
+// Returns true if the given str was found in buf
+bool find_str_in_buf(const std::string str, const ParseBuffer &buf);
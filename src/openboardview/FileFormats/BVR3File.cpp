@@ -3,17 +3,18 @@
 #include "utils.h"
 #include <cmath>
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 #include <cstring>
 #include <list>
 #include <algorithm>
 
+#include "parallel.h"
+
 int manhattan_distance(const BRDPoint &p1, const BRDPoint &p2) {
 	return abs(p1.x - p2.x) + abs(p1.y - p2.y);
 }
 
-bool BVR3File::verifyFormat(std::vector<char> &buf) {
+bool BVR3File::verifyFormat(const ParseBuffer &buf) {
 	return find_str_in_buf("BVRAW_FORMAT_3", buf);
 }
 
@@ -29,28 +30,179 @@ static T readSide(const char* side) {
 		return T::Top;
 	else{
 		char* p = (char*)side;
-		int side_p = strtol(side, &p, 10);
+		int side_p = parse_long(side, &p);
 		return (T)side_p;
 	}
 }
 
-BVR3File::BVR3File(std::vector<char> &buf) {
-	auto buffer_size = buf.size();
+namespace {
 
-	char *saved_locale = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
-	
-	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
+enum class Keyword {
+	None,
+	PartName, PartSide, PartOrigin, PartMount, PartOutlineRelative, PartOutlineRelativeCustom, PartEnd,
+	PinId, PinNumber, PinName, PinSide, PinOrigin, PinRadius, PinNet, PinType, PinComment, PinDiodeValue, PinVoltageValue, PinOutlineRelative, PinSize, PinAngle, PinShape, PinEnd,
+	TrackId, TrackNet, TrackPointStart, TrackWidth, TrackPointEnd, TrackSide, TrackEnd,
+	ViaId, ViaSize, ViaNet, ViaPos, ViaSide, ViaSideTarget, ViaEnd,
+	ArcId, ArcPos, ArcSide, ArcNet, ArcRadius, ArcStartAngle, ArcEndAngle, ArcEnd,
+	OutlinePoints, OutlineSegmentedCustom, OutlineArc, OutlineSegmented,
+	BvrawScale,
+};
+
+struct KeywordName {
+	const char *name;
+	Keyword keyword;
+};
+
+constexpr KeywordName kKeywords[] = {
+    {"PART_NAME", Keyword::PartName},
+    {"PART_SIDE", Keyword::PartSide},
+    {"PART_ORIGIN", Keyword::PartOrigin},
+    {"PART_MOUNT", Keyword::PartMount},
+    {"PART_OUTLINE_RELATIVE", Keyword::PartOutlineRelative},
+    {"PART_OUTLINE_RELATIVE_CUSTOM", Keyword::PartOutlineRelativeCustom},
+    {"PART_END", Keyword::PartEnd},
+    {"PIN_ID", Keyword::PinId},
+    {"PIN_NUMBER", Keyword::PinNumber},
+    {"PIN_NAME", Keyword::PinName},
+    {"PIN_SIDE", Keyword::PinSide},
+    {"PIN_ORIGIN", Keyword::PinOrigin},
+    {"PIN_RADIUS", Keyword::PinRadius},
+    {"PIN_NET", Keyword::PinNet},
+    {"PIN_TYPE", Keyword::PinType},
+    {"PIN_COMMENT", Keyword::PinComment},
+    {"PIN_DIODE_VALUE", Keyword::PinDiodeValue},
+    {"PIN_VOLTAGE_VALUE", Keyword::PinVoltageValue},
+    {"PIN_OUTLINE_RELATIVE", Keyword::PinOutlineRelative},
+    {"PIN_SIZE", Keyword::PinSize},
+    {"PIN_ANGLE", Keyword::PinAngle},
+    {"PIN_SHAPE", Keyword::PinShape},
+    {"PIN_END", Keyword::PinEnd},
+    {"TRACK_ID", Keyword::TrackId},
+    {"TRACK_NET", Keyword::TrackNet},
+    {"TRACK_POINT_START", Keyword::TrackPointStart},
+    {"TRACK_WIDTH", Keyword::TrackWidth},
+    {"TRACK_POINT_END", Keyword::TrackPointEnd},
+    {"TRACK_SIDE", Keyword::TrackSide},
+    {"TRACK_END", Keyword::TrackEnd},
+    {"VIA_ID", Keyword::ViaId},
+    {"VIA_SIZE", Keyword::ViaSize},
+    {"VIA_NET", Keyword::ViaNet},
+    {"VIA_POS", Keyword::ViaPos},
+    {"VIA_SIDE", Keyword::ViaSide},
+    {"VIA_SIDE_TARGET", Keyword::ViaSideTarget},
+    {"VIA_END", Keyword::ViaEnd},
+    {"ARC_ID", Keyword::ArcId},
+    {"ARC_POS", Keyword::ArcPos},
+    {"ARC_SIDE", Keyword::ArcSide},
+    {"ARC_NET", Keyword::ArcNet},
+    {"ARC_RADIUS", Keyword::ArcRadius},
+    {"ARC_START_ANGLE", Keyword::ArcStartAngle},
+    {"ARC_END_ANGLE", Keyword::ArcEndAngle},
+    {"ARC_END", Keyword::ArcEnd},
+    {"OUTLINE_POINTS", Keyword::OutlinePoints},
+    {"OUTLINE_SEGMENTED_CUSTOM", Keyword::OutlineSegmentedCustom},
+    {"OUTLINE_ARC", Keyword::OutlineArc},
+    {"BVRAW_SCALE", Keyword::BvrawScale},
+    {"OUTLINE_SEGMENTED", Keyword::OutlineSegmented},
+};
+
+constexpr size_t kNumKeywords = sizeof(kKeywords) / sizeof(kKeywords[0]);
 
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+/*
+ * Perfect hash of the keywords above: FNV-1a from a seed chosen so the top 7 bits differ for every
+ * keyword. A line is dispatched with one hash of its first token and a single compare.
+ * If a keyword is added and the static_assert below fails, search for another seed.
+ */
+constexpr uint32_t kKeywordSeed = 146904;
+constexpr int kKeywordHashBits  = 7;
 
+constexpr uint32_t keyword_hash(const char *s, size_t len) {
+	uint32_t h = kKeywordSeed;
+	for (size_t i = 0; i < len; i++) h = (h ^ uint8_t(s[i])) * 0x01000193u;
+	return h >> (32 - kKeywordHashBits);
+}
+
+constexpr size_t keyword_length(const char *s) {
+	size_t len = 0;
+	while (s[len]) len++;
+	return len;
+}
+
+struct KeywordTable {
+	int8_t slots[1 << kKeywordHashBits] = {};
+	bool perfect                        = true;
+};
+
+constexpr KeywordTable make_keyword_table() {
+	KeywordTable table;
+	for (auto &slot : table.slots) slot = -1;
+	for (size_t i = 0; i < kNumKeywords; i++) {
+		auto &slot = table.slots[keyword_hash(kKeywords[i].name, keyword_length(kKeywords[i].name))];
+		if (slot >= 0) table.perfect = false;
+		slot = int8_t(i);
+	}
+	return table;
+}
+
+constexpr KeywordTable kKeywordTable = make_keyword_table();
+static_assert(kKeywordTable.perfect, "BVR3 keyword hash collision, kKeywordSeed needs to be changed");
+
+Keyword find_keyword(const char *token, size_t len) {
+	int index = kKeywordTable.slots[keyword_hash(token, len)];
+	if (index < 0) return Keyword::None;
+	const char *name = kKeywords[index].name;
+	if (strncmp(name, token, len) || name[len]) return Keyword::None;
+	return kKeywords[index].keyword;
+}
+
+// Top-level records end with these, records are independent so a file can be split after them
+bool is_record_end(Keyword keyword) {
+	return keyword == Keyword::PartEnd || keyword == Keyword::TrackEnd || keyword == Keyword::ViaEnd || keyword == Keyword::ArcEnd;
+}
+
+inline bool is_line_break(char c) {
+	return c == '\r' || c == '\n';
+}
+
+// Start of the first line after the first record end at or after pos, end if there is none
+char *next_record_start(char *pos, char *end) {
+	// pos may be in the middle of a line, start with the next one
+	while (pos < end && !is_line_break(*pos)) pos++;
+	while (pos < end) {
+		while (pos < end && isspace((uint8_t)*pos)) pos++;
+		char *token = pos;
+		while (pos < end && *pos && !isspace((uint8_t)*pos)) pos++;
+		bool record_end = is_record_end(find_keyword(token, pos - token));
+		while (pos < end && !is_line_break(*pos)) pos++;
+		if (record_end) {
+			while (pos < end && is_line_break(*pos)) pos++;
+			return pos;
+		}
+	}
+	return end;
+}
+
+/*
+ * A run of whole records parsed on its own, possibly on another thread. Pin part numbers and
+ * part end of pins are relative to the chunk until the chunks are concatenated.
+ */
+struct RecordChunk {
+	char *begin = nullptr;
+	size_t size = 0;
+
+	std::vector<BRDPart> parts;
+	std::vector<BRDPin> pins;
+	std::vector<BRDTrack> tracks;
+	std::vector<BRDVia> vias;
+	std::vector<BRDArc> arcs;
+	std::vector<char *> global_lines; // board outline and scale, parsed in file order once all chunks are done
+	Utf8Arena arena;                  // fix_to_utf8() storage, the file's one isn't thread safe
+	std::string error_msg;
+
+	void parse();
+};
+
+void RecordChunk::parse() {
 	BRDPart blank_part;
 	BRDPin blank_pin;
 	BRDTrack blank_track;
@@ -61,10 +213,8 @@ BVR3File::BVR3File(std::vector<char> &buf) {
 	BRDTrack track;
 	BRDVia via;
 	BRDArc arc;
-	std::list<std::pair<BRDPoint, BRDPoint>> outline_segments;
 
-	std::vector<char *> lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(begin, size);
 
 	for (char *line : lines) {
 		while (isspace((uint8_t)*line)) line++;
@@ -73,321 +223,377 @@ BVR3File::BVR3File(std::vector<char> &buf) {
 		char *p = line;
 		char *s;
 
-		if (!strncmp(line, "PART_NAME ", 10)) {
-			p += 10;
-			part.name = READ_STR();
-		} else if (!strncmp(line, "PART_SIDE ", 10)) {
-			p += 10;
-			char *side = READ_STR();
-			part.mounting_side = readSide<BRDPartMountingSide>(side);
-		} else if (!strncmp(line, "PART_ORIGIN ", 12)) {
-			// Value ignored, used as reference point for relative pin placements, not currently supported
-		} else if (!strncmp(line, "PART_MOUNT ", 11)) {
-			p += 11;
-			char *mount = READ_STR();
-			if (!strcmp(mount, "SMD"))
-				part.part_type = BRDPartType::SMD;
-			else
-				part.part_type = BRDPartType::ThroughHole;
-		} else if (!strncmp(line, "PART_OUTLINE_RELATIVE ", 22)) {
-		} else if (!strncmp(line, "PART_OUTLINE_RELATIVE_CUSTOM ", 29)) {
-			p += 29;
-			while (p[0]) {
-				auto pold = p;
-				BRDPoint point;
-				double x = READ_DOUBLE();
-				point.x  = trunc(x);
-				double y = READ_DOUBLE();
-				point.y  = trunc(y);
-				// Nothing was read, probably end of list
-				if (pold == p) {
-					break;
+		while (*p && !isspace((uint8_t)*p)) p++;
+
+		switch (find_keyword(line, p - line)) {
+			case Keyword::None: break;
+
+			case Keyword::PartName: part.name = READ_STR(); break;
+			case Keyword::PartSide: {
+				char *side         = READ_STR();
+				part.mounting_side = readSide<BRDPartMountingSide>(side);
+			} break;
+			case Keyword::PartOrigin:
+				// Value ignored, used as reference point for relative pin placements, not currently supported
+				break;
+			case Keyword::PartMount: {
+				char *mount = READ_STR();
+				if (!strcmp(mount, "SMD"))
+					part.part_type = BRDPartType::SMD;
+				else
+					part.part_type = BRDPartType::ThroughHole;
+			} break;
+			case Keyword::PartOutlineRelative: break;
+			case Keyword::PartOutlineRelativeCustom:
+				while (p[0]) {
+					auto pold = p;
+					BRDPoint point;
+					double x = READ_DOUBLE();
+					point.x  = trunc(x);
+					double y = READ_DOUBLE();
+					point.y  = trunc(y);
+					// Nothing was read, probably end of list
+					if (pold == p) {
+						break;
+					}
+					part.format.push_back(point);
 				}
-				part.format.push_back(point);
-			}
-		} else if (!strncmp(line, "PIN_ID ", 7)) {
-			// Value ignored, not currently relevant for BRDPin
-		} else if (!strncmp(line, "PIN_NUMBER ", 11)) {
-			p += 11;
-			pin.snum = READ_STR();
-		} else if (!strncmp(line, "PIN_NAME ", 9)) {
-			p += 9;
-			pin.name = READ_STR();
-		} else if (!strncmp(line, "PIN_SIDE ", 9)) {
-			p += 9;
-			char *side = READ_STR();
-			pin.side = readSide<BRDPinSide>(side);
-		} else if (!strncmp(line, "PIN_ORIGIN ", 11)) {
-			p += 11;
-			double origin_x = READ_DOUBLE();
-			pin.pos.x = trunc(origin_x);
-			double origin_y = READ_DOUBLE();
-			pin.pos.y = trunc(origin_y);
-		} else if (!strncmp(line, "PIN_RADIUS ", 11)) {
-			p += 11;
-			pin.radius = READ_DOUBLE();
-		} else if (!strncmp(line, "PIN_NET ", 8)) {
-			p += 8;
-			pin.net = READ_STR();
-		} else if (!strncmp(line, "PIN_TYPE ", 9)) {
-			// Value ignored, not currently relevant for BRDPin
-		} else if (!strncmp(line, "PIN_COMMENT ", 12)) {
-			// Value ignored, not currently relevant for BRDPin
-		} else if (!strncmp(line, "PIN_DIODE_VALUE ", 16)) {
-			p += 16;
-			pin.diode_vale = READ_STR();
-		} else if (!strncmp(line, "PIN_VOLTAGE_VALUE ", 18)) {
-			p += 18;
-			pin.voltage_value = READ_STR();
-		} else if (!strncmp(line, "PIN_OUTLINE_RELATIVE ", 21)) {
-			// Value ignored, custom outline for pins not yet supported
-		} else if (!strncmp(line, "PIN_SIZE ", 9)) {
-			p += 9;
-			double x = READ_DOUBLE();
-			pin.size.x = trunc(x);
-			double y = READ_DOUBLE();
-			pin.size.y = trunc(y);
-		} else if (!strncmp(line, "PIN_ANGLE ", 10)) {
-			p += 10;
-			pin.angle = READ_DOUBLE();
-		} else if (!strncmp(line, "PIN_SHAPE ", 10)) {
-			p += 10;
-			pin.shape = BPDPinShape(READ_UINT());
-		} else if (!strcmp(line, "PIN_END")) {
-			pin.part = parts.size() + 1; // pin is for current part, which will not yet have been added to parts vector
-			pins.push_back(pin);
-			pin = blank_pin;
-		} else if (!strcmp(line, "PART_END")) {
-			part.end_of_pins = pins.size();
-			parts.push_back(part);
-			part = blank_part;
-		} else if (!strncmp(line, "TRACK_ID ", 9)) {
-
-		} else if (!strncmp(line, "TRACK_NET ", 10)) {
-			p += 10;
-			track.net = READ_STR();
-		} else if (!strncmp(line, "TRACK_POINT_START ", 18)) {
-			p += 18;
-			BRDPoint point;
-			double x = READ_DOUBLE();
-			point.x  = trunc(x);
-			double y = READ_DOUBLE();
-			point.y  = trunc(y);
-			track.points.first = point;
-		} else if (!strncmp(line, "TRACK_WIDTH ", 12)) {
-			p += 12;
-			track.width = READ_DOUBLE();
-		} else if (!strncmp(line, "TRACK_POINT_END ", 16)) {
-			p += 16;
-			BRDPoint point;
-			double x = READ_DOUBLE();
-			point.x  = trunc(x);
-			double y = READ_DOUBLE();
-			point.y  = trunc(y);
-			track.points.second = point;
-		} else if (!strncmp(line, "TRACK_SIDE ", 11)) {
-			p += 11;
-			char *side = READ_STR();
-			track.side = readSide<BRDPartMountingSide>(side);
-		} else if (!strncmp(line, "TRACK_END ", 10)) {
-			tracks.push_back(track);
-			track = blank_track;
-		} else if (!strncmp(line, "VIA_ID ", 7)) {
-
-		} else if (!strncmp(line, "VIA_SIZE ", 9)) {
-			p += 9;
-			via.size = READ_DOUBLE();
-		} else if (!strncmp(line, "VIA_NET ", 8)) {
-			p += 8;
-			via.net = READ_STR();
-		} else if (!strncmp(line, "VIA_POS ", 8)) {
-			p += 8;
-			double x = READ_DOUBLE();
-			via.pos.x  = trunc(x);
-			double y = READ_DOUBLE();
-			via.pos.y  = trunc(y);
-		} else if (!strncmp(line, "VIA_SIDE ", 9)) {
-			p += 9;
-			char *side = READ_STR();
-			via.side = readSide<BRDPartMountingSide>(side);
-		} else if (!strncmp(line, "VIA_SIDE_TARGET ", 16)) {
-			p += 16;
-			char *side = READ_STR();
-			via.target_side = readSide<BRDPartMountingSide>(side);
-		} else if (!strncmp(line, "VIA_END ", 8)) {
-			vias.push_back(via);
-			via = blank_via;
-		} else if (!strncmp(line, "ARC_ID ", 7)) {
-		} else if (!strncmp(line, "ARC_POS ", 8)) {
-			p += 8;
-			double x = READ_DOUBLE();
-			arc.pos.x  = trunc(x);
-			double y = READ_DOUBLE();
-			arc.pos.y  = trunc(y);
-		} else if (!strncmp(line, "ARC_SIDE ", 9)) {
-			p += 9;
-			char *side = READ_STR();
-			arc.side = readSide<BRDPartMountingSide>(side);
-		} else if (!strncmp(line, "ARC_NET ", 8)) {
-			p += 8;
-			arc.net = READ_STR();
-		} else if (!strncmp(line, "ARC_RADIUS ", 10)) {
-			p += 10;
-			arc.radius = READ_DOUBLE();
-		} else if (!strncmp(line, "ARC_START_ANGLE ", 16)) {
-			p += 16;
-			arc.startAngle = READ_DOUBLE() * (M_PI / 180.0);
-		} else if (!strncmp(line, "ARC_END_ANGLE ", 14)) {
-			p += 14;
-			arc.endAngle = READ_DOUBLE() * (M_PI / 180.0);
-		} else if (!strncmp(line, "ARC_END ", 8)) {
-			arcs.push_back(arc);
-			arc = blank_arc;
-		} else if (!strncmp(line, "OUTLINE_POINTS ", 15)) {
-			p += 15;
-			while (p[0]) {
-				auto pold = p;
+				break;
+			case Keyword::PartEnd:
+				part.end_of_pins = pins.size();
+				parts.push_back(part);
+				part = blank_part;
+				break;
+
+			case Keyword::PinId:
+				// Value ignored, not currently relevant for BRDPin
+				break;
+			case Keyword::PinNumber: pin.snum = READ_STR(); break;
+			case Keyword::PinName: pin.name = READ_STR(); break;
+			case Keyword::PinSide: {
+				char *side = READ_STR();
+				pin.side   = readSide<BRDPinSide>(side);
+			} break;
+			case Keyword::PinOrigin: {
+				double origin_x = READ_DOUBLE();
+				pin.pos.x       = trunc(origin_x);
+				double origin_y = READ_DOUBLE();
+				pin.pos.y       = trunc(origin_y);
+			} break;
+			case Keyword::PinRadius: pin.radius = READ_DOUBLE(); break;
+			case Keyword::PinNet: pin.net = READ_STR(); break;
+			case Keyword::PinType:
+			case Keyword::PinComment:
+				// Value ignored, not currently relevant for BRDPin
+				break;
+			case Keyword::PinDiodeValue: pin.diode_vale = READ_STR(); break;
+			case Keyword::PinVoltageValue: pin.voltage_value = READ_STR(); break;
+			case Keyword::PinOutlineRelative:
+				// Value ignored, custom outline for pins not yet supported
+				break;
+			case Keyword::PinSize: {
+				double x   = READ_DOUBLE();
+				pin.size.x = trunc(x);
+				double y   = READ_DOUBLE();
+				pin.size.y = trunc(y);
+			} break;
+			case Keyword::PinAngle: pin.angle = READ_DOUBLE(); break;
+			case Keyword::PinShape: pin.shape = BPDPinShape(READ_UINT()); break;
+			case Keyword::PinEnd:
+				pin.part = parts.size() + 1; // pin is for current part, which will not yet have been added to parts vector
+				pins.push_back(pin);
+				pin = blank_pin;
+				break;
+
+			case Keyword::TrackId: break;
+			case Keyword::TrackNet: track.net = READ_STR(); break;
+			case Keyword::TrackPointStart: {
 				BRDPoint point;
-				double x = READ_DOUBLE();
-				point.x  = trunc(x);
-				double y = READ_DOUBLE();
-				point.y  = trunc(y);
-				// Nothing was read, probably end of list
-				if (pold == p) {
-					break;
-				}
-				format.push_back(point);
-			}
-		} else if (!strncmp(line, "OUTLINE_SEGMENTED_CUSTOM ", 25)) {
-			p += 25;
-			while (p[0]) {
-				auto pold = p;
-				std::pair<BRDPoint, BRDPoint> outline_segment;
-				double x = READ_DOUBLE();
-				outline_segment.first.x  = trunc(x);
-				double y = READ_DOUBLE();
-				outline_segment.first.y  = trunc(y);
-				x = READ_DOUBLE();
-				outline_segment.second.x = trunc(x);
-				y = READ_DOUBLE();
-				outline_segment.second.y = trunc(y);
-				// Nothing was read, probably end of list
-				if (pold == p) {
+				double x           = READ_DOUBLE();
+				point.x            = trunc(x);
+				double y           = READ_DOUBLE();
+				point.y            = trunc(y);
+				track.points.first = point;
+			} break;
+			case Keyword::TrackWidth: track.width = READ_DOUBLE(); break;
+			case Keyword::TrackPointEnd: {
+				BRDPoint point;
+				double x            = READ_DOUBLE();
+				point.x             = trunc(x);
+				double y            = READ_DOUBLE();
+				point.y             = trunc(y);
+				track.points.second = point;
+			} break;
+			case Keyword::TrackSide: {
+				char *side = READ_STR();
+				track.side = readSide<BRDPartMountingSide>(side);
+			} break;
+			case Keyword::TrackEnd:
+				tracks.push_back(track);
+				track = blank_track;
+				break;
+
+			case Keyword::ViaId: break;
+			case Keyword::ViaSize: via.size = READ_DOUBLE(); break;
+			case Keyword::ViaNet: via.net = READ_STR(); break;
+			case Keyword::ViaPos: {
+				double x  = READ_DOUBLE();
+				via.pos.x = trunc(x);
+				double y  = READ_DOUBLE();
+				via.pos.y = trunc(y);
+			} break;
+			case Keyword::ViaSide: {
+				char *side = READ_STR();
+				via.side   = readSide<BRDPartMountingSide>(side);
+			} break;
+			case Keyword::ViaSideTarget: {
+				char *side      = READ_STR();
+				via.target_side = readSide<BRDPartMountingSide>(side);
+			} break;
+			case Keyword::ViaEnd:
+				vias.push_back(via);
+				via = blank_via;
+				break;
+
+			case Keyword::ArcId: break;
+			case Keyword::ArcPos: {
+				double x  = READ_DOUBLE();
+				arc.pos.x = trunc(x);
+				double y  = READ_DOUBLE();
+				arc.pos.y = trunc(y);
+			} break;
+			case Keyword::ArcSide: {
+				char *side = READ_STR();
+				arc.side   = readSide<BRDPartMountingSide>(side);
+			} break;
+			case Keyword::ArcNet: arc.net = READ_STR(); break;
+			case Keyword::ArcRadius: arc.radius = READ_DOUBLE(); break;
+			case Keyword::ArcStartAngle: arc.startAngle = READ_DOUBLE() * (M_PI / 180.0); break;
+			case Keyword::ArcEndAngle: arc.endAngle = READ_DOUBLE() * (M_PI / 180.0); break;
+			case Keyword::ArcEnd:
+				arcs.push_back(arc);
+				arc = blank_arc;
+				break;
+
+			case Keyword::OutlinePoints:
+			case Keyword::OutlineSegmentedCustom:
+			case Keyword::OutlineArc:
+			case Keyword::BvrawScale:
+			case Keyword::OutlineSegmented: global_lines.push_back(line); break;
+		}
+	}
+}
+
+} // namespace
+
+BVR3File::BVR3File(ParseBuffer &buf) {
+	auto buffer_size = buf.size();
+
+	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
+	file_buf = adopt_buffer(buf);
+
+	// Split the file in chunks of whole records and parse them concurrently
+	static constexpr size_t min_chunk_size = 1 << 20;
+	std::vector<RecordChunk> chunks;
+	char *buffer_end = file_buf + buffer_size;
+	char *chunk_end  = file_buf;
+	for (auto &range : split_ranges(buffer_size, min_chunk_size)) {
+		if (chunk_end == buffer_end) break;
+		RecordChunk chunk;
+		chunk.begin = chunk_end;
+		chunk_end   = range.second == buffer_size ? buffer_end : next_record_start(std::max(file_buf + range.second, chunk_end), buffer_end);
+		chunk.size  = chunk_end - chunk.begin;
+		chunks.push_back(std::move(chunk));
+	}
+	parallel_for_ranges(chunks.size(), 1, [&chunks](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) chunks[i].parse();
+	});
+
+	// Concatenate in file order, making pin part numbers and part end of pins absolute
+	size_t total_parts = 0, total_pins = 0, total_tracks = 0, total_vias = 0, total_arcs = 0;
+	for (auto &chunk : chunks) {
+		total_parts += chunk.parts.size();
+		total_pins += chunk.pins.size();
+		total_tracks += chunk.tracks.size();
+		total_vias += chunk.vias.size();
+		total_arcs += chunk.arcs.size();
+	}
+	parts.reserve(total_parts);
+	pins.reserve(total_pins);
+	tracks.reserve(total_tracks);
+	vias.reserve(total_vias);
+	arcs.reserve(total_arcs);
+
+	for (auto &chunk : chunks) {
+		unsigned int part_offset = parts.size();
+		unsigned int pin_offset  = pins.size();
+		for (auto &part : chunk.parts) {
+			part.end_of_pins += pin_offset;
+			parts.push_back(std::move(part));
+		}
+		for (auto &pin : chunk.pins) {
+			pin.part += part_offset;
+			pins.push_back(pin);
+		}
+		tracks.insert(tracks.end(), chunk.tracks.begin(), chunk.tracks.end());
+		vias.insert(vias.end(), chunk.vias.begin(), chunk.vias.end());
+		arcs.insert(arcs.end(), chunk.arcs.begin(), chunk.arcs.end());
+		arena.merge(std::move(chunk.arena));
+		if (error_msg.empty()) error_msg = chunk.error_msg;
+	}
+
+	std::list<std::pair<BRDPoint, BRDPoint>> outline_segments;
+
+	for (auto &chunk : chunks) {
+		for (char *line : chunk.global_lines) {
+			char *p = line;
+
+			while (*p && !isspace((uint8_t)*p)) p++;
+
+			switch (find_keyword(line, p - line)) {
+				case Keyword::OutlinePoints:
+					while (p[0]) {
+						auto pold = p;
+						BRDPoint point;
+						double x = READ_DOUBLE();
+						point.x  = trunc(x);
+						double y = READ_DOUBLE();
+						point.y  = trunc(y);
+						// Nothing was read, probably end of list
+						if (pold == p) {
+							break;
+						}
+						format.push_back(point);
+					}
 					break;
-				}
-				this->outline_segments.push_back(outline_segment);
-			}
-		} else if (!strncmp(line, "OUTLINE_ARC ", 12)) {
-			p += 12;
-			BRDPoint pc, p1, p2;
-			double startAngle, endAngle, radius;
-			pc.x = READ_DOUBLE();
-			pc.y = READ_DOUBLE();
-			radius = READ_DOUBLE();
-			startAngle = READ_DOUBLE() * (M_PI / 180.0);
-			endAngle = READ_DOUBLE() * (M_PI / 180.0);
-
-			p1.x = pc.x + radius * cos(startAngle);
-			p1.y = pc.y + radius * sin(startAngle);
-
-			p2.x = pc.x + radius * cos(endAngle);
-			p2.y = pc.y + radius * sin(endAngle);
-
-			std::vector<std::pair<BRDPoint, BRDPoint>> segments = arc_to_segments(startAngle, endAngle, radius, p1, p2, pc);
-			std::move(segments.begin(), segments.end(), std::back_inserter(this->outline_segments));
-
-		} else if (!strncmp(line, "BVRAW_SCALE ", 12)) {
-			p += 12;
-			scale = READ_DOUBLE();
-		} else if (!strncmp(line, "OUTLINE_SEGMENTED ", 18)) {
-			p += 18;
-			while (p[0]) {
-				auto pold = p;
-				std::pair<BRDPoint, BRDPoint> outline_segment;
-				double x = READ_DOUBLE();
-				outline_segment.first.x  = trunc(x);
-				double y = READ_DOUBLE();
-				outline_segment.first.y  = trunc(y);
-				x = READ_DOUBLE();
-				outline_segment.second.x = trunc(x);
-				y = READ_DOUBLE();
-				outline_segment.second.y = trunc(y);
-				// Nothing was read, probably end of list
-				if (pold == p) {
+				case Keyword::OutlineSegmentedCustom:
+					while (p[0]) {
+						auto pold = p;
+						std::pair<BRDPoint, BRDPoint> outline_segment;
+						double x = READ_DOUBLE();
+						outline_segment.first.x  = trunc(x);
+						double y = READ_DOUBLE();
+						outline_segment.first.y  = trunc(y);
+						x = READ_DOUBLE();
+						outline_segment.second.x = trunc(x);
+						y = READ_DOUBLE();
+						outline_segment.second.y = trunc(y);
+						// Nothing was read, probably end of list
+						if (pold == p) {
+							break;
+						}
+						this->outline_segments.push_back(outline_segment);
+					}
 					break;
-				}
-				outline_segments.push_back(outline_segment);
-			}
+				case Keyword::OutlineArc: {
+					BRDPoint pc, p1, p2;
+					double startAngle, endAngle, radius;
+					pc.x = READ_DOUBLE();
+					pc.y = READ_DOUBLE();
+					radius = READ_DOUBLE();
+					startAngle = READ_DOUBLE() * (M_PI / 180.0);
+					endAngle = READ_DOUBLE() * (M_PI / 180.0);
 
-			if (outline_segments.empty())
-				continue;
-
-			// Get first segment and add both points to format
-			auto first_outline_segment = outline_segments.front();
-			outline_segments.pop_front();
-			format.push_back(first_outline_segment.first);
-			format.push_back(first_outline_segment.second);
-
-			// Loop through remaining segments picking the best candidate for the next segment
-			BRDPoint start_point = first_outline_segment.first;
-			BRDPoint end_point = first_outline_segment.second;
-			while (start_point != end_point && !outline_segments.empty()) {
-				// Loop through segments checking for exact match between points
-				auto it = outline_segments.begin();
-				bool match_found = false;
-				while (it != outline_segments.end()) {
-					// If exact match found on either first or second point, add other point to format and remove segment
-					if (end_point == it->first) {
-						format.push_back(it->second);
-						end_point = it->second;
-						outline_segments.erase(it);
-						match_found = true;
-						break;
-					} else if (end_point == it->second) {
-						format.push_back(it->first);
-						end_point = it->first;
-						outline_segments.erase(it);
-						match_found = true;
-						break;
+					p1.x = pc.x + radius * cos(startAngle);
+					p1.y = pc.y + radius * sin(startAngle);
+
+					p2.x = pc.x + radius * cos(endAngle);
+					p2.y = pc.y + radius * sin(endAngle);
+
+					std::vector<std::pair<BRDPoint, BRDPoint>> segments = arc_to_segments(startAngle, endAngle, radius, p1, p2, pc);
+					std::move(segments.begin(), segments.end(), std::back_inserter(this->outline_segments));
+				} break;
+				case Keyword::BvrawScale: scale = READ_DOUBLE(); break;
+				case Keyword::OutlineSegmented: {
+					while (p[0]) {
+						auto pold = p;
+						std::pair<BRDPoint, BRDPoint> outline_segment;
+						double x = READ_DOUBLE();
+						outline_segment.first.x  = trunc(x);
+						double y = READ_DOUBLE();
+						outline_segment.first.y  = trunc(y);
+						x = READ_DOUBLE();
+						outline_segment.second.x = trunc(x);
+						y = READ_DOUBLE();
+						outline_segment.second.y = trunc(y);
+						// Nothing was read, probably end of list
+						if (pold == p) {
+							break;
+						}
+						outline_segments.push_back(outline_segment);
 					}
-					it++;
-				}
-				if (match_found)
-					continue;
-
-				// Exact match not found, so pick nearest segment instead
-				it = std::min_element(
-					outline_segments.begin(),
-					outline_segments.end(),
-					[&end_point](const std::pair<BRDPoint, BRDPoint> &os1, const std::pair<BRDPoint, BRDPoint> &os2) {
-						return std::min(manhattan_distance(end_point, os1.first), manhattan_distance(end_point, os1.second))
-							< std::min(manhattan_distance(end_point, os2.first), manhattan_distance(end_point, os2.second));
-					});
-
-				// Calculate distances for comparison
-				auto start_point_distance = manhattan_distance(end_point, start_point);
-				auto segment_distance_first = manhattan_distance(end_point, it->first);
-				auto segment_distance_second = manhattan_distance(end_point, it->second);
-
-				// If start point is closer than both nearest segment points, format path more likely to be complete
-				if (start_point_distance <= segment_distance_first && start_point_distance <= segment_distance_second) {
-					format.push_back(start_point);
-					end_point = start_point;
-					break;
-				}
 
-				// Otherwise add points from nearest segment to format with closest point first, then remove segment
-				if (segment_distance_first <= segment_distance_second) {
-					format.push_back(it->first);
-					format.push_back(it->second);
-					end_point = it->second;
-					outline_segments.erase(it);
-				} else {
-					format.push_back(it->second);
-					format.push_back(it->first);
-					end_point = it->first;
-					outline_segments.erase(it);
-				}
+					if (outline_segments.empty()) break;
+
+					// Get first segment and add both points to format
+					auto first_outline_segment = outline_segments.front();
+					outline_segments.pop_front();
+					format.push_back(first_outline_segment.first);
+					format.push_back(first_outline_segment.second);
+
+					// Loop through remaining segments picking the best candidate for the next segment
+					BRDPoint start_point = first_outline_segment.first;
+					BRDPoint end_point = first_outline_segment.second;
+					while (start_point != end_point && !outline_segments.empty()) {
+						// Loop through segments checking for exact match between points
+						auto it = outline_segments.begin();
+						bool match_found = false;
+						while (it != outline_segments.end()) {
+							// If exact match found on either first or second point, add other point to format and remove segment
+							if (end_point == it->first) {
+								format.push_back(it->second);
+								end_point = it->second;
+								outline_segments.erase(it);
+								match_found = true;
+								break;
+							} else if (end_point == it->second) {
+								format.push_back(it->first);
+								end_point = it->first;
+								outline_segments.erase(it);
+								match_found = true;
+								break;
+							}
+							it++;
+						}
+						if (match_found)
+							continue;
+
+						// Exact match not found, so pick nearest segment instead
+						it = std::min_element(
+							outline_segments.begin(),
+							outline_segments.end(),
+							[&end_point](const std::pair<BRDPoint, BRDPoint> &os1, const std::pair<BRDPoint, BRDPoint> &os2) {
+								return std::min(manhattan_distance(end_point, os1.first), manhattan_distance(end_point, os1.second))
+									< std::min(manhattan_distance(end_point, os2.first), manhattan_distance(end_point, os2.second));
+							});
+
+						// Calculate distances for comparison
+						auto start_point_distance = manhattan_distance(end_point, start_point);
+						auto segment_distance_first = manhattan_distance(end_point, it->first);
+						auto segment_distance_second = manhattan_distance(end_point, it->second);
+
+						// If start point is closer than both nearest segment points, format path more likely to be complete
+						if (start_point_distance <= segment_distance_first && start_point_distance <= segment_distance_second) {
+							format.push_back(start_point);
+							end_point = start_point;
+							break;
+						}
+
+						// Otherwise add points from nearest segment to format with closest point first, then remove segment
+						if (segment_distance_first <= segment_distance_second) {
+							format.push_back(it->first);
+							format.push_back(it->second);
+							end_point = it->second;
+							outline_segments.erase(it);
+						} else {
+							format.push_back(it->second);
+							format.push_back(it->first);
+							end_point = it->first;
+							outline_segments.erase(it);
+						}
+					}
+				} break;
+				default: break;
 			}
 		}
 	}
@@ -397,7 +603,5 @@ BVR3File::BVR3File(std::vector<char> &buf) {
 	num_format = format.size();
 	num_nails  = nails.size();
 
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
-
 	valid = num_parts > 0 || num_format > 0;
 }
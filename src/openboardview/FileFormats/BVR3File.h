@@ -3,7 +3,7 @@
 #include "BRDFileBase.h"
 
 struct BVR3File : public BRDFileBase {
-	BVR3File(std::vector<char> &buf);
+	BVR3File(ParseBuffer &buf);
 
-	static bool verifyFormat(std::vector<char> &buf);
+	static bool verifyFormat(const ParseBuffer &buf);
 };
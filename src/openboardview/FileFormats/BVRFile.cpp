@@ -3,7 +3,6 @@
 #include "utils.h"
 #include <cmath>
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 #include <cstring>
 
@@ -17,36 +16,24 @@ char *nextfield(char *p) {
 	return p;
 }
 
-bool BVRFile::verifyFormat(std::vector<char> &buf) {
+bool BVRFile::verifyFormat(const ParseBuffer &buf) {
 	return find_str_in_buf("BVRAW_FORMAT_1", buf);
 }
 
-BVRFile::BVRFile(std::vector<char> &buf) {
+BVRFile::BVRFile(ParseBuffer &buf) {
 	auto buffer_size = buf.size();
 
-	char *saved_locale;
-	char ppn[100] = {0};                        // previous part name
-	saved_locale  = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
+	char ppn[100] = {0}; // previous part name
 
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	file_buf = adopt_buffer(buf);
 
 	int current_block = 0;
 
-	std::vector<char *> lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(file_buf, buffer_size);
 
-	std::vector<char *>::iterator line_it = lines.begin();
-	while (line_it < lines.end()) {
+	LineSplitter::iterator line_it = lines.begin();
+	while (line_it != lines.end()) {
 		char *line = *line_it;
 		++line_it;
 
@@ -160,7 +147,5 @@ BVRFile::BVRFile(std::vector<char> &buf) {
 	num_format = format.size();
 	num_nails  = nails.size();
 
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
-
 	valid = current_block != 0;
 }
@@ -3,7 +3,7 @@
 #include "BRDFileBase.h"
 
 struct BVRFile : public BRDFileBase {
-	BVRFile(std::vector<char> &buf);
+	BVRFile(ParseBuffer &buf);
 
-	static bool verifyFormat(std::vector<char> &buf);
+	static bool verifyFormat(const ParseBuffer &buf);
 };
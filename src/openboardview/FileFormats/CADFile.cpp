@@ -4,7 +4,6 @@
 #include <algorithm>
 #include <cmath>
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 #include <cstring>
 #include <unordered_map>
@@ -28,34 +27,22 @@ void CADFile::gen_outline() {
 }
 #undef OUTLINE_MARGIN
 
-bool CADFile::verifyFormat(std::vector<char> &buf) {
+bool CADFile::verifyFormat(const ParseBuffer &buf) {
 	return (find_str_in_buf("###Panel Added", buf) && find_str_in_buf("C_PIN", buf));
 }
 
-CADFile::CADFile(std::vector<char> &buf) {
+CADFile::CADFile(ParseBuffer &buf) {
 	auto buffer_size = buf.size();
 	float multiplier = 1000.0f;
-	char *saved_locale;
-	saved_locale  = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
 
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	file_buf = adopt_buffer(buf);
 
 	enum Block current_block = None;
 	std::unordered_map<std::string, int> parts_id; // map between part name and part number
 	char *nailnet; // Net name for VIA
 
-	std::vector<char *> lines;
-	stringfile(file_buf, lines);
+	LineSplitter lines(file_buf, buffer_size);
 
 	for (char *line : lines) {
 		while (isspace((uint8_t)*line)) line++;
@@ -159,7 +146,5 @@ CADFile::CADFile(std::vector<char> &buf) {
 	num_format = format.size();
 	num_nails  = nails.size();
 
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
-
 	valid = current_block != None;
 }
@@ -4,7 +4,7 @@
 
 class CSTFile : public BRDFileBase {
   public:
-	CSTFile(std::vector<char> &buf);
+	CSTFile(ParseBuffer &buf);
 
   private:
 	void gen_outline();
@@ -0,0 +1,559 @@
+#include "CacheFile.h"
+
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <unordered_map>
+
+namespace {
+
+constexpr char kMagic[8]      = {'O', 'B', 'V', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t kVersion   = 2; // bump whenever a record below or BRDFileBase changes
+constexpr uint32_t kNoString  = UINT32_MAX;
+constexpr size_t kSampleCount = 16;
+constexpr size_t kSampleSize  = 16 * 1024;
+constexpr uint64_t kFNVOffset = 14695981039346656037ull;
+constexpr uint64_t kFNVPrime  = 1099511628211ull;
+
+constexpr uint64_t kMaxCacheSize          = 1024ull * 1024 * 1024;       // whole cache directory
+constexpr std::chrono::hours kMaxCacheAge = std::chrono::hours(24 * 90); // since last used
+constexpr std::chrono::hours kMaxTempAge  = std::chrono::hours(24);      // left by an interrupted write
+
+enum Section { kFormat, kOutline, kParts, kPartFormats, kPins, kNails, kTracks, kVias, kArcs, kStrings, kSectionCount };
+
+struct SectionEntry {
+	uint64_t offset;
+	uint64_t count;
+};
+
+struct Header {
+	char magic[8];
+	uint32_t version;
+	float scale;
+	uint64_t source_size;
+	int64_t source_mtime;
+	uint64_t source_hash;
+	uint64_t checksum; // of everything after the header
+	uint32_t num_format;
+	uint32_t num_parts;
+	uint32_t num_pins;
+	uint32_t num_nails;
+	SectionEntry sections[kSectionCount];
+};
+
+struct PointRecord {
+	int32_t x, y;
+};
+
+struct SegmentRecord {
+	PointRecord first, second;
+};
+
+struct PartRecord {
+	uint32_t name;
+	uint32_t mfgcode;
+	int32_t mounting_side;
+	int32_t part_type;
+	uint32_t end_of_pins;
+	PointRecord p1, p2;
+	uint32_t format_first; // into kPartFormats
+	uint32_t format_count;
+};
+
+struct PinRecord {
+	PointRecord pos;
+	PointRecord size;
+	float angle;
+	int32_t shape;
+	int32_t probe;
+	uint32_t part;
+	int32_t side;
+	uint32_t net;
+	double radius;
+	uint32_t snum;
+	uint32_t name;
+	uint32_t diode_value;
+	uint32_t voltage_value;
+};
+
+struct NailRecord {
+	uint32_t probe;
+	PointRecord pos;
+	int32_t side;
+	uint32_t net;
+};
+
+struct TrackRecord {
+	SegmentRecord points;
+	int32_t side;
+	float width;
+	uint32_t net;
+};
+
+struct ViaRecord {
+	PointRecord pos;
+	float size;
+	int32_t side;
+	int32_t target_side;
+	uint32_t net;
+};
+
+struct ArcRecord {
+	PointRecord pos;
+	int32_t side;
+	float radius;
+	float start_angle;
+	float end_angle;
+	uint32_t net;
+};
+
+const size_t record_sizes[kSectionCount] = {sizeof(PointRecord),
+                                            sizeof(SegmentRecord),
+                                            sizeof(PartRecord),
+                                            sizeof(PointRecord),
+                                            sizeof(PinRecord),
+                                            sizeof(NailRecord),
+                                            sizeof(TrackRecord),
+                                            sizeof(ViaRecord),
+                                            sizeof(ArcRecord),
+                                            1};
+
+uint64_t fnv1a(uint64_t hash, const char *data, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (uint8_t)data[i];
+		hash *= kFNVPrime;
+	}
+	return hash;
+}
+
+// FNV-1a over 64-bit words, then the bytes left, so checking a whole cache file costs little
+uint64_t checksum(const char *data, size_t size) {
+	uint64_t hash = kFNVOffset;
+	size_t i      = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		hash ^= word;
+		hash *= kFNVPrime;
+	}
+	return fnv1a(hash, data + i, size - i);
+}
+
+// A temporary file next to path that no other write uses, not even one for the same board
+filesystem::path temp_path(const filesystem::path &path) {
+	static std::atomic<uint32_t> counter{0};
+	std::random_device random;
+	uint64_t unique = (uint64_t(random()) << 32 | random()) ^ counter++;
+
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%016llx.tmp", static_cast<unsigned long long>(unique));
+	auto tmppath = path;
+	tmppath += suffix;
+	return tmppath;
+}
+
+PointRecord to_record(const BRDPoint &p) {
+	return {p.x, p.y};
+}
+
+BRDPoint from_record(const PointRecord &p) {
+	return {p.x, p.y};
+}
+
+// Collects the records of each section and a deduplicated string table
+class CacheWriter {
+  public:
+	std::vector<char> sections[kSectionCount];
+
+	uint32_t add_string(const char *s) {
+		if (s == nullptr) return kNoString;
+		auto it = offsets.find(s);
+		if (it != offsets.end()) return it->second;
+
+		auto &strings   = sections[kStrings];
+		uint32_t offset = strings.size();
+		strings.insert(strings.end(), s, s + strlen(s) + 1);
+		offsets.emplace(s, offset);
+		return offset;
+	}
+
+	template <typename T>
+	void add(Section section, const T &record) {
+		auto &data = sections[section];
+		auto bytes = reinterpret_cast<const char *>(&record);
+		data.insert(data.end(), bytes, bytes + sizeof(T));
+	}
+
+  private:
+	std::unordered_map<std::string, uint32_t> offsets;
+};
+
+} // namespace
+
+bool SourceStamp::read(const std::vector<filesystem::path> &filepaths) {
+	size  = 0;
+	mtime = 0;
+	hash  = kFNVOffset;
+	if (filepaths.empty()) return false;
+
+	std::vector<char> block(kSampleSize);
+	for (auto &filepath : filepaths) {
+		std::error_code ec;
+		uint64_t file_size = filesystem::file_size(filepath, ec);
+		if (ec) return false;
+		int64_t file_mtime = filesystem::last_write_time(filepath, ec).time_since_epoch().count();
+		if (ec) return false;
+
+		size += file_size;
+		mtime     = std::max(mtime, file_mtime);
+		auto name = filepath.filename().u8string();
+		hash      = fnv1a(hash, reinterpret_cast<const char *>(name.data()), name.size());
+		hash      = fnv1a(hash, reinterpret_cast<const char *>(&file_size), sizeof(file_size));
+		hash      = fnv1a(hash, reinterpret_cast<const char *>(&file_mtime), sizeof(file_mtime));
+
+		ifstream file;
+		file.open(filepath, std::ios::in | std::ios::binary);
+		if (!file.is_open()) return false;
+
+		// FNV-1a of blocks spread evenly over the file, the first and last one included
+		size_t block_size = std::min<uint64_t>(file_size, kSampleSize);
+		for (size_t i = 0; i < kSampleCount && block_size > 0; i++) {
+			uint64_t offset = (file_size - block_size) * i / (kSampleCount - 1);
+			file.seekg(offset);
+			file.read(block.data(), block_size);
+			if (!file) return false;
+			hash = fnv1a(hash, block.data(), block_size);
+			if (block_size == file_size) break; // whole file hashed
+		}
+	}
+	return true;
+}
+
+CacheFile::CacheFile(ParseBuffer &buf, const SourceStamp &stamp) {
+	Header header;
+	if (buf.size() < sizeof(Header)) return;
+	memcpy(&header, buf.data(), sizeof(Header));
+
+	// Stale or foreign cache, silently ignored
+	SourceStamp cached;
+	cached.size  = header.source_size;
+	cached.mtime = header.source_mtime;
+	cached.hash  = header.source_hash;
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) || header.version != kVersion || !(cached == stamp)) return;
+	// Torn or damaged, as silently
+	if (header.checksum != checksum(buf.data() + sizeof(Header), buf.size() - sizeof(Header))) return;
+
+	for (int i = 0; i < kSectionCount; i++) {
+		auto &section = header.sections[i];
+		ENSURE_OR_FAIL(section.offset <= buf.size(), error_msg, return);
+		ENSURE_OR_FAIL(section.count <= (buf.size() - section.offset) / record_sizes[i], error_msg, return);
+	}
+	auto &string_section = header.sections[kStrings];
+	ENSURE_OR_FAIL(string_section.count == 0 || buf.data()[string_section.offset + string_section.count - 1] == 0, error_msg, return);
+
+	file_buf = adopt_buffer(buf);
+
+	const char *strings = file_buf + string_section.offset;
+	auto str            = [&](uint32_t offset, const char *fallback = nullptr) -> const char * {
+		return offset < string_section.count ? strings + offset : fallback;
+	};
+	// Records are copied out, sections are aligned but the records of a section may not be
+	auto read_records = [&](Section section, auto *record, auto fn) {
+		using T = typename std::remove_pointer<decltype(record)>::type;
+		for (uint64_t i = 0; i < header.sections[section].count; i++) {
+			memcpy(record, file_buf + header.sections[section].offset + i * sizeof(T), sizeof(T));
+			fn(*record);
+		}
+	};
+
+	scale      = header.scale;
+	num_format = header.num_format;
+	num_parts  = header.num_parts;
+	num_pins   = header.num_pins;
+	num_nails  = header.num_nails;
+
+	std::vector<BRDPoint> part_formats;
+	PointRecord point;
+	read_records(kPartFormats, &point, [&](const PointRecord &r) { part_formats.push_back(from_record(r)); });
+	read_records(kFormat, &point, [&](const PointRecord &r) { format.push_back(from_record(r)); });
+
+	SegmentRecord segment;
+	read_records(kOutline, &segment, [&](const SegmentRecord &r) {
+		outline_segments.push_back({from_record(r.first), from_record(r.second)});
+	});
+
+	PartRecord part_record;
+	read_records(kParts, &part_record, [&](const PartRecord &r) {
+		BRDPart part;
+		part.name          = str(r.name);
+		part.mfgcode       = str(r.mfgcode, "");
+		part.mounting_side = static_cast<BRDPartMountingSide>(r.mounting_side);
+		part.part_type     = static_cast<BRDPartType>(r.part_type);
+		part.end_of_pins   = r.end_of_pins;
+		part.p1            = from_record(r.p1);
+		part.p2            = from_record(r.p2);
+		if (uint64_t(r.format_first) + r.format_count <= part_formats.size()) {
+			part.format.assign(part_formats.begin() + r.format_first, part_formats.begin() + r.format_first + r.format_count);
+		}
+		parts.push_back(std::move(part));
+	});
+
+	PinRecord pin_record;
+	read_records(kPins, &pin_record, [&](const PinRecord &r) {
+		BRDPin pin;
+		pin.pos           = from_record(r.pos);
+		pin.size          = from_record(r.size);
+		pin.angle         = r.angle;
+		pin.shape         = static_cast<BPDPinShape>(r.shape);
+		pin.probe         = r.probe;
+		pin.part          = r.part;
+		pin.side          = static_cast<BRDPinSide>(r.side);
+		pin.net           = str(r.net, pin.net);
+		pin.radius        = r.radius;
+		pin.snum          = str(r.snum);
+		pin.name          = str(r.name);
+		pin.diode_vale    = str(r.diode_value);
+		pin.voltage_value = str(r.voltage_value);
+		pins.push_back(pin);
+	});
+
+	NailRecord nail_record;
+	read_records(kNails, &nail_record, [&](const NailRecord &r) {
+		BRDNail nail;
+		nail.probe = r.probe;
+		nail.pos   = from_record(r.pos);
+		nail.side  = static_cast<BRDPartMountingSide>(r.side);
+		nail.net   = str(r.net, nail.net);
+		nails.push_back(nail);
+	});
+
+	TrackRecord track_record;
+	read_records(kTracks, &track_record, [&](const TrackRecord &r) {
+		BRDTrack track;
+		track.points = {from_record(r.points.first), from_record(r.points.second)};
+		track.side   = static_cast<BRDPartMountingSide>(r.side);
+		track.width  = r.width;
+		track.net    = str(r.net, track.net);
+		tracks.push_back(track);
+	});
+
+	ViaRecord via_record;
+	read_records(kVias, &via_record, [&](const ViaRecord &r) {
+		BRDVia via;
+		via.pos         = from_record(r.pos);
+		via.size        = r.size;
+		via.side        = static_cast<BRDPartMountingSide>(r.side);
+		via.target_side = static_cast<BRDPartMountingSide>(r.target_side);
+		via.net         = str(r.net, via.net);
+		vias.push_back(via);
+	});
+
+	ArcRecord arc_record;
+	read_records(kArcs, &arc_record, [&](const ArcRecord &r) {
+		BRDArc arc;
+		arc.pos        = from_record(r.pos);
+		arc.side       = static_cast<BRDPartMountingSide>(r.side);
+		arc.radius     = r.radius;
+		arc.startAngle = r.start_angle;
+		arc.endAngle   = r.end_angle;
+		arc.net        = str(r.net, arc.net);
+		arcs.push_back(arc);
+	});
+
+	valid = true;
+}
+
+// Lays out the parsed data of file as a cache file in image
+void CacheFile::encode(const BRDFileBase &file, const SourceStamp &stamp, std::vector<char> &image) {
+	CacheWriter writer;
+
+	for (auto &p : file.format) writer.add(kFormat, to_record(p));
+	for (auto &s : file.outline_segments) writer.add(kOutline, SegmentRecord{to_record(s.first), to_record(s.second)});
+
+	uint32_t part_format_count = 0;
+	for (auto &part : file.parts) {
+		PartRecord r{};
+		r.name          = writer.add_string(part.name);
+		r.mfgcode       = writer.add_string(part.mfgcode.c_str());
+		r.mounting_side = static_cast<int32_t>(part.mounting_side);
+		r.part_type     = static_cast<int32_t>(part.part_type);
+		r.end_of_pins   = part.end_of_pins;
+		r.p1            = to_record(part.p1);
+		r.p2            = to_record(part.p2);
+		r.format_first  = part_format_count;
+		r.format_count  = part.format.size();
+		for (auto &p : part.format) writer.add(kPartFormats, to_record(p));
+		part_format_count += part.format.size();
+		writer.add(kParts, r);
+	}
+
+	for (auto &pin : file.pins) {
+		PinRecord r{};
+		r.pos           = to_record(pin.pos);
+		r.size          = to_record(pin.size);
+		r.angle         = pin.angle;
+		r.shape         = static_cast<int32_t>(pin.shape);
+		r.probe         = pin.probe;
+		r.part          = pin.part;
+		r.side          = static_cast<int32_t>(pin.side);
+		r.net           = writer.add_string(pin.net);
+		r.radius        = pin.radius;
+		r.snum          = writer.add_string(pin.snum);
+		r.name          = writer.add_string(pin.name);
+		r.diode_value   = writer.add_string(pin.diode_vale);
+		r.voltage_value = writer.add_string(pin.voltage_value);
+		writer.add(kPins, r);
+	}
+
+	for (auto &nail : file.nails) {
+		NailRecord r{};
+		r.probe = nail.probe;
+		r.pos   = to_record(nail.pos);
+		r.side  = static_cast<int32_t>(nail.side);
+		r.net   = writer.add_string(nail.net);
+		writer.add(kNails, r);
+	}
+
+	for (auto &track : file.tracks) {
+		TrackRecord r{};
+		r.points = {to_record(track.points.first), to_record(track.points.second)};
+		r.side   = static_cast<int32_t>(track.side);
+		r.width  = track.width;
+		r.net    = writer.add_string(track.net);
+		writer.add(kTracks, r);
+	}
+
+	for (auto &via : file.vias) {
+		ViaRecord r{};
+		r.pos         = to_record(via.pos);
+		r.size        = via.size;
+		r.side        = static_cast<int32_t>(via.side);
+		r.target_side = static_cast<int32_t>(via.target_side);
+		r.net         = writer.add_string(via.net);
+		writer.add(kVias, r);
+	}
+
+	for (auto &arc : file.arcs) {
+		ArcRecord r{};
+		r.pos         = to_record(arc.pos);
+		r.side        = static_cast<int32_t>(arc.side);
+		r.radius      = arc.radius;
+		r.start_angle = arc.startAngle;
+		r.end_angle   = arc.endAngle;
+		r.net         = writer.add_string(arc.net);
+		writer.add(kArcs, r);
+	}
+
+	Header header;
+	memset(&header, 0, sizeof(Header)); // padding included, it is written out
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version      = kVersion;
+	header.scale        = file.scale;
+	header.source_size  = stamp.size;
+	header.source_mtime = stamp.mtime;
+	header.source_hash  = stamp.hash;
+	header.num_format   = file.num_format;
+	header.num_parts    = file.num_parts;
+	header.num_pins     = file.num_pins;
+	header.num_nails    = file.num_nails;
+
+	uint64_t offset = sizeof(Header);
+	for (int i = 0; i < kSectionCount; i++) {
+		offset                    = (offset + 7) & ~uint64_t(7); // sections are 8 byte aligned
+		header.sections[i].offset = offset;
+		header.sections[i].count  = writer.sections[i].size() / record_sizes[i];
+		offset += writer.sections[i].size();
+	}
+
+	image.assign(offset, 0);
+	for (int i = 0; i < kSectionCount; i++) {
+		std::copy(writer.sections[i].begin(), writer.sections[i].end(), image.begin() + header.sections[i].offset);
+	}
+	header.checksum = checksum(image.data() + sizeof(Header), image.size() - sizeof(Header));
+	memcpy(image.data(), &header, sizeof(Header));
+}
+
+/*
+ * Writes an encoded cache to cachepath.
+ * Written to a temporary file of its own first and renamed, a reader never sees a partial cache and
+ * loads of the same board writing at once don't mix their files.
+ */
+bool CacheFile::write(const std::vector<char> &image, const filesystem::path &cachepath) {
+	std::error_code ec;
+	filesystem::create_directories(cachepath.parent_path(), ec);
+	auto tmppath = temp_path(cachepath);
+
+	ofstream out;
+	out.open(tmppath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) return false;
+	out.write(image.data(), image.size());
+	out.close();
+	if (!out) {
+		filesystem::remove(tmppath, ec);
+		return false;
+	}
+
+	filesystem::rename(tmppath, cachepath, ec);
+	if (ec) {
+		filesystem::remove(tmppath, ec);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Cache files are touched when read, so their modification time is when they were last used.
+ * Keeps the cache directory under kMaxCacheSize and without files unused for kMaxCacheAge.
+ */
+void CacheFile::prune(const filesystem::path &cache_dir) {
+	struct Entry {
+		filesystem::path path;
+		uint64_t size;
+		filesystem::file_time_type mtime;
+	};
+	std::vector<Entry> entries;
+	auto now = filesystem::file_time_type::clock::now();
+
+	std::error_code ec;
+	for (filesystem::directory_iterator it(cache_dir, ec), end; !ec && it != end; it.increment(ec)) {
+		std::error_code entry_ec;
+		auto path  = it->path();
+		auto mtime = filesystem::last_write_time(path, entry_ec);
+		auto size  = filesystem::file_size(path, entry_ec);
+		if (entry_ec) continue;
+
+		if (path.extension() == ".tmp") {
+			if (now - mtime > kMaxTempAge) filesystem::remove(path, entry_ec);
+		} else if (path.extension() == ".obvcache") {
+			if (now - mtime > kMaxCacheAge)
+				filesystem::remove(path, entry_ec);
+			else
+				entries.push_back({path, size, mtime});
+		}
+	}
+
+	uint64_t total = 0;
+	for (auto &entry : entries) total += entry.size;
+	std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.mtime < b.mtime; });
+	for (auto &entry : entries) {
+		if (total <= kMaxCacheSize) break;
+		filesystem::remove(entry.path, ec);
+		total -= entry.size;
+	}
+}
+
+// One cache file per board path, named after a hash of the absolute path
+filesystem::path CacheFile::cache_path(const filesystem::path &cache_dir, const filesystem::path &filepath) {
+	std::error_code ec;
+	auto absolute = filesystem::absolute(filepath, ec).u8string();
+	uint64_t hash = fnv1a(kFNVOffset, reinterpret_cast<const char *>(absolute.data()), absolute.size());
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.obvcache", static_cast<unsigned long long>(hash));
+	return cache_dir / name;
+}
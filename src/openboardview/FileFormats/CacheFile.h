@@ -0,0 +1,42 @@
+#pragma once
+
+#include "BRDFileBase.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "filesystem_impl.h"
+
+/*
+ * Identifies the contents of the files a board is read from without reading all of them:
+ * their total size, newest modification time and a hash of their names, sizes, times and of a
+ * few blocks sampled across each file.
+ */
+struct SourceStamp {
+	uint64_t size = 0;
+	int64_t mtime = 0;
+	uint64_t hash = 0;
+
+	bool read(const std::vector<filesystem::path> &filepaths);
+	bool operator==(const SourceStamp &other) const {
+		return size == other.size && mtime == other.mtime && hash == other.hash;
+	}
+};
+
+/*
+ * Parsed board data saved to disk so reopening a board skips decoding and parsing.
+ * The layout is flat and versioned: a header, arrays of fixed size records and a string table,
+ * with a checksum of everything after the header.
+ * Strings point straight into the buffer the file is read to.
+ */
+class CacheFile : public BRDFileBase {
+  public:
+	CacheFile(ParseBuffer &buf, const SourceStamp &stamp);
+
+	// The cache file contents for file, so it can be written once file is gone
+	static void encode(const BRDFileBase &file, const SourceStamp &stamp, std::vector<char> &image);
+	static bool write(const std::vector<char> &image, const filesystem::path &cachepath);
+	// Drops cache files unused for long, then the least recently used ones over the size cap
+	static void prune(const filesystem::path &cache_dir);
+	static filesystem::path cache_path(const filesystem::path &cache_dir, const filesystem::path &filepath);
+};
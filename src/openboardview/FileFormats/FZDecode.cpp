@@ -0,0 +1,318 @@
+#include "FZDecode.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FZ_DECODE_X86_64
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define FZ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FZ_TARGET_AVX2 // MSVC takes AVX2 intrinsics without /arch:AVX2
+#endif
+
+// RC6 decryption of .fz files, https://en.wikipedia.org/wiki/RC6
+
+// RC6 rotates by the low lg(w) bits of the amount
+static inline uint32_t rotl32(uint32_t a, uint32_t b) {
+	b &= 31;
+	return (a << b) | (a >> ((32 - b) & 31));
+}
+
+/*
+ * Decrypt an RC6 encrypted buffer using key, one byte after another.
+ * Reference implementation of fz_decode().
+ */
+void fz_decode_scalar(const uint32_t key[44], char *source, size_t size) {
+	// Along the lines of http://people.csail.mit.edu/rivest/pubs/RRSY98.pdf
+	// (page 3, 2.2)
+	int32_t logw = 5;
+	uint32_t r   = 20;
+
+	uint32_t A = 0;
+	uint32_t B = 0;
+	uint32_t C = 0;
+	uint32_t D = 0;
+
+	uint8_t currentByte;
+	uint8_t ibuf[16] = {0}; // you'll see
+
+	// RC6 algo from the paper, basically 1:1
+	for (size_t pos = 0; pos < size; ++pos) {
+		B = B + key[0];
+		D = D + key[1];
+		for (uint32_t i = 1; i < (r + 1); ++i) { // loop offset by 1
+			uint32_t t = rotl32(B * (2 * B + 1), logw);
+			uint32_t u = rotl32(D * (2 * D + 1), logw);
+			A          = rotl32(A ^ t, u) + key[2 * i];
+			C          = rotl32(C ^ u, t) + key[2 * i + 1];
+
+			uint32_t tmp = A;
+			A            = B;
+			B            = C;
+			C            = D;
+			D            = tmp;
+		}
+		A = A + key[2 * r + 2];
+		C = C + key[2 * r + 3]; // not used I guess
+
+		// rolling over the the uint8_t string
+		// buf[pos] xor A -> is our resulting byte
+		currentByte = source[pos];
+		source[pos] = ((uint8_t)(currentByte ^ (A & 0xFF)));
+		// fprintf(stdout,"%c",source[pos]);
+
+		// pushing in a stream of buf[pos] chars 'from the right'
+		// and shift whole array 8 bits to the left
+		for (uint32_t i = 0; i < 15; ++i) {
+			ibuf[i] = ibuf[i + 1];
+		}
+		ibuf[15] = currentByte;
+
+		// align 4 consequent int32s to that buffer
+		// (A, B, C, D) = (buf[0], buf[1], buf[2], buf[3])
+		// byte order?!
+		A = ibuf[0] | ibuf[1] << 8 | ibuf[2] << 16 | ibuf[3] << 24;
+		B = ibuf[4] | ibuf[5] << 8 | ibuf[6] << 16 | ibuf[7] << 24;
+		C = ibuf[8] | ibuf[9] << 8 | ibuf[10] << 16 | ibuf[11] << 24;
+		D = ibuf[12] | ibuf[13] << 8 | ibuf[14] << 16 | ibuf[15] << 24;
+	}
+}
+
+/*
+ * The RC6 input block of a position only holds the 16 ciphertext bytes preceding it (zeros before the
+ * start of the file), never previous output. So the keystream of every position can be computed
+ * independently: positions are processed kDecodeLanes at a time and the buffer is split across threads.
+ */
+static constexpr size_t kDecodeLanes      = 32;
+static constexpr size_t kDecodeMinBlocks  = (256 * 1024) / kDecodeLanes; // per thread
+static constexpr size_t kDecodeWindowSize = 16 + kDecodeLanes;
+
+static inline uint32_t load_le32(const uint8_t *p) {
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/*
+ * Keystream bytes for kDecodeLanes consecutive positions.
+ * window holds the 16 ciphertext bytes preceding the first position followed by the ciphertext of
+ * the positions themselves, lane l uses window[l..l+16) as its input block.
+ */
+using keystream_fn = void (*)(const uint32_t key[44], const uint8_t window[kDecodeWindowSize], uint8_t out[kDecodeLanes]);
+
+#ifndef FZ_DECODE_X86_64
+// Portable version, the inner loops over lanes are written to be auto-vectorized
+static void rc6_keystream_lanes(const uint32_t key[44], const uint8_t window[kDecodeWindowSize], uint8_t out[kDecodeLanes]) {
+	const uint32_t r = 20;
+	uint32_t A[kDecodeLanes], B[kDecodeLanes], C[kDecodeLanes], D[kDecodeLanes];
+	for (size_t l = 0; l < kDecodeLanes; l++) {
+		A[l] = load_le32(window + l);
+		B[l] = load_le32(window + l + 4) + key[0];
+		C[l] = load_le32(window + l + 8);
+		D[l] = load_le32(window + l + 12) + key[1];
+	}
+
+	for (uint32_t i = 1; i < (r + 1); ++i) {
+		for (size_t l = 0; l < kDecodeLanes; l++) {
+			uint32_t t = rotl32(B[l] * (2 * B[l] + 1), 5);
+			uint32_t u = rotl32(D[l] * (2 * D[l] + 1), 5);
+			uint32_t a = rotl32(A[l] ^ t, u) + key[2 * i];
+			uint32_t c = rotl32(C[l] ^ u, t) + key[2 * i + 1];
+			A[l]       = B[l];
+			B[l]       = c;
+			C[l]       = D[l];
+			D[l]       = a;
+		}
+	}
+
+	for (size_t l = 0; l < kDecodeLanes; l++) out[l] = (A[l] + key[2 * r + 2]) & 0xFF;
+}
+#else
+// The 4 words of the input blocks of the lanes, word w of lane l at words[w][l]
+static inline void load_lane_words(const uint8_t window[kDecodeWindowSize], uint32_t words[4][kDecodeLanes]) {
+	for (size_t l = 0; l < kDecodeLanes; l++) {
+		for (size_t w = 0; w < 4; w++) memcpy(&words[w][l], window + l + 4 * w, 4); // little endian
+	}
+}
+
+/*
+ * SSE2, which every x86-64 CPU has, in two halves of 4 lanes. It has neither 32 bit multiplies
+ * nor per lane shifts, both are done with the 64 bit products of even and odd lanes.
+ */
+static inline __m128i mullo32x4(__m128i a, __m128i b) {
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i rotl32x4(__m128i a, __m128i b) {
+	// 2^n through the exponent of a float, 2^31 converts to 0x80000000 which is the pattern needed
+	__m128i n    = _mm_and_si128(b, _mm_set1_epi32(31));
+	__m128i pow2 = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_add_epi32(_mm_slli_epi32(n, 23), _mm_set1_epi32(0x3f800000))));
+	// a * 2^n holds a << n in its low word and a >> (32 - n) in its high word
+	__m128i even = _mm_mul_epu32(a, pow2);
+	__m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(pow2, 32));
+	even         = _mm_or_si128(even, _mm_srli_epi64(even, 32));
+	odd          = _mm_or_si128(odd, _mm_srli_epi64(odd, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i rotl32x4_5(__m128i a) {
+	return _mm_or_si128(_mm_slli_epi32(a, 5), _mm_srli_epi32(a, 27));
+}
+
+static void rc6_keystream_lanes_sse2(const uint32_t key[44], const uint8_t window[kDecodeWindowSize], uint8_t out[kDecodeLanes]) {
+	constexpr int V = kDecodeLanes / 4;
+	const uint32_t r = 20;
+	alignas(16) uint32_t words[4][kDecodeLanes];
+	load_lane_words(window, words);
+
+	const __m128i one = _mm_set1_epi32(1);
+	__m128i A[V], B[V], C[V], D[V];
+	for (int h = 0; h < V; h++) {
+		A[h] = _mm_load_si128(reinterpret_cast<const __m128i *>(words[0] + 4 * h));
+		B[h] = _mm_add_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(words[1] + 4 * h)), _mm_set1_epi32(key[0]));
+		C[h] = _mm_load_si128(reinterpret_cast<const __m128i *>(words[2] + 4 * h));
+		D[h] = _mm_add_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(words[3] + 4 * h)), _mm_set1_epi32(key[1]));
+	}
+
+	for (uint32_t i = 1; i < (r + 1); ++i) {
+		const __m128i ka = _mm_set1_epi32(key[2 * i]), kc = _mm_set1_epi32(key[2 * i + 1]);
+		for (int h = 0; h < V; h++) {
+			__m128i t = rotl32x4_5(mullo32x4(B[h], _mm_add_epi32(_mm_add_epi32(B[h], B[h]), one)));
+			__m128i u = rotl32x4_5(mullo32x4(D[h], _mm_add_epi32(_mm_add_epi32(D[h], D[h]), one)));
+			__m128i a = _mm_add_epi32(rotl32x4(_mm_xor_si128(A[h], t), u), ka);
+			__m128i c = _mm_add_epi32(rotl32x4(_mm_xor_si128(C[h], u), t), kc);
+			A[h]      = B[h];
+			B[h]      = c;
+			C[h]      = D[h];
+			D[h]      = a;
+		}
+	}
+
+	for (int h = 0; h < V; h++) {
+		A[h] = _mm_add_epi32(A[h], _mm_set1_epi32(key[2 * r + 2]));
+		_mm_store_si128(reinterpret_cast<__m128i *>(words[0] + 4 * h), A[h]);
+	}
+	for (size_t l = 0; l < kDecodeLanes; l++) out[l] = words[0][l] & 0xFF;
+}
+
+// AVX2, built for it whatever the compiler flags and only run on CPUs that have it
+FZ_TARGET_AVX2 static inline __m256i rotl32x8(__m256i a, __m256i b) {
+	__m256i n = _mm256_and_si256(b, _mm256_set1_epi32(31));
+	return _mm256_or_si256(_mm256_sllv_epi32(a, n), _mm256_srlv_epi32(a, _mm256_sub_epi32(_mm256_set1_epi32(32), n)));
+}
+
+FZ_TARGET_AVX2 static inline __m256i rotl32x8_5(__m256i a) {
+	return _mm256_or_si256(_mm256_slli_epi32(a, 5), _mm256_srli_epi32(a, 27));
+}
+
+FZ_TARGET_AVX2 static void rc6_keystream_lanes_avx2(const uint32_t key[44], const uint8_t window[kDecodeWindowSize], uint8_t out[kDecodeLanes]) {
+	constexpr int V = kDecodeLanes / 8;
+	const uint32_t r = 20;
+	alignas(32) uint32_t words[4][kDecodeLanes];
+	load_lane_words(window, words);
+
+	const __m256i one = _mm256_set1_epi32(1);
+	__m256i A[V], B[V], C[V], D[V];
+	for (int h = 0; h < V; h++) {
+		A[h] = _mm256_load_si256(reinterpret_cast<const __m256i *>(words[0] + 8 * h));
+		B[h] = _mm256_add_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(words[1] + 8 * h)), _mm256_set1_epi32(key[0]));
+		C[h] = _mm256_load_si256(reinterpret_cast<const __m256i *>(words[2] + 8 * h));
+		D[h] = _mm256_add_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(words[3] + 8 * h)), _mm256_set1_epi32(key[1]));
+	}
+
+	for (uint32_t i = 1; i < (r + 1); ++i) {
+		const __m256i ka = _mm256_set1_epi32(key[2 * i]), kc = _mm256_set1_epi32(key[2 * i + 1]);
+		for (int h = 0; h < V; h++) {
+			__m256i t = rotl32x8_5(_mm256_mullo_epi32(B[h], _mm256_add_epi32(_mm256_add_epi32(B[h], B[h]), one)));
+			__m256i u = rotl32x8_5(_mm256_mullo_epi32(D[h], _mm256_add_epi32(_mm256_add_epi32(D[h], D[h]), one)));
+			__m256i a = _mm256_add_epi32(rotl32x8(_mm256_xor_si256(A[h], t), u), ka);
+			__m256i c = _mm256_add_epi32(rotl32x8(_mm256_xor_si256(C[h], u), t), kc);
+			A[h]      = B[h];
+			B[h]      = c;
+			C[h]      = D[h];
+			D[h]      = a;
+		}
+	}
+
+	for (int h = 0; h < V; h++) {
+		A[h] = _mm256_add_epi32(A[h], _mm256_set1_epi32(key[2 * r + 2]));
+		_mm256_store_si256(reinterpret_cast<__m256i *>(words[0] + 8 * h), A[h]);
+	}
+	for (size_t l = 0; l < kDecodeLanes; l++) out[l] = words[0][l] & 0xFF;
+}
+
+static bool cpu_has_avx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	bool osxsave = info[2] & (1 << 27);
+	if (!osxsave || (_xgetbv(0) & 6) != 6) return false; // the OS saves the YMM registers
+	__cpuidex(info, 7, 0);
+	return info[1] & (1 << 5);
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// The fastest kernel the CPU runs
+static keystream_fn select_keystream() {
+#ifdef FZ_DECODE_X86_64
+	static const keystream_fn kernel = cpu_has_avx2() ? rc6_keystream_lanes_avx2 : rc6_keystream_lanes_sse2;
+	return kernel;
+#else
+	return rc6_keystream_lanes;
+#endif
+}
+
+/*
+ * Decrypt an RC6 encrypted buffer using key
+ */
+void fz_decode(const uint32_t key[44], char *source, size_t size) {
+	uint8_t *buf = reinterpret_cast<uint8_t *>(source);
+
+	auto ranges = split_ranges((size + kDecodeLanes - 1) / kDecodeLanes, kDecodeMinBlocks);
+	auto keystream_lanes = select_keystream();
+
+	// Decryption is done in place, so save the ciphertext preceding each range before any thread overwrites it
+	std::vector<std::array<uint8_t, 16>> prefixes(ranges.size());
+	for (size_t i = 0; i < ranges.size(); i++) {
+		size_t begin = ranges[i].first * kDecodeLanes;
+		size_t n     = std::min<size_t>(begin, 16);
+		prefixes[i].fill(0);
+		memcpy(prefixes[i].data() + 16 - n, buf + begin - n, n);
+	}
+
+	parallel_for_each(ranges, [&](const index_range &range) {
+		uint8_t window[kDecodeWindowSize];
+		uint8_t keystream[kDecodeLanes];
+
+		memcpy(window, prefixes[&range - ranges.data()].data(), 16);
+
+		size_t end = std::min(range.second * kDecodeLanes, size);
+		for (size_t pos = range.first * kDecodeLanes; pos < end; pos += kDecodeLanes) {
+			if (pos % (64 * 1024) == 0 && load_cancelled()) return;
+
+			size_t n = std::min(kDecodeLanes, end - pos);
+			memcpy(window + 16, buf + pos, n);
+			if (n < kDecodeLanes) memset(window + 16 + n, 0, kDecodeLanes - n);
+
+			keystream_lanes(key, window, keystream);
+			for (size_t l = 0; l < n; l++) buf[pos + l] ^= keystream[l];
+
+			memmove(window, window + kDecodeLanes, 16);
+		}
+	});
+}
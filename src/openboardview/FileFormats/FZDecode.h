@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decrypts an RC6 encrypted .fz buffer in place with key, split across threads
+void fz_decode(const uint32_t key[44], char *source, size_t size);
+
+// The same, one byte after another, the reference fz_decode() is checked against
+void fz_decode_scalar(const uint32_t key[44], char *source, size_t size);
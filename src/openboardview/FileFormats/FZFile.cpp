@@ -1,11 +1,13 @@
 #include "FZFile.h"
+#include "FZDecode.h"
+#include "parallel.h"
 #include "utils.h"
 
 #include <algorithm>
 #include <cctype>
-#include <clocale>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <iomanip>
 #include <sstream>
 #include <unordered_map>
@@ -16,17 +18,11 @@
 
 // Looking at the paper the algo is straight forward, not sure about endianness.
 // This will put out some .bin file you would decompress using zlib.
-// constexpr uint32_t FZFile::key[44];
-uint32_t FZFile::key[44];
 
 #if __cplusplus < 201703L
 constexpr const std::array<uint32_t, 44> FZFile::key_parity;
 #endif
 
-static inline uint32_t rotl32(uint32_t a, int32_t b) {
-	return (a << b) | (a >> (32 - b));
-}
-
 std::string FZFile::fz_key_to_string(const uint32_t fzkey[44]) {
 		std::stringstream sstr;
 		for (size_t i = 0; i < 44; i += 4) {
@@ -53,65 +49,6 @@ bool FZFile::check_fz_key(const uint32_t fzkey[44]) {
 		return valid_key;
 }
 
-/*
- * Decrypt an RC6 encrypted buffer using key
- */
-void FZFile::decode(char *source, size_t size) {
-	// Along the lines of http://people.csail.mit.edu/rivest/pubs/RRSY98.pdf
-	// (page 3, 2.2)
-	int32_t logw = 5;
-	uint32_t r   = 20;
-
-	uint32_t A = 0;
-	uint32_t B = 0;
-	uint32_t C = 0;
-	uint32_t D = 0;
-
-	uint8_t currentByte;
-	uint8_t ibuf[16] = {0}; // you'll see
-
-	// RC6 algo from the paper, basically 1:1
-	for (size_t pos = 0; pos < size; ++pos) {
-		B = B + key[0];
-		D = D + key[1];
-		for (uint32_t i = 1; i < (r + 1); ++i) { // loop offset by 1
-			uint32_t t = rotl32(B * (2 * B + 1), logw);
-			uint32_t u = rotl32(D * (2 * D + 1), logw);
-			A          = rotl32(A ^ t, u) + key[2 * i];
-			C          = rotl32(C ^ u, t) + key[2 * i + 1];
-
-			uint32_t tmp = A;
-			A            = B;
-			B            = C;
-			C            = D;
-			D            = tmp;
-		}
-		A = A + key[2 * r + 2];
-		C = C + key[2 * r + 3]; // not used I guess
-
-		// rolling over the the uint8_t string
-		// buf[pos] xor A -> is our resulting byte
-		currentByte = source[pos];
-		source[pos] = ((uint8_t)(currentByte ^ (A & 0xFF)));
-		// fprintf(stdout,"%c",source[pos]);
-
-		// pushing in a stream of buf[pos] chars 'from the right'
-		// and shift whole array 8 bits to the left
-		for (uint32_t i = 0; i < 15; ++i) {
-			ibuf[i] = ibuf[i + 1];
-		}
-		ibuf[15] = currentByte;
-
-		// align 4 consequent int32s to that buffer
-		// (A, B, C, D) = (buf[0], buf[1], buf[2], buf[3])
-		// byte order?!
-		A = ibuf[0] | ibuf[1] << 8 | ibuf[2] << 16 | ibuf[3] << 24;
-		B = ibuf[4] | ibuf[5] << 8 | ibuf[6] << 16 | ibuf[7] << 24;
-		C = ibuf[8] | ibuf[9] << 8 | ibuf[10] << 16 | ibuf[11] << 24;
-		D = ibuf[12] | ibuf[13] << 8 | ibuf[14] << 16 | ibuf[15] << 24;
-	}
-}
-
 /*
  * Sets content_size to the length of the compressed content from the decoded fz
  * file
@@ -128,50 +65,82 @@ char *FZFile::split(char *file_buf, size_t buffer_size, size_t &content_size, ch
 }
 
 /*
- * Inflates the zlib compressed data from buffer
+ * Inflates the zlib compressed data from buffer and calls on_line for each line as soon as it
+ * has been inflated, so decompression and parsing overlap.
+ * A line break pair (CRLF) is a single break, like LineSplitter.
+ * Output goes to fixed size chunks that never move, lines are terminated in place and stay valid
+ * for the lifetime of the FZFile. A line crossing the end of a chunk is moved to the next one.
  */
-char *FZFile::decompress(char *file_buf, size_t buffer_size, size_t &output_size) {
-	output_size = buffer_size;
-	if (buffer_size == 0) return nullptr;
+bool FZFile::inflate_lines(char *buf, size_t buffer_size, const std::function<void(char *)> &on_line) {
+	static constexpr size_t chunk_min_size = 1024 * 1024;
 
-	char *output = (char *)calloc(output_size, sizeof(char));
+	if (buffer_size == 0) return false;
 
 	z_stream zst;
-	zst.next_in   = (Bytef *)file_buf;
+	zst.next_in   = (Bytef *)buf;
 	zst.avail_in  = buffer_size;
 	zst.total_out = 0;
 	zst.zalloc    = Z_NULL;
 	zst.zfree     = Z_NULL;
+	zst.opaque    = Z_NULL;
 
-	if (inflateInit(&zst) != Z_OK) {
-		free(output);
-		return nullptr;
-	}
+	if (inflateInit(&zst) != Z_OK) return false;
+
+	char *chunk       = nullptr;
+	size_t chunk_size = 0; // usable size, one more byte is allocated for the last terminator
+	size_t filled     = 0; // inflated bytes in chunk
+	size_t scanned    = 0; // bytes of chunk already checked for line breaks
+	size_t line_start = 0; // start of the current incomplete line
+	bool after_break  = false;
 
 	int ret;
 	do {
-		// If our output buffer is too small
-		if (zst.total_out >= output_size) {
-			// Increase size of output buffer
-			char *buf = (char *)calloc(output_size + buffer_size / 2, sizeof(char));
-			memcpy(buf, output, output_size);
-			output_size += buffer_size / 2;
-			free(output);
-			output = buf;
+		if (filled == chunk_size) {
+			size_t pending = filled - line_start;
+			size_t size    = std::max(chunk_min_size, 2 * pending);
+			auto next      = std::unique_ptr<char[]>(new char[size + 1]());
+			if (pending > 0) memcpy(next.get(), chunk + line_start, pending);
+			chunk      = next.get();
+			chunk_size = size;
+			filled = scanned = pending;
+			line_start       = 0;
+			inflated_chunks.push_back(std::move(next));
 		}
 
-		zst.next_out  = (Bytef *)(output + zst.total_out);
-		zst.avail_out = output_size - zst.total_out;
-	} while ((ret = inflate(&zst, Z_SYNC_FLUSH)) == Z_OK);
+		zst.next_out  = (Bytef *)(chunk + filled);
+		zst.avail_out = chunk_size - filled;
+		ret           = inflate(&zst, Z_NO_FLUSH);
+		filled        = chunk_size - zst.avail_out;
+
+		for (; scanned < filled; scanned++) {
+			char c = chunk[scanned];
+			if (c != '\n' && c != '\r') {
+				after_break = false;
+			} else if (after_break) {
+				// second half of a CRLF pair
+				line_start  = scanned + 1;
+				after_break = false;
+			} else {
+				chunk[scanned] = 0;
+				on_line(chunk + line_start);
+				line_start  = scanned + 1;
+				after_break = true;
+			}
+		}
+	} while (ret == Z_OK && !load_cancelled());
 
-	if (ret != Z_STREAM_END) printf("Error %d: %s\n", ret, zst.msg);
+	if (ret != Z_STREAM_END && ret != Z_OK) printf("Error %d: %s\n", ret, zst.msg);
 
-	if (inflateEnd(&zst) != Z_OK) {
-		free(output);
-		return nullptr;
+	// Last line without a line break
+	if (line_start < filled) {
+		chunk[filled] = 0;
+		on_line(chunk + line_start);
 	}
 
-	return output;
+	bool inflated = zst.total_out > 0;
+	if (inflateEnd(&zst) != Z_OK) return false;
+
+	return inflated;
 }
 
 /*
@@ -206,11 +175,9 @@ void FZFile::update_counts() {
 	num_nails  = nails.size();
 }
 
-FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
+FZFile::FZFile(ParseBuffer &buf, uint32_t fzkey[44]) {
 	auto buffer_size = buf.size();
-	char *saved_locale;
 	float multiplier = 1.0f;
-	saved_locale     = setlocale(LC_NUMERIC, "C"); // Use '.' as delimiter for strtod
 
 	if (!check_fz_key(fzkey)) {
 		valid = false;
@@ -222,25 +189,15 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 
 	memcpy(key, fzkey, sizeof(key));
 
-
 	ENSURE_OR_FAIL(buffer_size > 4, error_msg, return);
-	size_t file_buf_size = 3 * (1 + buffer_size);
-	file_buf             = (char *)calloc(1, file_buf_size);
-	ENSURE_OR_FAIL(file_buf != nullptr, error_msg, return);
-
-	std::copy(buf.begin(), buf.end(), file_buf);
-	file_buf[buffer_size] = 0;
-	// This is for fixing degenerate utf8
-	char *arena     = &file_buf[buffer_size + 1];
-	char *arena_end = file_buf + file_buf_size - 1;
-	*arena_end      = 0;
+	file_buf = adopt_buffer(buf);
 
 	/*
 	 * Some non-encrypted, but zip-encoded files are popping up now and then.
 	 *
 	 * Thanks to piernov for noticing the starting byte sequence
 	 *
-	 * Attempt to decode using the decode() call and subsequently
+	 * Attempt to decode using the fz_decode() call and subsequently
 	 * split the file to get the content.  If that fails, then try again
 	 * without decoding.
 	 */
@@ -254,7 +211,7 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 		 *
 		 * 1 in ~2^16 chance of a false hit.
 		 */
-		FZFile::decode(file_buf, buffer_size); // RC6 decryption
+		fz_decode(key, file_buf, buffer_size); // RC6 decryption
 		                                       // fprintf(stderr,"FZFile:Decoded\n");
 	}
 
@@ -273,36 +230,22 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 
 	ENSURE_OR_FAIL(content != nullptr, error_msg, return);
 	ENSURE_OR_FAIL(content_size > 0, error_msg, return);
-	content = FZFile::decompress(content, content_size, content_size); // decompress zlib content data
-	ENSURE_OR_FAIL(content != nullptr, error_msg, return);
-	ENSURE_OR_FAIL(content_size > 0, error_msg, return);
-
 	ENSURE_OR_FAIL(content != descr, error_msg, return);
 	ENSURE_OR_FAIL(descr_size > 0, error_msg, return);
-	descr = FZFile::decompress(descr, descr_size, descr_size);
-	ENSURE_OR_FAIL(descr != nullptr, error_msg, return);
-	ENSURE_OR_FAIL(descr_size > 0, error_msg, return);
 
 	int current_block = 0;
 	std::unordered_map<std::string, int> parts_id; // map between part name and part number
 
-	std::vector<char *> lines_content;
-	stringfile(content, lines_content);
-
-	std::vector<char *> lines_descr;
-	stringfile(descr, lines_descr);
-
-	// For some reason, some boards have COMMAs as decimal separators. Will wonders ever cease ( I realise this is a regional thing
-	// )?
-	std::replace(content, content + content_size, ',', '.');
-
 	// Parse the content part (parts, pins, nails)
-
-	for (char *line : lines_content) {
+	auto parse_content_line = [&](char *line) {
 		//	fprintf(stdout,"%s\n", line);
 
 		while (isspace((uint8_t)*line)) line++;
-		if (!line[0]) continue;
+		if (!line[0]) return;
+
+		// For some reason, some boards have COMMAs as decimal separators. Will wonders ever cease ( I realise this is a regional
+		// thing )?
+		std::replace(line, line + strlen(line), ',', '.');
 
 		char *p = line;
 		char *s;
@@ -334,9 +277,9 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 			} else {
 				current_block = -1;
 			}
-			continue;
+			return;
 		} else if (line[0] != 'S') // Unknown line type
-			continue;              // jump to next line
+			return;                // jump to next line
 		else
 			p += 2; // Skip "S!"
 
@@ -409,20 +352,21 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 			case 7: { // Unknown
 			} break;
 		}
-	}
+	};
 
 	// Parse the descr part (parts info)
 	// Note: Discard first 2 lines (board description, currently unused and table columns name)
-	for (size_t i = 2; i < lines_descr.size(); ++i) {
-		char *line = lines_descr[i];
+	size_t descr_line = 0;
+	auto parse_descr_line = [&](char *line) {
+		if (descr_line++ < 2) return;
 
 		while (isspace((uint8_t)*line)) line++;
-		if (!line[0]) continue;
+		if (!line[0]) return;
 
 		char *p = line;
 		char *s;
 
-		if (line[0] == 's') continue; // PARTNUMBER starting with 's' seems unused
+		if (line[0] == 's') return; // PARTNUMBER starting with 's' seems unused
 
 		FZPartDesc pdesc;
 		pdesc.partno      = READ_DESCR_STR();
@@ -431,7 +375,10 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 		pdesc.locations   = split_string(READ_DESCR_STR());
 		pdesc.partno2     = READ_DESCR_STR();
 		partsDesc.push_back(pdesc);
-	}
+	};
+
+	ENSURE_OR_FAIL(FZFile::inflate_lines(content, content_size, parse_content_line), error_msg, return); // decompress zlib content data
+	ENSURE_OR_FAIL(FZFile::inflate_lines(descr, descr_size, parse_descr_line), error_msg, return);
 
 	for (auto &pdesc : partsDesc) {
 		for (auto &partname : pdesc.locations) {
@@ -452,11 +399,15 @@ FZFile::FZFile(std::vector<char> &buf, uint32_t fzkey[44]) {
 
 	update_counts();
 
-	setlocale(LC_NUMERIC, saved_locale); // Restore locale
-
 	valid = current_block != 0;
 
 	if (!valid) {
 		error_msg += "FZ Key:\n" + fz_key_to_string(key);
 	}
 }
+
+void FZFile::release_elements() {
+	BRDFileBase::release_elements();
+	std::vector<FZPartDesc>().swap(partsDesc);
+	std::vector<std::unique_ptr<char[]>>().swap(inflated_chunks);
+}
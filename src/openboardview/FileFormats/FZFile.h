@@ -3,6 +3,8 @@
 #include "BRDFileBase.h"
 #include <array>
 #include <cstdint>
+#include <functional>
+#include <memory>
 
 #undef READ_INT
 #undef READ_UINT
@@ -11,23 +13,23 @@
 /* '!' is the delimiter for the content part */
 #define READ_INT                       \
 	[&]() {                            \
-		int value = strtol(p, &p, 10); \
+		int value = parse_long(p, &p); \
 		if (*p == '!') p++;            \
 		return value;                  \
 	}
 // Warning: read as int then cast to uint if positive
 #define READ_UINT                                \
 	[&]() {                                      \
-		int value = strtol(p, &p, 10);           \
+		int value = parse_long(p, &p);           \
 		if (*p == '!') p++;                      \
 		ENSURE(value >= 0, error_msg);           \
 		return static_cast<unsigned int>(value); \
 	}
-#define READ_DOUBLE                 \
-	[&]() {                         \
-		double val = strtod(p, &p); \
-		if (*p == '!') p++;         \
-		return val;                 \
+#define READ_DOUBLE                       \
+	[&]() {                               \
+		double val = parse_double(p, &p); \
+		if (*p == '!') p++;               \
+		return val;                       \
 	}
 #define READ_STR                                    \
 	[&]() {                                         \
@@ -36,13 +38,13 @@
 		while ((*p) && (*p != '!')) ++p;            \
 		*p = 0;                                     \
 		p++;                                        \
-		return fix_to_utf8(s, &arena, arena_end);   \
+		return fix_to_utf8(s, arena);               \
 	}
 
 /* '\t' is the delimiter for the descr part */
 #define READ_DESCR_UINT                          \
 	[&]() {                                      \
-		int value = strtol(p, &p, 10);           \
+		int value = parse_long(p, &p);           \
 		if (*p == '\t') p++;                     \
 		ENSURE(value >= 0, error_msg);           \
 		return static_cast<unsigned int>(value); \
@@ -54,7 +56,7 @@
 		while ((*p) && (*p != '\t')) ++p;                           \
 		*p = 0;                                                     \
 		p++;                                                        \
-		return fix_to_utf8(s, &arena, arena_end);                   \
+		return fix_to_utf8(s, arena);                               \
 	}
 
 struct FZPartDesc {
@@ -67,26 +69,27 @@ struct FZPartDesc {
 
 class FZFile : public BRDFileBase {
   public:
-	FZFile(std::vector<char> &buf, uint32_t fzkey[44]);
+	FZFile(ParseBuffer &buf, uint32_t fzkey[44]);
 
 	void SetKey(char *keytext);
 
+	void release_elements() override;
+
   private:
 	std::vector<FZPartDesc> partsDesc;
+	std::vector<std::unique_ptr<char[]>> inflated_chunks; // parsed strings point into these
 
 	static std::string fz_key_to_string(const uint32_t fzkey[44]);
 	static bool check_fz_key(const uint32_t fzkey[44]);
 
-	static void decode(char *source, size_t size);
 	static char *split(char *file_buf, size_t buffer_size, size_t &content_size, char *&descr, size_t &descr_size);
-	static char *decompress(char *file_buf, size_t buffer_size, size_t &output_size);
+	bool inflate_lines(char *buf, size_t buffer_size, const std::function<void(char *)> &on_line);
 	void gen_outline();
 	void update_counts();
 
 	// Put your key here.
 	// uint32_t keylength = 2*r + 4; // i.e. buf[0..2r+3]
-	// static constexpr uint32_t key[44] = {0};
-	// static uint32_t key[44] = {0};
-	static uint32_t key[44];
+	// Per file, loads on different threads may decode at the same time
+	uint32_t key[44] = {0};
 	static constexpr const std::array<uint32_t, 44> key_parity = {{0, 1, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1}};
 };
@@ -0,0 +1,173 @@
+#include "FormatRegistry.h"
+
+#include "ADFile.h"
+#include "ASCFile.h"
+#include "BDVFile.h"
+#include "BRD2File.h"
+#include "BRDAllegroFile.h"
+#include "BRDFile.h"
+#include "BVR3File.h"
+#include "BVRFile.h"
+#include "CADFile.h"
+#include "CSTFile.h"
+#include "FZFile.h"
+#include "GenCADFile.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+bool head_contains(const char *head, size_t size, const char *str) {
+	const char *end = head + size;
+	return std::search(head, end, str, str + strlen(str)) != end;
+}
+
+// str at the very start of the file, after leading whitespace
+bool head_starts_with(const char *head, size_t size, const char *str) {
+	size_t i = 0;
+	while (i < size && isspace((uint8_t)head[i])) i++;
+	size_t len = strlen(str);
+	return size - i >= len && !memcmp(head + i, str, len);
+}
+
+template <typename T>
+BRDFileBase *load_file(ParseBuffer &buf, const FormatContext &) {
+	return new T(buf);
+}
+
+} // namespace
+
+const std::vector<FileFormat> &file_formats() {
+	static const std::vector<FileFormat> formats = {
+	    {"FZ",
+	     {".fz"},
+	     nullptr,
+	     nullptr,
+	     [](ParseBuffer &buf, const FormatContext &context) -> BRDFileBase * {
+		     uint32_t fzkey[44];
+		     std::copy(context.fzkey.begin(), context.fzkey.end(), fzkey);
+		     return new FZFile(buf, fzkey);
+	     }},
+	    {"ASC",
+	     {".asc", ".bom"},
+	     nullptr,
+	     nullptr,
+	     [](ParseBuffer &buf, const FormatContext &context) -> BRDFileBase * { return new ASCFile(buf, context.filepath); },
+	     ASCFile::input_files},
+	    {"CST", {".cst"}, nullptr, nullptr, load_file<CSTFile>},
+	    {"BRD Allegro",
+	     {},
+	     [](const char *head, size_t size, bool) {
+		     // "all" or "vie" + version number at offset 0xf8
+		     return size >= 0xfb && (!memcmp(head + 0xf8, "all", 3) || !memcmp(head + 0xf8, "vie", 3));
+	     },
+	     BRDAllegroFile::verifyFormat,
+	     load_file<BRDAllegroFile>},
+	    {"BRD",
+	     {},
+	     [](const char *head, size_t size, bool) {
+		     static const uint8_t encoded_header[] = {0x23, 0xe2, 0x63, 0x28};
+		     return (size >= 4 && !memcmp(head, encoded_header, 4)) ||
+		            (head_contains(head, size, "str_length:") && head_contains(head, size, "var_data:"));
+	     },
+	     BRDFile::verifyFormat,
+	     load_file<BRDFile>},
+	    {"BRD2",
+	     {},
+	     [](const char *head, size_t size, bool) {
+		     return head_starts_with(head, size, "BRDOUT:") && head_contains(head, size, "NETS:");
+	     },
+	     BRD2File::verifyFormat,
+	     load_file<BRD2File>},
+	    {"BDV",
+	     {},
+	     [](const char *head, size_t size, bool) {
+		     return head_contains(head, size, "dd:1.3?,r?-=bb") ||
+		            (head_starts_with(head, size, "<<format.asc>>") && head_contains(head, size, "<<pins.asc>>"));
+	     },
+	     BDVFile::verifyFormat,
+	     load_file<BDVFile>},
+	    {"BVR",
+	     {},
+	     [](const char *head, size_t size, bool) { return head_contains(head, size, "BVRAW_FORMAT_1"); },
+	     BVRFile::verifyFormat,
+	     load_file<BVRFile>},
+	    {"BVR3",
+	     {},
+	     [](const char *head, size_t size, bool) { return head_contains(head, size, "BVRAW_FORMAT_3"); },
+	     BVR3File::verifyFormat,
+	     load_file<BVR3File>},
+	    {"CAD",
+	     {},
+	     [](const char *head, size_t size, bool) {
+		     return head_contains(head, size, "###Panel Added") && head_contains(head, size, "C_PIN");
+	     },
+	     CADFile::verifyFormat,
+	     load_file<CADFile>},
+	    {"GenCAD",
+	     {},
+	     [](const char *head, size_t size, bool) {
+		     return head_contains(head, size, "GENCAD") &&
+		            (head_contains(head, size, "$BOARD") || head_contains(head, size, "$PADS"));
+	     },
+	     GenCADFile::verifyFormat,
+	     [](ParseBuffer &buf, const FormatContext &) -> BRDFileBase * { return new GenCADFile(buf); }},
+	    {"AD",
+	     {},
+	     [](const char *head, size_t size, bool whole) {
+		     // "Binary" anywhere in the file rules it out, only a header holding the whole file can tell
+		     return whole && head_contains(head, size, "|KIND=Protel_Advanced_PCB") && !head_contains(head, size, "Binary");
+	     },
+	     ADFile::verifyFormat,
+	     load_file<ADFile>},
+	};
+	return formats;
+}
+
+/*
+ * Header detectors only see the first kHeaderSize bytes, so a match costs nothing on big files.
+ * The full-buffer probes each scan the whole file, they are only tried when no header matched.
+ * A detector only matches when the header shows all its probe checks, a file the header can't
+ * tell about is left to the probes in rank order.
+ */
+const FileFormat *detect_format(const ParseBuffer &buf, const filesystem::path &filepath) {
+	const auto &formats = file_formats();
+
+	for (auto &format : formats)
+		for (auto extension : format.extensions)
+			if (check_fileext(filepath, extension)) return &format;
+
+	size_t head_size = std::min(buf.size(), kHeaderSize);
+	for (auto &format : formats)
+		if (format.detect && format.detect(buf.data(), head_size, head_size == buf.size())) return &format;
+
+	for (auto &format : formats)
+		if (format.probe && format.probe(buf)) return &format;
+
+	return nullptr;
+}
+
+// Only formats recognised by their extension read other files
+std::vector<filesystem::path> input_files(const filesystem::path &filepath) {
+	std::vector<filesystem::path> files = {filepath};
+	for (auto &format : file_formats())
+		for (auto extension : format.extensions)
+			if (check_fileext(filepath, extension)) {
+				if (format.inputs)
+					for (auto &input : format.inputs(filepath))
+						if (input != filepath) files.push_back(input);
+				return files;
+			}
+	return files;
+}
+
+std::unique_ptr<BRDFileBase> load_board_file(ParseBuffer &buf, const FormatContext &context, std::string &error_msg) {
+	const FileFormat *format = detect_format(buf, context.filepath);
+	if (!format) {
+		error_msg = "Unrecognized file format.";
+		return nullptr;
+	}
+	return std::unique_ptr<BRDFileBase>(format->load(buf, context));
+}
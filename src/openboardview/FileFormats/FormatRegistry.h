@@ -0,0 +1,44 @@
+#pragma once
+
+#include "BRDFileBase.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "filesystem_impl.h"
+
+// What some loaders need besides the file contents
+struct FormatContext {
+	filesystem::path filepath;
+	std::array<uint32_t, 44> fzkey{};
+};
+
+/*
+ * A supported board format. Formats are recognised cheapest first:
+ * by file extension for formats without a signature, then by a detector that only looks at the
+ * first kHeaderSize bytes, and only when none of those match by the full-buffer probes in rank order.
+ */
+struct FileFormat {
+	const char *name;
+	std::vector<const char *> extensions;               // formats only recognised by their extension
+	bool (*detect)(const char *head, size_t size, bool whole); // header detector, whole if head is the entire file
+	bool (*probe)(const ParseBuffer &buf);              // full-buffer fallback, nullptr if none
+	BRDFileBase *(*load)(ParseBuffer &buf, const FormatContext &context);
+	std::vector<filesystem::path> (*inputs)(const filesystem::path &filepath) = nullptr; // files read besides filepath
+};
+
+static constexpr size_t kHeaderSize = 8192;
+
+// All formats in rank order
+const std::vector<FileFormat> &file_formats();
+
+const FileFormat *detect_format(const ParseBuffer &buf, const filesystem::path &filepath);
+
+// Every file the board at filepath is read from, filepath first
+std::vector<filesystem::path> input_files(const filesystem::path &filepath);
+
+// Detects the format of buf and parses it, returns nullptr and sets error_msg if the format is unknown
+std::unique_ptr<BRDFileBase> load_board_file(ParseBuffer &buf, const FormatContext &context, std::string &error_msg);
@@ -12,15 +12,15 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-bool GenCADFile::verifyFormat(const std::vector<char> &buf) {
+bool GenCADFile::verifyFormat(const ParseBuffer &buf) {
 	return find_str_in_buf("GENCAD", buf) && (find_str_in_buf("$BOARD", buf) || find_str_in_buf("$PADS", buf));
 }
 
-GenCADFile::GenCADFile(const std::vector<char> &buf) {
+GenCADFile::GenCADFile(const ParseBuffer &buf) {
 	valid = parse_file(buf);
 }
 
-bool GenCADFile::parse_file(const std::vector<char> &buf) {
+bool GenCADFile::parse_file(const ParseBuffer &buf) {
 	bool ret = false;
 #define X(CVAR, NAME) mpc_parser_t *CVAR = mpc_new((NAME));
 	X_MACRO_PARSE_VARS
@@ -180,7 +180,7 @@ bool GenCADFile::parse_components() {
 			mpc_ast_t *rotation_ast         = mpc_ast_get_child(component_ast, "rotation|>");
 			mpc_ast_t *rotation_value_ast   = mpc_ast_get_child(rotation_ast, "rot|number|regex");
 			if (rotation_ast && rotation_value_ast) {
-				component_rotation_angle = atof(rotation_value_ast->contents);
+				component_rotation_angle = parse_double(rotation_value_ast->contents);
 			}
 
 			mpc_ast_t *layer_ast = mpc_ast_get_child(component_ast, "named_layer|>");
@@ -382,7 +382,7 @@ bool GenCADFile::parse_dimension_units(mpc_ast_t *header_ast) {
 			}
 
 			if (m_dimension != INVALID) {
-				m_dimension_unit = atoi(unit->children[2]->contents);
+				m_dimension_unit = parse_long(unit->children[2]->contents);
 				return true;
 			}
 		}
@@ -417,10 +417,10 @@ bool GenCADFile::parse_board_outline(mpc_ast_t *board_ast) {
 				if (!x_ast || !y_ast || !w_ast || !h_ast) continue;
 
 				BRDPoint p1{}, p2{}, p3{}, p4{};
-				p1.x = board_unit_to_brd_coordinate(atof(x_ast->contents));
-				p1.y = board_unit_to_brd_coordinate(atof(y_ast->contents));
-				int h = board_unit_to_brd_coordinate(atof(h_ast->contents));
-				int w = board_unit_to_brd_coordinate(atof(w_ast->contents));
+				p1.x = board_unit_to_brd_coordinate(parse_double(x_ast->contents));
+				p1.y = board_unit_to_brd_coordinate(parse_double(y_ast->contents));
+				int h = board_unit_to_brd_coordinate(parse_double(h_ast->contents));
+				int w = board_unit_to_brd_coordinate(parse_double(w_ast->contents));
 
 				p2.x = p1.x;
 				p2.y = p1.y + h;
@@ -475,8 +475,8 @@ std::vector<std::pair<BRDPoint, BRDPoint>> GenCADFile::arc_to_segments_from_ast(
 
 bool GenCADFile::x_y_ref_to_brd_point(mpc_ast_t *x_y_ref, BRDPoint *point) {
 	if (x_y_ref->children_num == 3) {
-		point->x = board_unit_to_brd_coordinate(strtod(x_y_ref->children[0]->contents, nullptr));
-		point->y = board_unit_to_brd_coordinate(strtod(x_y_ref->children[2]->contents, nullptr));
+		point->x = board_unit_to_brd_coordinate(parse_double(x_y_ref->children[0]->contents));
+		point->y = board_unit_to_brd_coordinate(parse_double(x_y_ref->children[2]->contents));
 		return true;
 	}
 	return false;
@@ -593,7 +593,7 @@ char *GenCADFile::get_stringtoend_child(mpc_ast_t *parent, const char *name) {
 bool GenCADFile::is_padstack_drilled(mpc_ast_t *padstack_ast) {
 	mpc_ast_t *drill_size_ast = mpc_ast_get_child(padstack_ast, "drill_size|number|regex");
 	if (drill_size_ast)
-		return atof(drill_size_ast->contents) != 0.0;
+		return parse_double(drill_size_ast->contents) != 0.0;
 	return false;
 }
 
@@ -705,7 +705,7 @@ double GenCADFile::get_pad_radius(mpc_ast_t *pad_ast) {
 			if (circle_ref_ast) {
 				auto radius_ast = mpc_ast_get_child(circle_ref_ast, "radius|number|regex");
 				if (radius_ast) {
-					auto radius = atoi(radius_ast->contents);
+					int radius = parse_long(radius_ast->contents);
 					if (-radius < min_x) min_x = -radius;
 					if (radius > max_x) max_x = radius;
 					if (-radius < min_y) min_y = -radius;
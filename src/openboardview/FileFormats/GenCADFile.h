@@ -20,9 +20,9 @@ enum ParseVarsCounterEnum {
 
 class GenCADFile : public BRDFileBase {
   public:
-	static bool verifyFormat(const std::vector<char> &buf);
+	static bool verifyFormat(const ParseBuffer &buf);
 
-	GenCADFile(const std::vector<char> &buf);
+	GenCADFile(const ParseBuffer &buf);
 
 	enum Dimension {
 		INCH,   // Inches.
@@ -38,7 +38,7 @@ class GenCADFile : public BRDFileBase {
   private:
 	enum Dimension m_dimension = INCH;
 	int m_dimension_unit       = 0;
-	bool parse_file(const std::vector<char> &buf);
+	bool parse_file(const ParseBuffer &buf);
 
 	bool parse_dimension_units(mpc_ast_t *header_ast);
 	bool parse_board_outline(mpc_ast_t *board_ast);
@@ -0,0 +1,36 @@
+#include "NumberParser.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#if defined(__cpp_lib_to_chars) || (defined(_MSC_VER) && _MSC_VER >= 1924)
+#define HAVE_FLOAT_FROM_CHARS
+#endif
+
+namespace number_parser {
+
+double parse_slow(const char *begin, const char *end) {
+#ifdef HAVE_FLOAT_FROM_CHARS
+	double value = 0.0;
+	std::from_chars(begin, end, value);
+	return value;
+#else
+	// No floating point from_chars, accumulate in extended precision instead
+	long double mantissa = 0.0L;
+	long exponent        = 0;
+	const char *p        = begin;
+	for (; p < end && *p >= '0' && *p <= '9'; p++) mantissa = mantissa * 10 + (*p - '0');
+	if (p < end && *p == '.')
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+			mantissa = mantissa * 10 + (*p - '0');
+			exponent--;
+		}
+	if (p < end && (*p == 'e' || *p == 'E')) exponent += std::strtol(p + 1, nullptr, 10);
+	return static_cast<double>(mantissa * std::pow(10.0L, static_cast<long double>(exponent)));
+#endif
+}
+
+} // namespace number_parser
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cctype>
+#include <climits>
+#include <cstdint>
+
+/*
+ * Locale independent replacements for strtol()/strtod(), '.' is always the decimal separator.
+ * They take and return the end pointer the same way, including leading whitespace skipping and
+ * end = s when there is no number, so the READ_* macros and loaders use them as drop-in.
+ * Neither allocates nor touches global state, loaders can run concurrently.
+ */
+
+namespace number_parser {
+
+// Exactly representable powers of ten, mantissa * or / these is correctly rounded
+static constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Correctly rounded conversion of an unsigned decimal in [begin, end)
+double parse_slow(const char *begin, const char *end);
+
+} // namespace number_parser
+
+inline long parse_long(const char *s, char **end = nullptr) {
+	const char *p = s;
+	while (isspace((uint8_t)*p)) p++;
+
+	bool negative = *p == '-';
+	if (*p == '-' || *p == '+') p++;
+
+	const char *digits = p;
+	uint64_t value     = 0;
+	bool overflow      = false;
+	for (; *p >= '0' && *p <= '9'; p++) {
+		if (value > (uint64_t(LONG_MAX) + 1 - (*p - '0')) / 10) overflow = true;
+		if (!overflow) value = value * 10 + (*p - '0');
+	}
+
+	if (p == digits) {
+		if (end) *end = const_cast<char *>(s);
+		return 0;
+	}
+	if (end) *end = const_cast<char *>(p);
+
+	// Saturate like strtol
+	if (overflow || value > uint64_t(LONG_MAX) + negative) return negative ? LONG_MIN : LONG_MAX;
+	return negative ? static_cast<long>(0 - value) : static_cast<long>(value);
+}
+
+/*
+ * Decimal digits, an optional fraction and exponent. Up to 19 significant digits and exponents
+ * within +-22 are converted exactly with a single multiplication or division, as board files
+ * almost only contain short decimals. Anything longer goes through the slow path.
+ */
+inline double parse_double(const char *s, char **end = nullptr) {
+	const char *p = s;
+	while (isspace((uint8_t)*p)) p++;
+
+	bool negative = *p == '-';
+	if (*p == '-' || *p == '+') p++;
+
+	const char *begin = p;
+	uint64_t mantissa = 0;
+	int digits        = 0; // significant digits in mantissa
+	int exponent      = 0;
+	bool truncated    = false;
+	bool any          = false;
+
+	for (; *p >= '0' && *p <= '9'; p++) {
+		any = true;
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa) digits++;
+		} else {
+			exponent++;
+			truncated = true;
+		}
+	}
+	if (*p == '.') {
+		p++;
+		for (; *p >= '0' && *p <= '9'; p++) {
+			any = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa) digits++;
+				exponent--;
+			} else {
+				truncated = true;
+			}
+		}
+	}
+
+	if (!any) {
+		if (end) *end = const_cast<char *>(s);
+		return 0.0;
+	}
+
+	if (*p == 'e' || *p == 'E') {
+		const char *e = p + 1;
+		bool eneg     = *e == '-';
+		if (*e == '-' || *e == '+') e++;
+		if (*e >= '0' && *e <= '9') {
+			int evalue = 0;
+			for (; *e >= '0' && *e <= '9'; e++)
+				if (evalue < 10000) evalue = evalue * 10 + (*e - '0');
+			exponent += eneg ? -evalue : evalue;
+			p = e;
+		}
+	}
+	if (end) *end = const_cast<char *>(p);
+
+	double value;
+	if (!truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+		value = static_cast<double>(mantissa);
+		value = exponent < 0 ? value / number_parser::kPow10[-exponent] : value * number_parser::kPow10[exponent];
+	} else {
+		value = number_parser::parse_slow(begin, p);
+	}
+	return negative ? -value : value;
+}
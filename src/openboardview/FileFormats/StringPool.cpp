@@ -0,0 +1,78 @@
+#include "StringPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+// FNV-1a, names are short
+uint32_t StringPool::hash(std::string_view s) {
+	uint32_t h = 2166136261u;
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// Slot holding s, or the empty slot where it would go
+size_t StringPool::slot_of(std::string_view s, uint32_t h) const {
+	size_t mask = slots.size() - 1;
+	for (size_t i = h & mask;; i = (i + 1) & mask) {
+		Id id = slots[i];
+		if (id == kNone || (hashes[id] == h && strings[id] == s)) return i;
+	}
+}
+
+void StringPool::rehash(size_t slot_count) {
+	slots.assign(slot_count, kNone);
+	size_t mask = slot_count - 1;
+	for (Id id = 0; id < strings.size(); id++) {
+		size_t i = hashes[id] & mask;
+		while (slots[i] != kNone) i = (i + 1) & mask;
+		slots[i] = id;
+	}
+}
+
+void StringPool::reserve(size_t count) {
+	strings.reserve(count);
+	hashes.reserve(count);
+	size_t slot_count = 16;
+	while (slot_count < count * 2) slot_count *= 2;
+	if (slot_count > slots.size()) rehash(slot_count);
+}
+
+const char *StringPool::store(std::string_view s) {
+	static constexpr size_t block_size = 64 * 1024;
+
+	size_t size = s.size() + 1;
+	if (static_cast<size_t>(end - pos) < size) {
+		size_t n = std::max(block_size, size);
+		blocks.emplace_back(new char[n]);
+		pos = blocks.back().get();
+		end = pos + n;
+	}
+	char *p = pos;
+	memcpy(p, s.data(), s.size());
+	p[s.size()] = 0;
+	pos += size;
+	return p;
+}
+
+StringPool::Id StringPool::intern(std::string_view s) {
+	// Keep the table at most half full
+	if (slots.size() < (strings.size() + 1) * 2) rehash(std::max<size_t>(16, slots.size() * 2));
+
+	uint32_t h  = hash(s);
+	size_t slot = slot_of(s, h);
+	if (slots[slot] != kNone) return slots[slot];
+
+	Id id = strings.size();
+	strings.emplace_back(store(s), s.size());
+	hashes.push_back(h);
+	slots[slot] = id;
+	return id;
+}
+
+StringPool::Id StringPool::find(std::string_view s) const {
+	if (slots.empty()) return kNone;
+	return slots[slot_of(s, hash(s))];
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+ * Interns names: each distinct string is copied once into the pool's arena and numbered, so equal
+ * names share one copy and compare by id. Ids are dense, starting at 0, and can index vectors.
+ * Lookups hash the string_view once and probe an open addressing table, nothing is allocated
+ * for strings already in the pool. Strings and ids stay valid for the lifetime of the pool.
+ */
+class StringPool {
+  public:
+	using Id                  = uint32_t;
+	static constexpr Id kNone = UINT32_MAX;
+
+	// Id of s, adding it to the pool if needed
+	Id intern(std::string_view s);
+
+	// Id of s, kNone if it isn't in the pool
+	Id find(std::string_view s) const;
+
+	// NUL-terminated
+	const char *c_str(Id id) const {
+		return strings[id].data();
+	}
+	std::string_view view(Id id) const {
+		return strings[id];
+	}
+	size_t size() const {
+		return strings.size();
+	}
+
+	void reserve(size_t count);
+
+  private:
+	static uint32_t hash(std::string_view s);
+	size_t slot_of(std::string_view s, uint32_t h) const;
+	void rehash(size_t slot_count);
+	const char *store(std::string_view s);
+
+	std::vector<std::string_view> strings; // by id
+	std::vector<uint32_t> hashes;          // by id, so growing doesn't rehash the strings
+	std::vector<Id> slots;                 // power of two size, kNone when empty
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	char *pos = nullptr;
+	char *end = nullptr;
+};
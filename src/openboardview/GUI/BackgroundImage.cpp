@@ -134,6 +134,10 @@ void BackgroundImage::render(ImDrawList &draw, const ImVec2 &p_min, const ImVec2
 	selectedImage().render(draw, p_min, p_max, rotation);
 }
 
+bool BackgroundImage::shown() const {
+	return enabled && selectedImage().texture;
+}
+
 float BackgroundImage::x0() const {
 	return selectedImage().x0();
 }
@@ -43,6 +43,7 @@ public:
 	void writeToConfig(const filesystem::path &filepath);
 	std::string reload();
 	void render(ImDrawList &draw, const ImVec2 &p_min, const ImVec2 &p_max, int rotation);
+	bool shown() const; // whether render() draws an image
 
 	bool enabled = true;
 
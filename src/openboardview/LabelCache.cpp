@@ -0,0 +1,168 @@
+#include "LabelCache.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+void LabelCache::reset(Board &board) {
+	pins.assign(board.Pins().size(), PinLabel{});
+	parts.assign(board.Components().size(), PartLabel{});
+	net_values.assign(board.Nets().size(), nullptr);
+	net_generations.assign(board.Nets().size(), 0);
+	generation++;
+}
+
+void LabelCache::update(ImFont *font, Pin::EValue value, bool infer, bool part_type) {
+	if (font == this->font && font && font->FontSize == font_size && value == this->value && infer == this->infer &&
+	    part_type == this->part_type)
+		return;
+
+	if (font != this->font || (font && font->FontSize != font_size)) sides.clear();
+	this->font      = font;
+	font_size       = font ? font->FontSize : 0.0f;
+	this->value     = value;
+	this->infer     = infer;
+	this->part_type = part_type;
+	generation++;
+}
+
+void LabelCache::invalidate() {
+	generation++;
+}
+
+ImVec2 LabelCache::measure(std::string_view text) const {
+	if (!font) return ImVec2(0.0f, 0.0f);
+	return font->CalcTextSizeA(1.0f, FLT_MAX, 0.0f, text.data(), text.data() + text.size());
+}
+
+const Pin *LabelCache::inferred(const Net &net) {
+	if (net.index >= net_values.size()) return nullptr;
+	if (net_generations[net.index] != generation) {
+		auto iter = std::find_if(net.pins.cbegin(), net.pins.cend(), [this](auto &opin) { return !opin->value(value).empty(); });
+		net_values[net.index]      = iter != net.pins.cend() ? iter->get() : nullptr;
+		net_generations[net.index] = generation;
+	}
+	return net_values[net.index];
+}
+
+const LabelCache::PinLabel &LabelCache::pin(const Pin &pin) {
+	static PinLabel none;
+	if (pin.index >= pins.size()) return none;
+
+	auto &label = pins[pin.index];
+	if (label.generation == generation) return label;
+
+	std::string_view net_name = pin.net ? pin.net->name : std::string_view();
+	label.text                = measure(std::string(pin.name) + "\n" + std::string(net_name));
+	label.name                = measure(pin.name);
+	label.net                 = measure(net_name);
+
+	label.value.clear();
+	if (value != Pin::kValueNone) {
+		label.value = std::string(pin.value(value));
+		if (label.value.empty() && infer && pin.net) {
+			auto other = inferred(*pin.net);
+			if (other) {
+				label.value = std::string(other->value(value));
+				label.value += " (";
+				label.value += other->component->name;
+				label.value += ")";
+			}
+		}
+	}
+	label.value_size = measure(label.value);
+	label.generation = generation;
+	return label;
+}
+
+const LabelCache::PartLabel &LabelCache::part(const Component &part, std::string_view text) {
+	static PartLabel none;
+	if (part.index >= parts.size()) return none;
+
+	auto &label = parts[part.index];
+	if (label.generation == generation) return label;
+
+	label.text       = measure(text);
+	label.generation = generation;
+	return label;
+}
+
+const LabelCache::SideLabel &LabelCache::side(int side) {
+	static SideLabel none;
+	if (side < 0) return none;
+
+	if (static_cast<size_t>(side) >= sides.size()) sides.resize(side + 1);
+	auto &label = sides[side];
+	if (label.text.empty()) {
+		label.text = std::to_string(side);
+		label.size = measure(label.text);
+	}
+	return label;
+}
+
+/*
+ * LabelGrid
+ */
+
+void LabelGrid::clear() {
+	for (uint32_t b : used) buckets[b].clear();
+	used.clear();
+	rects.clear();
+	large.clear();
+}
+
+uint32_t LabelGrid::bucket(int x, int y) {
+	return (static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u) & (kBuckets - 1);
+}
+
+bool LabelGrid::overlaps(uint32_t rect, const ImVec2 &min, const ImVec2 &max) const {
+	const Rect &r = rects[rect];
+	return r.min.x < max.x && min.x < r.max.x && r.min.y < max.y && min.y < r.max.y;
+}
+
+// Range of cells [x0, x1] by [y0, y1] a rectangle covers, false if it covers more than kMaxCells
+bool LabelGrid::cells(const ImVec2 &min, const ImVec2 &max, int &x0, int &y0, int &x1, int &y1) const {
+	// Screen coordinates stay in the thousands of pixels, far from the int limits, but huge labels don't
+	float fx0 = floorf(min.x / kCellSize), fy0 = floorf(min.y / kCellSize);
+	float fx1 = floorf(max.x / kCellSize), fy1 = floorf(max.y / kCellSize);
+	if ((fx1 - fx0 + 1) * (fy1 - fy0 + 1) > kMaxCells) return false;
+	x0 = static_cast<int>(fx0);
+	y0 = static_cast<int>(fy0);
+	x1 = static_cast<int>(fx1);
+	y1 = static_cast<int>(fy1);
+	return true;
+}
+
+bool LabelGrid::fits(const ImVec2 &min, const ImVec2 &max) const {
+	for (uint32_t r : large)
+		if (overlaps(r, min, max)) return false;
+
+	int x0, y0, x1, y1;
+	if (!cells(min, max, x0, y0, x1, y1)) {
+		for (uint32_t r = 0; r < rects.size(); r++)
+			if (overlaps(r, min, max)) return false;
+		return true;
+	}
+	for (int y = y0; y <= y1; y++)
+		for (int x = x0; x <= x1; x++)
+			for (uint32_t r : buckets[bucket(x, y)])
+				if (overlaps(r, min, max)) return false;
+	return true;
+}
+
+void LabelGrid::place(const ImVec2 &min, const ImVec2 &max) {
+	uint32_t r = static_cast<uint32_t>(rects.size());
+	rects.push_back({min, max});
+
+	int x0, y0, x1, y1;
+	if (!cells(min, max, x0, y0, x1, y1)) {
+		large.push_back(r);
+		return;
+	}
+	for (int y = y0; y <= y1; y++)
+		for (int x = x0; x <= x1; x++) {
+			auto &b = buckets[bucket(x, y)];
+			if (b.empty()) used.push_back(bucket(x, y));
+			if (b.empty() || b.back() != r) b.push_back(r); // cells can share a bucket
+		}
+}
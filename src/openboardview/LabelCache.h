@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Board.h"
+
+#include "imgui/imgui.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Text of the pin and part labels, formatted and measured once instead of every frame.
+ * ImFont::CalcTextSizeA() scales linearly with the font size, so sizes are kept for a font size
+ * of 1 and hold at any zoom, labels only go stale when the font or what they show changes.
+ */
+class LabelCache {
+  public:
+	struct PinLabel {
+		std::string value; // shown diode/voltage/ohm value, with the part it's from when inferred
+		ImVec2 text;       // pin name over net name
+		ImVec2 name;
+		ImVec2 net;
+		ImVec2 value_size;
+		uint32_t generation = 0;
+	};
+
+	struct PartLabel {
+		ImVec2 text;
+		uint32_t generation = 0;
+	};
+
+	// Via side number
+	struct SideLabel {
+		std::string text;
+		ImVec2 size;
+	};
+
+	// Board loaded
+	void reset(Board &board);
+
+	/*
+	 * Font the labels are measured with, pin values shown (Pin::kValueNone for none) and whether a pin
+	 * without one shows another's from its net, what part labels show. Labels made for others
+	 * are made again.
+	 */
+	void update(ImFont *font, Pin::EValue value, bool infer, bool part_type);
+	// Pin values were edited
+	void invalidate();
+
+	const PinLabel &pin(const Pin &pin);
+	const PartLabel &part(const Component &part, std::string_view text);
+	const SideLabel &side(int side);
+
+  private:
+	// First pin of a net with a value to show, nullptr if none has one
+	const Pin *inferred(const Net &net);
+
+	ImVec2 measure(std::string_view text) const;
+
+	ImFont *font            = nullptr;
+	float font_size         = 0.0f;
+	Pin::EValue value = Pin::kValueNone;
+	bool infer              = false;
+	bool part_type          = false;
+	uint32_t generation     = 1;
+
+	std::vector<PinLabel> pins;
+	std::vector<PartLabel> parts;
+	std::vector<SideLabel> sides;
+	std::vector<const Pin *> net_values;
+	std::vector<uint32_t> net_generations;
+};
+
+/*
+ * Screen rectangles of the labels drawn this frame, hashed by the grid cells they cover,
+ * so labels that would overlap one already drawn can be left out.
+ */
+class LabelGrid {
+  public:
+	void clear();
+
+	// Whether a label over [min, max] stays clear of those placed so far
+	bool fits(const ImVec2 &min, const ImVec2 &max) const;
+	void place(const ImVec2 &min, const ImVec2 &max);
+
+  private:
+	static constexpr float kCellSize = 64.0f; // pixels
+	static constexpr uint32_t kBuckets = 1024;
+	static constexpr int kMaxCells   = 16; // labels over more cells are kept in large
+
+	struct Rect {
+		ImVec2 min, max;
+	};
+
+	static uint32_t bucket(int x, int y);
+	bool overlaps(uint32_t rect, const ImVec2 &min, const ImVec2 &max) const;
+	bool cells(const ImVec2 &min, const ImVec2 &max, int &x0, int &y0, int &x1, int &y1) const;
+
+	std::vector<Rect> rects;
+	std::vector<std::vector<uint32_t>> buckets = std::vector<std::vector<uint32_t>>(kBuckets);
+	std::vector<uint32_t> used; // buckets with rects in them
+	std::vector<uint32_t> large;
+};
@@ -0,0 +1,217 @@
+#include "LevelOfDetail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+constexpr float kPinCellPixels        = 2.0f;  // density cell size at the octave's smallest scale
+constexpr float kPinLodPixels         = 0.5f;  // pins under this diameter at the smallest scale go to cells
+constexpr float kTrackTolerancePixels = 0.5f;
+constexpr float kMinCoverage          = 0.25f; // keeps cells of a few tiny pins visible
+
+// Track end, tracks sharing one can be chained
+struct TrackEnd {
+	EBoardSide side;
+	Net *net;
+	float width;
+	float x, y;
+
+	bool operator==(const TrackEnd &o) const {
+		return side == o.side && net == o.net && width == o.width && x == o.x && y == o.y;
+	}
+};
+
+struct TrackEndHash {
+	size_t operator()(const TrackEnd &e) const {
+		size_t h = std::hash<float>()(e.x);
+		h        = h * 31 + std::hash<float>()(e.y);
+		h        = h * 31 + std::hash<const void *>()(e.net);
+		return h * 31 + e.side;
+	}
+};
+
+float segment_distance2(ImVec2 p, ImVec2 a, ImVec2 b) {
+	float dx = b.x - a.x, dy = b.y - a.y;
+	float len2 = dx * dx + dy * dy;
+	float t    = len2 > 0.0f ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / len2, 0.0f, 1.0f) : 0.0f;
+	float ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+	return ex * ex + ey * ey;
+}
+
+// Douglas-Peucker, keeps the points needed to stay within tolerance of the polyline
+void simplify(const std::vector<ImVec2> &points, float tolerance, std::vector<ImVec2> &result) {
+	result.clear();
+	if (points.size() <= 2) {
+		result = points;
+		return;
+	}
+
+	std::vector<bool> keep(points.size(), false);
+	keep.front() = keep.back() = true;
+	std::vector<std::pair<size_t, size_t>> spans{{0, points.size() - 1}};
+	float tolerance2 = tolerance * tolerance;
+	while (!spans.empty()) {
+		auto span = spans.back();
+		spans.pop_back();
+		size_t farthest = 0;
+		float distance2 = tolerance2;
+		for (size_t i = span.first + 1; i < span.second; i++) {
+			float d = segment_distance2(points[i], points[span.first], points[span.second]);
+			if (d > distance2) {
+				distance2 = d;
+				farthest  = i;
+			}
+		}
+		if (farthest) {
+			keep[farthest] = true;
+			spans.push_back({span.first, farthest});
+			spans.push_back({farthest, span.second});
+		}
+	}
+
+	for (size_t i = 0; i < points.size(); i++)
+		if (keep[i]) result.push_back(points[i]);
+}
+
+} // namespace
+
+int BoardLod::octave(float scale) {
+	if (scale <= 0.0f) return 0;
+	return std::max(0, static_cast<int>(std::ceil(std::log2(1.0f / scale))));
+}
+
+const BoardLod::Level *BoardLod::level(Board &board, float scale) {
+	int n = octave(scale);
+	if (n == 0) return nullptr;
+
+	auto it = levels.find(n);
+	if (it == levels.end()) {
+		Level level;
+		level.pixel_size         = std::exp2(static_cast<float>(n));
+		level.cell_size          = kPinCellPixels * level.pixel_size;
+		level.pin_diameter_limit = kPinLodPixels * level.pixel_size;
+		it                       = levels.emplace(n, std::move(level)).first;
+	}
+
+	auto &level = it->second;
+	if (!level.pins_done) build_pins(board, level);
+	if (!level.tracks_done) build_tracks(board, level);
+	return &level;
+}
+
+void BoardLod::clear() {
+	levels.clear();
+	chains.clear();
+	chains_done = false;
+}
+
+void BoardLod::invalidate_pins() {
+	for (auto &level : levels) level.second.pins_done = false;
+}
+
+void BoardLod::build_pins(Board &board, Level &level) {
+	auto &store = board.Store();
+	level.pin_cells.clear();
+
+	std::unordered_map<uint64_t, uint32_t> cell_of;
+	std::vector<double> sum_x, sum_y;
+	for (size_t i = 0; i < store.pin_count(); i++) {
+		float diameter = store.pin_diameter[i];
+		if (diameter >= level.pin_diameter_limit) continue;
+
+		int64_t column = static_cast<int64_t>(std::floor(store.pin_x[i] / level.cell_size));
+		int64_t row    = static_cast<int64_t>(std::floor(store.pin_y[i] / level.cell_size));
+		uint64_t key   = (static_cast<uint64_t>(store.pin_side[i]) << 56) ^ ((static_cast<uint64_t>(column) & 0xFFFFFFF) << 28) ^
+		               (static_cast<uint64_t>(row) & 0xFFFFFFF);
+		auto found = cell_of.emplace(key, level.pin_cells.size());
+		if (found.second) {
+			level.pin_cells.push_back({ImVec2(0.0f, 0.0f), store.pin_side[i], 0, 0.0f, 0.0f});
+			sum_x.push_back(0.0);
+			sum_y.push_back(0.0);
+		}
+
+		uint32_t c = found.first->second;
+		auto &cell = level.pin_cells[c];
+		cell.count++;
+		cell.diameter = std::max(cell.diameter, diameter);
+		sum_x[c] += store.pin_x[i];
+		sum_y[c] += store.pin_y[i];
+	}
+
+	// Pins are drawn with their diameter as radius
+	float cell_area = level.cell_size * level.cell_size;
+	for (size_t c = 0; c < level.pin_cells.size(); c++) {
+		auto &cell    = level.pin_cells[c];
+		cell.center   = ImVec2(static_cast<float>(sum_x[c] / cell.count), static_cast<float>(sum_y[c] / cell.count));
+		cell.coverage = std::clamp(cell.count * static_cast<float>(M_PI) * cell.diameter * cell.diameter / cell_area, kMinCoverage, 1.0f);
+	}
+
+	level.pins_done = true;
+}
+
+void BoardLod::build_tracks(Board &board, Level &level) {
+	auto &tracks = board.Tracks();
+
+	if (!chains_done) {
+		std::unordered_multimap<TrackEnd, uint32_t, TrackEndHash> ends;
+		ends.reserve(tracks.size() * 2);
+		for (uint32_t i = 0; i < tracks.size(); i++) {
+			auto &t = tracks[i];
+			ends.emplace(TrackEnd{t->board_side, t->net, t->width, t->position_start.x, t->position_start.y}, i);
+			ends.emplace(TrackEnd{t->board_side, t->net, t->width, t->position_end.x, t->position_end.y}, i);
+		}
+
+		std::vector<bool> used(tracks.size(), false);
+
+		// Follows unused tracks from point, adding their far ends to points
+		auto extend = [&](const Track &first, ImVec2 point, std::vector<ImVec2> &points) {
+			for (;;) {
+				auto range = ends.equal_range(TrackEnd{first.board_side, first.net, first.width, point.x, point.y});
+				auto next  = std::find_if(range.first, range.second, [&](auto &end) { return !used[end.second]; });
+				if (next == range.second) break;
+				used[next->second] = true;
+
+				auto &t = *tracks[next->second];
+				if (t.position_start.x == point.x && t.position_start.y == point.y)
+					point = ImVec2(t.position_end.x, t.position_end.y);
+				else
+					point = ImVec2(t.position_start.x, t.position_start.y);
+				points.push_back(point);
+			}
+		};
+
+		std::vector<ImVec2> backward;
+		for (uint32_t i = 0; i < tracks.size(); i++) {
+			if (used[i]) continue;
+			used[i] = true;
+
+			auto &t = *tracks[i];
+			TrackPath path{t.board_side, t.net, t.width, {}, {}, {}};
+			backward.assign(1, ImVec2(t.position_start.x, t.position_start.y));
+			extend(t, backward.front(), backward);
+			path.points.assign(backward.rbegin(), backward.rend());
+			path.points.push_back(ImVec2(t.position_end.x, t.position_end.y));
+			extend(t, path.points.back(), path.points);
+			chains.push_back(std::move(path));
+		}
+		chains_done = true;
+	}
+
+	float tolerance = kTrackTolerancePixels * level.pixel_size;
+	level.track_paths.clear();
+	level.track_paths.reserve(chains.size());
+	for (auto &chain : chains) {
+		TrackPath path{chain.side, chain.net, chain.width, {}, {}, {}};
+		simplify(chain.points, tolerance, path.points);
+		path.min = path.max = path.points.front();
+		for (auto &p : path.points) {
+			path.min = ImVec2(std::min(path.min.x, p.x), std::min(path.min.y, p.y));
+			path.max = ImVec2(std::max(path.max.x, p.x), std::max(path.max.y, p.y));
+		}
+		level.track_paths.push_back(std::move(path));
+	}
+
+	level.tracks_done = true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Board.h"
+
+#include "imgui/imgui.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/*
+ * Stand-ins for drawing a zoomed out board, built for a zoom octave the first time the view is in it.
+ * Octave n covers scales from 2^-n up to 2^(1-n) pixels per board unit. There, pins that would be
+ * drawn under a pixel are binned into density cells of a couple of pixels each, and connected tracks
+ * are merged into paths simplified to half a pixel.
+ */
+class BoardLod {
+  public:
+	// Pins of one side falling in one cell of a level's density grid
+	struct PinCell {
+		ImVec2 center; // mean position of the pins
+		EBoardSide side;
+		uint32_t count;
+		float diameter; // largest pin diameter
+		float coverage; // estimated fraction of the cell the pins cover, 0 to 1
+	};
+
+	// Connected tracks of the same side, net and width as one polyline
+	struct TrackPath {
+		EBoardSide side;
+		Net *net;
+		float width;
+		ImVec2 min, max; // bounding box of the points
+		std::vector<ImVec2> points;
+	};
+
+	struct Level {
+		float pixel_size;         // board units per pixel at the octave's smallest scale
+		float cell_size;          // of the pin density grid, in board units
+		float pin_diameter_limit; // pins with a smaller diameter are in pin_cells
+		std::vector<PinCell> pin_cells;
+		std::vector<TrackPath> track_paths;
+
+		bool pins_done   = false;
+		bool tracks_done = false;
+	};
+
+	// Octave of a scale in pixels per board unit, 0 if zoomed in enough to draw everything as is
+	static int octave(float scale);
+
+	// Level for a scale, built as needed, nullptr for octave 0
+	const Level *level(Board &board, float scale);
+
+	// Board loaded or changed
+	void clear();
+	// Pin positions or diameters changed, e.g. after Mirror() or computing part outlines
+	void invalidate_pins();
+
+  private:
+	void build_pins(Board &board, Level &level);
+	void build_tracks(Board &board, Level &level);
+
+	std::map<int, Level> levels;
+
+	// Unsimplified paths all levels simplify from
+	std::vector<TrackPath> chains;
+	bool chains_done = false;
+};
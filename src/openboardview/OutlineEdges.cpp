@@ -0,0 +1,140 @@
+#include "OutlineEdges.h"
+
+#include <algorithm>
+#include <cfloat>
+
+void OutlineEdges::clear() {
+	edges.clear();
+	band_start.clear();
+	band_edges.clear();
+	min_point = max_point = ImVec2(0.0f, 0.0f);
+}
+
+void OutlineEdges::add(const Point &pa, const Point &pb) {
+	min_point.x = std::min({min_point.x, pa.x, pb.x});
+	min_point.y = std::min({min_point.y, pa.y, pb.y});
+	max_point.x = std::max({max_point.x, pa.x, pb.x});
+	max_point.y = std::max({max_point.y, pa.y, pb.y});
+
+	if (pa.y == pb.y) return;
+	const Point &lo = pa.y < pb.y ? pa : pb;
+	const Point &hi = pa.y < pb.y ? pb : pa;
+	edges.push_back({lo.y, hi.y, lo.x, (static_cast<double>(hi.x) - lo.x) / (static_cast<double>(hi.y) - lo.y)});
+}
+
+void OutlineEdges::build(Board &board, bool segments, const Point *first) {
+	clear();
+	min_point = ImVec2(FLT_MAX, FLT_MAX);
+	max_point = ImVec2(-FLT_MAX, -FLT_MAX);
+
+	auto &outline_points = board.OutlinePoints();
+	if (!outline_points.empty()) {
+		// set our initial draw point, so we can detect when we encounter it again
+		int jump = 1;
+		Point fp = first ? *first : *outline_points[0];
+
+		for (size_t i = 0; i < outline_points.size() - 1; i++) {
+			Point &pa = *outline_points[i];
+			Point &pb = *outline_points[i + 1];
+
+			// jump double/dud points
+			if (pa.x == pb.x && pa.y == pb.y) continue;
+
+			add(pa, pb);
+
+			// if we encounter our hull/poly start point, then we've now created the closed
+			// hull, jump the next segment to the following contour and reset the first-point
+			if ((!jump) && (fp.x == pb.x) && (fp.y == pb.y)) {
+				if (i < outline_points.size() - 2) {
+					fp   = *outline_points[i + 2];
+					jump = 1;
+					i++;
+				}
+			} else {
+				jump = 0;
+			}
+		}
+	}
+
+	if (segments) {
+		for (auto &s : board.OutlineSegments()) {
+			// jump double/dud segments
+			if (s.first.x == s.second.x && s.first.y == s.second.y) continue;
+			add(s.first, s.second);
+		}
+	}
+
+	if (min_point.x > max_point.x) min_point = max_point = ImVec2(0.0f, 0.0f);
+
+	std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.y0 < b.y0; });
+	build_bands();
+}
+
+void OutlineEdges::build_bands() {
+	band_start.clear();
+	band_edges.clear();
+	if (edges.empty()) return;
+
+	// About two edges per band on an even outline, arcs tessellated finely still get few per band
+	size_t bands = std::clamp<size_t>(edges.size() / 2, 1, 4096);
+	double span  = static_cast<double>(max_point.y) - min_point.y;
+	band_height  = span > 0 ? span / bands : 1.0;
+
+	auto band = [&](double y) {
+		return static_cast<size_t>(std::clamp((y - min_point.y) / band_height, 0.0, static_cast<double>(bands - 1)));
+	};
+
+	// Count, then fill, edges per band
+	band_start.assign(bands + 1, 0);
+	for (auto &e : edges)
+		for (size_t b = band(e.y0), last = band(e.y1); b <= last; b++) band_start[b + 1]++;
+	for (size_t b = 0; b < bands; b++) band_start[b + 1] += band_start[b];
+	band_edges.resize(band_start[bands]);
+	std::vector<uint32_t> fill(band_start.begin(), band_start.end() - 1);
+	for (uint32_t i = 0; i < edges.size(); i++)
+		for (size_t b = band(edges[i].y0), last = band(edges[i].y1); b <= last; b++) band_edges[fill[b]++] = i;
+}
+
+void OutlineEdges::crossings(double x, double y, int &left, int &right) const {
+	left = right = 0;
+	if (band_start.empty() || y <= min_point.y || y >= max_point.y) return;
+
+	size_t bands = band_start.size() - 1;
+	size_t b     = std::min(static_cast<size_t>((y - min_point.y) / band_height), bands - 1);
+	for (uint32_t i = band_start[b]; i < band_start[b + 1]; i++) {
+		auto &edge = edges[band_edges[i]];
+		if (!(edge.y0 < y && y < edge.y1)) continue;
+
+		double ex = edge.x0 + edge.dxdy * (y - edge.y0);
+		if (ex > x)
+			right++;
+		else if (ex < x)
+			left++;
+	}
+}
+
+void OutlineEdges::Scanner::hits(double y, std::vector<ImVec2> &scanhits) {
+	scanhits.resize(0);
+
+	if (y < last_y) {
+		next = 0;
+		active.clear();
+	}
+	last_y = y;
+
+	// Edges starting below the line become active, those ending on or below it are done
+	auto &edges = outline.edges;
+	for (; next < edges.size() && edges[next].y0 < y; next++) active.push_back(static_cast<uint32_t>(next));
+	active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t e) { return edges[e].y1 <= y; }), active.end());
+
+	for (uint32_t e : active) {
+		auto &edge = edges[e];
+		scanhits.push_back(ImVec2(static_cast<float>(edge.x0 + edge.dxdy * (y - edge.y0)), static_cast<float>(y)));
+	}
+
+	sort(scanhits.begin(), scanhits.end(), [](ImVec2 const &a, ImVec2 const &b) { return a.x < b.x; });
+	// Some boards contain duplicate outline segments (possibly with points swapped) that generate duplicate intersections
+	// which interferes with the process of generating alterating segments for the scanlines, so remove duplicates.
+	scanhits.erase(std::unique(scanhits.begin(), scanhits.end(), [](const ImVec2 &a, const ImVec2 &b) { return a.x == b.x && a.y == b.y; }),
+	               scanhits.end());
+}
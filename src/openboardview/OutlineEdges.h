@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Board.h"
+
+#include "imgui/imgui.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * Edges of the board outline, from the OutlinePoints() contours and OutlineSegments(), sorted by
+ * their lower end. Built once per outline so lines scanned up the board only go through the edges
+ * they cross, with an active edge table, instead of through the whole outline for each line.
+ */
+class OutlineEdges {
+  public:
+	struct Edge {
+		double y0, y1; // y0 < y1, horizontal edges never cross a scan line and are left out
+		double x0;     // at y0
+		double dxdy;
+	};
+
+	/*
+	 * Edges of the board's outline as it is now, again after it changes e.g. with Mirror().
+	 * Without segments, only the OutlinePoints() contours. The segment after a contour closes, back
+	 * to its first point, joins it to the next one and is left out; first is taken as the first
+	 * contour's first point, nullptr for the first outline point.
+	 */
+	void build(Board &board, bool segments = true, const Point *first = nullptr);
+	void clear();
+
+	bool empty() const {
+		return edges.empty();
+	}
+	// Bounding box of the outline
+	const ImVec2 &min() const {
+		return min_point;
+	}
+	const ImVec2 &max() const {
+		return max_point;
+	}
+
+	/*
+	 * Edges crossing the horizontal line through (x, y) left and right of x, found through the
+	 * horizontal bands the edges are filed in, for points in any order. Safe from several threads.
+	 */
+	void crossings(double x, double y, int &left, int &right) const;
+
+	/*
+	 * Goes up the outline, keeping the edges spanning the last line scanned. Lines are fastest
+	 * scanned in increasing y, scanning a lower one starts over from the bottom.
+	 */
+	class Scanner {
+	  public:
+		explicit Scanner(const OutlineEdges &outline)
+		    : outline(outline) {}
+
+		/*
+		 * Board x coordinates where the outline crosses the horizontal line at board y, sorted, so
+		 * every other span between them is inside the board
+		 */
+		void hits(double y, std::vector<ImVec2> &scanhits);
+
+	  private:
+		const OutlineEdges &outline;
+		size_t next   = 0; // first edge not yet active
+		double last_y = 0.0;
+		std::vector<uint32_t> active;
+	};
+
+  private:
+	void add(const Point &pa, const Point &pb);
+	void build_bands();
+
+	std::vector<Edge> edges;
+	ImVec2 min_point{0.0f, 0.0f}, max_point{0.0f, 0.0f};
+
+	// Edges overlapping band b are band_edges[band_start[b]] to band_edges[band_start[b + 1]]
+	double band_height = 1.0;
+	std::vector<uint32_t> band_start;
+	std::vector<uint32_t> band_edges;
+};
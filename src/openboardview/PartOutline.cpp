@@ -0,0 +1,301 @@
+#include "PartOutline.h"
+
+#include "imgui/imgui.h"
+#include "parallel.h"
+#include "vectorhulls.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+void OutlinePart(Component *part, float pin_diameter) {
+	int pincount = 0;
+	double min_x = 0, min_y = 0, max_x = 0, max_y = 0, aspect;
+	double angle;
+	double distance = 0;
+	char p0, p1; // first two characters of the part name, code-writing
+	             // convenience more than anything else
+	std::vector<ImVec2> pva;
+	std::array<ImVec2, 4> dbox; // default box, if there's nothing else claiming to render the part different.
+
+	if (part->pins.size() == 0) return;
+
+	for (auto &pin : part->pins) {
+		pincount++;
+
+		// scale box around pins as a fallback, else either use polygon or convex
+		// hull for better shape fidelity
+		if (pincount == 1) {
+			min_x = pin->position().x;
+			min_y = pin->position().y;
+			max_x = min_x;
+			max_y = min_y;
+		}
+
+		pva.push_back({pin->position().x, pin->position().y});
+
+		if (pin->position().x > max_x) {
+			max_x = pin->position().x;
+
+		} else if (pin->position().x < min_x) {
+			min_x = pin->position().x;
+		}
+		if (pin->position().y > max_y) {
+			max_y = pin->position().y;
+
+		} else if (pin->position().y < min_y) {
+			min_y = pin->position().y;
+		}
+	}
+
+	part->omin        = ImVec2(min_x, min_y);
+	part->omax        = ImVec2(max_x, max_y);
+	part->centerpoint = ImVec2((max_x - min_x) / 2 + min_x, (max_y - min_y) / 2 + min_y);
+
+	distance = sqrt((max_x - min_x) * (max_x - min_x) + (max_y - min_y) * (max_y - min_y));
+
+	float pin_radius = pin_diameter / 2.0f;
+
+	/*
+	 *
+	 * Determine the size of our part's pin radius based on the distance
+	 * between the extremes of the pin coordinates.
+	 *
+	 * All the figures below are determined empirically rather than any
+	 * specific formula.
+	 *
+	 */
+	if ((pincount < 4) && (part->name[0] != 'U') && (part->name[0] != 'Q')) {
+
+		if ((distance > 52) && (distance < 57)) {
+			// 0603
+			pin_radius = 15;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 247) && (distance < 253)) {
+			// SMC diode?
+			pin_radius = 50;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 195) && (distance < 199)) {
+			// Inductor?
+			pin_radius = 50;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 165) && (distance < 169)) {
+			// SMB diode?
+			pin_radius = 35;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 101) && (distance < 109)) {
+			// SMA diode / tant cap
+			pin_radius = 30;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 108) && (distance < 112)) {
+			// 1206
+			pin_radius = 30;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 64) && (distance < 68)) {
+			// 0805
+			pin_radius = 25;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+
+		} else if ((distance > 18) && (distance < 22)) {
+			// 0201 cap/resistor?
+			pin_radius = 5;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+		} else if ((distance > 28) && (distance < 32)) {
+			// 0402 cap/resistor
+			pin_radius = 10;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+		}
+	}
+
+	// TODO: pin radius is stored in Pin object
+	//
+	//
+	//
+	min_x -= pin_radius;
+	max_x += pin_radius;
+	min_y -= pin_radius;
+	max_y += pin_radius;
+
+	if ((max_y - min_y) < 0.01)
+		aspect = 0;
+	else
+		aspect = (max_x - min_x) / (max_y - min_y);
+
+	dbox[0].x = dbox[3].x = min_x;
+	dbox[1].x = dbox[2].x = max_x;
+	dbox[0].y = dbox[1].y = min_y;
+	dbox[3].y = dbox[2].y = max_y;
+
+	p0 = part->name[0];
+	p1 = part->name[1];
+
+	/*
+	 * Draw all 2~3 pin devices as if they're not orthagonal.  It's a bit more
+	 * CPU
+	 * overhead but it keeps the code simpler and saves us replicating things.
+	 */
+
+	if ((pincount == 3) && (abs(aspect) > 0.5) &&
+	    ((strchr("DQZ", p0) || (strchr("DQZ", p1)) || strcmp(part->name.data(), "LED")))) {
+
+		part->outline = dbox;
+		part->outline_done = true;
+
+		part->hull.clear();
+		for (auto &pin : part->pins) {
+			part->hull.push_back({pin->position().x, pin->position().y});
+		}
+
+		/*
+		 * handle all other devices not specifically handled above
+		 */
+	} else if ((pincount > 1) && (pincount < 4) && ((strchr("CRLD", p0) || (strchr("CRLD", p1))))) {
+		double dx, dy;
+		double tx, ty;
+		double armx, army;
+
+		dx    = part->pins[1]->position().x - part->pins[0]->position().x;
+		dy    = part->pins[1]->position().y - part->pins[0]->position().y;
+		angle = atan2(dy, dx);
+
+		if (((p0 == 'L') || (p1 == 'L')) && (distance > 50)) {
+			pin_radius = 15;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+			army = distance / 2;
+			armx = pin_radius;
+		} else if (((p0 == 'C') || (p1 == 'C')) && (distance > 90)) {
+			double mpx, mpy;
+
+			pin_radius = 15;
+			for (auto &pin : part->pins) {
+				pin->set_diameter(pin_radius); // * 0.05;
+			}
+			army = distance / 2 - distance / 4;
+			armx = pin_radius;
+
+			mpx = dx / 2 + part->pins[0]->position().x;
+			mpy = dy / 2 + part->pins[0]->position().y;
+			VHRotateV(&mpx, &mpy, dx / 2 + part->pins[0]->position().x, dy / 2 + part->pins[0]->position().y, angle);
+
+			part->expanse        = distance;
+			part->centerpoint.x  = mpx;
+			part->centerpoint.y  = mpy;
+			part->component_type = part->kComponentTypeCapacitor;
+
+		} else {
+			armx = army = pin_radius;
+		}
+
+		// TODO: Compact this bit of code, maybe. It works at least.
+		tx = part->pins[0]->position().x - armx;
+		ty = part->pins[0]->position().y - army;
+		VHRotateV(&tx, &ty, part->pins[0]->position().x, part->pins[0]->position().y, angle);
+		// a = CoordToScreen(tx, ty);
+		part->outline[0].x = tx;
+		part->outline[0].y = ty;
+
+		tx = part->pins[0]->position().x - armx;
+		ty = part->pins[0]->position().y + army;
+		VHRotateV(&tx, &ty, part->pins[0]->position().x, part->pins[0]->position().y, angle);
+		// b = CoordToScreen(tx, ty);
+		part->outline[1].x = tx;
+		part->outline[1].y = ty;
+
+		tx = part->pins[1]->position().x + armx;
+		ty = part->pins[1]->position().y + army;
+		VHRotateV(&tx, &ty, part->pins[1]->position().x, part->pins[1]->position().y, angle);
+		// c = CoordToScreen(tx, ty);
+		part->outline[2].x = tx;
+		part->outline[2].y = ty;
+
+		tx = part->pins[1]->position().x + armx;
+		ty = part->pins[1]->position().y - army;
+		VHRotateV(&tx, &ty, part->pins[1]->position().x, part->pins[1]->position().y, angle);
+		// d = CoordToScreen(tx, ty);
+		part->outline[3].x = tx;
+		part->outline[3].y = ty;
+
+		part->outline_done = true;
+
+		// rendered = 1;
+
+	} else {
+
+		/*
+		 * If we have (typically) a connector with a non uniform pin distribution
+		 * then we can try use the minimal bounding box algorithm
+		 * to give it a more sane outline
+		 */
+		if ((pincount >= 4) && ((strchr("UJL", p0) || strchr("UJL", p1) || (strncmp(part->name.data(), "CN", 2) == 0)))) {
+			// Find our hull, straight into the part's
+			part->hull.resize(pva.size());
+			part->hull.resize(VHConvexHull(pva.data(), pva.size(), part->hull.data()));
+
+			// If we had a valid hull, then find the MBB for it
+			if (part->hull.size() > 0) {
+				std::array<ImVec2, 4> bbox = VHMBBCalculate(part->hull, pin_radius);
+				part->outline = bbox;
+				part->outline_done = true;
+
+				/*
+				 * Tighten the hull, removes any small angle segments
+				 * such as a sequence of pins in a line, might be an overkill
+				 */
+				// hpc = TightenHull(hull, hpc, 0.1f);
+			}
+		} else {
+			// if it wasn't at an odd angle, or wasn't large, or wasn't a connector,
+			// just an ordinary
+			// type part, then this is where we'll likely end up
+			part->outline = dbox;
+			part->outline_done = true;
+		}
+	}
+
+	//			if (rendered == 0) {
+	//				fprintf(stderr, "Part wasn't rendered (%s)\n", part->name.data());
+	//			}
+
+	if (part->is_special_outline) {
+		part->outline = part->special_outline;
+	}
+}
+
+void OutlineParts(Board *board) {
+	auto &components = board->Components();
+
+	// Parts only write to themselves and their own pins, ranges don't share anything
+	parallel_for_ranges(components.size(), 256, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			auto &part = components[i];
+			if (part->is_dummy()) continue;
+			OutlinePart(part.get());
+		}
+	});
+}
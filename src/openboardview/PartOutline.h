@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Board.h"
+
+// Pin diameter parts are outlined for when their pins don't tell a better one
+constexpr int kDefaultPinDiameter = 20;
+
+/*
+ * Works out the outline of a part from its pins: a box around them, a rotated one for two pin
+ * parts, or the minimal bounding box of their convex hull for connectors and chips, and resizes
+ * pins of common packages. Parts without pins are left without an outline (outline_done false).
+ */
+void OutlinePart(Component *part, float pin_diameter = kDefaultPinDiameter);
+
+// Outlines all parts of the board across worker threads and updates the pin diameters in its store
+void OutlineParts(Board *board);
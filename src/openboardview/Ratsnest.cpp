@@ -0,0 +1,178 @@
+#include "Ratsnest.h"
+
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t kLeafSize = 8;
+constexpr uint32_t kMixed    = UINT32_MAX; // node with points of several fragments
+
+// Points split in halves along the wider side of their box, down to small leaves
+struct KdTree {
+	struct Node {
+		ImVec2 min, max;
+		uint32_t begin, end;           // in order
+		int32_t left = -1, right = -1; // children, -1 for a leaf
+	};
+
+	const std::vector<ImVec2> &points;
+	std::vector<uint32_t> order;
+	std::vector<Node> nodes; // parents before their children
+
+	explicit KdTree(const std::vector<ImVec2> &points)
+	    : points(points), order(points.size()) {
+		std::iota(order.begin(), order.end(), 0);
+		if (!points.empty()) build(0, static_cast<uint32_t>(points.size()));
+	}
+
+	int32_t build(uint32_t begin, uint32_t end) {
+		Node node;
+		node.min   = ImVec2(FLT_MAX, FLT_MAX);
+		node.max   = ImVec2(-FLT_MAX, -FLT_MAX);
+		node.begin = begin;
+		node.end   = end;
+		for (uint32_t k = begin; k < end; k++) {
+			auto &p  = points[order[k]];
+			node.min = ImVec2(std::min(node.min.x, p.x), std::min(node.min.y, p.y));
+			node.max = ImVec2(std::max(node.max.x, p.x), std::max(node.max.y, p.y));
+		}
+
+		int32_t id = static_cast<int32_t>(nodes.size());
+		nodes.push_back(node);
+		if (end - begin > kLeafSize) {
+			bool by_x    = node.max.x - node.min.x >= node.max.y - node.min.y;
+			uint32_t mid = begin + (end - begin) / 2;
+			std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](uint32_t a, uint32_t b) {
+				return by_x ? points[a].x < points[b].x : points[a].y < points[b].y;
+			});
+			int32_t left    = build(begin, mid);
+			int32_t right   = build(mid, end);
+			nodes[id].left  = left;
+			nodes[id].right = right;
+		}
+		return id;
+	}
+
+	float distance2(const Node &node, const ImVec2 &p) const {
+		float dx = std::max({node.min.x - p.x, 0.0f, p.x - node.max.x});
+		float dy = std::max({node.min.y - p.y, 0.0f, p.y - node.max.y});
+		return dx * dx + dy * dy;
+	}
+};
+
+struct Fragments {
+	std::vector<uint32_t> parent;
+
+	explicit Fragments(size_t count)
+	    : parent(count) {
+		std::iota(parent.begin(), parent.end(), 0);
+	}
+
+	uint32_t find(uint32_t i) {
+		while (parent[i] != i) i = parent[i] = parent[parent[i]];
+		return i;
+	}
+};
+
+// Closest point to p outside fragment, if closer than best
+void nearest(const KdTree &tree, const std::vector<uint32_t> &fragment_of, const std::vector<uint32_t> &node_fragment, int32_t id,
+             const ImVec2 &p, uint32_t fragment, float &best, uint32_t &best_point) {
+	auto &node = tree.nodes[id];
+	if (node_fragment[id] == fragment || tree.distance2(node, p) >= best) return;
+
+	if (node.left < 0) {
+		for (uint32_t k = node.begin; k < node.end; k++) {
+			uint32_t j = tree.order[k];
+			if (fragment_of[j] == fragment) continue;
+			float dx = tree.points[j].x - p.x, dy = tree.points[j].y - p.y;
+			float d  = dx * dx + dy * dy;
+			if (d < best) {
+				best       = d;
+				best_point = j;
+			}
+		}
+		return;
+	}
+
+	// Nearer child first, so the other is more likely pruned
+	int32_t first = node.left, second = node.right;
+	if (tree.distance2(tree.nodes[second], p) < tree.distance2(tree.nodes[first], p)) std::swap(first, second);
+	nearest(tree, fragment_of, node_fragment, first, p, fragment, best, best_point);
+	nearest(tree, fragment_of, node_fragment, second, p, fragment, best, best_point);
+}
+
+// Minimum spanning tree of points, as pairs of point indices
+std::vector<std::pair<uint32_t, uint32_t>> spanning_tree(const std::vector<ImVec2> &points) {
+	std::vector<std::pair<uint32_t, uint32_t>> tree_edges;
+	size_t count = points.size();
+	if (count < 2) return tree_edges;
+	tree_edges.reserve(count - 1);
+
+	KdTree tree(points);
+	Fragments fragments(count);
+	std::vector<uint32_t> fragment_of(count), node_fragment(tree.nodes.size());
+	std::vector<float> best(count);
+	std::vector<std::pair<uint32_t, uint32_t>> best_edge(count);
+
+	while (tree_edges.size() < count - 1) {
+		for (uint32_t i = 0; i < count; i++) fragment_of[i] = fragments.find(i);
+
+		// Nodes whose points are all in one fragment are skipped when searching from it
+		for (size_t id = tree.nodes.size(); id-- > 0;) {
+			auto &node = tree.nodes[id];
+			if (node.left < 0) {
+				uint32_t fragment = fragment_of[tree.order[node.begin]];
+				for (uint32_t k = node.begin + 1; k < node.end && fragment != kMixed; k++)
+					if (fragment_of[tree.order[k]] != fragment) fragment = kMixed;
+				node_fragment[id] = fragment;
+			} else {
+				uint32_t left     = node_fragment[node.left];
+				node_fragment[id] = left == node_fragment[node.right] ? left : kMixed;
+			}
+		}
+
+		// Shortest edge out of each fragment, a fragment's best so far bounds the searches of its other points
+		std::fill(best.begin(), best.end(), FLT_MAX);
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t fragment = fragment_of[i];
+			uint32_t point    = UINT32_MAX;
+			nearest(tree, fragment_of, node_fragment, 0, points[i], fragment, best[fragment], point);
+			if (point != UINT32_MAX) best_edge[fragment] = {i, point};
+		}
+
+		size_t joined = tree_edges.size();
+		for (uint32_t fragment = 0; fragment < count; fragment++) {
+			if (fragment_of[fragment] != fragment || best[fragment] == FLT_MAX) continue;
+			auto edge = best_edge[fragment];
+			uint32_t a = fragments.find(edge.first), b = fragments.find(edge.second);
+			if (a == b) continue; // the other fragment picked the same or an equally short edge
+			fragments.parent[a] = b;
+			tree_edges.push_back(edge);
+		}
+		if (tree_edges.size() == joined) break; // can't happen, but never spin
+	}
+	return tree_edges;
+}
+
+} // namespace
+
+const std::vector<Ratsnest::Edge> &Ratsnest::net(const BoardStore &store, uint32_t net) {
+	auto found = nets.find(net);
+	if (found != nets.end()) return found->second;
+
+	auto pins = store.net_pin_range(net);
+	std::vector<ImVec2> points;
+	points.reserve(pins.size());
+	for (uint32_t i : pins) points.push_back(ImVec2(store.pin_x[i], store.pin_y[i]));
+
+	auto &edges = nets[net];
+	for (auto &edge : spanning_tree(points)) edges.push_back({pins.first[edge.first], pins.first[edge.second]});
+	return edges;
+}
+
+void Ratsnest::clear() {
+	nets.clear();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Board.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Ratsnest of the nets: the shortest straight connections joining all pins of a net, its Euclidean
+ * minimum spanning tree. Built the first time a net is shown and kept for the board; fragments of the
+ * tree are joined in Boruvka rounds, each finding its closest pin outside through a k-d tree.
+ * Edges are pin indices, so trees stay valid when the board is mirrored, distances don't change.
+ */
+class Ratsnest {
+  public:
+	struct Edge {
+		uint32_t a, b; // BoardStore pin indices
+	};
+
+	// Tree of a net, built on first use
+	const std::vector<Edge> &net(const BoardStore &store, uint32_t net);
+
+	// Board loaded
+	void clear();
+
+  private:
+	std::unordered_map<uint32_t, std::vector<Edge>> nets;
+};
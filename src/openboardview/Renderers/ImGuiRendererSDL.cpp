@@ -87,7 +87,7 @@ void ImGuiRendererSDL::renderFrame(const ImVec4 &clear_color) {
 	glViewport(0, 0, static_cast<int>(ImGui::GetIO().DisplaySize.x), static_cast<int>(ImGui::GetIO().DisplaySize.y));
 	glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
 	glClear(GL_COLOR_BUFFER_BIT);
-	renderDrawData();
+	renderDrawData(ImGui::GetDrawData());
 	SDL_GL_SwapWindow(window);
 }
 
@@ -95,6 +95,10 @@ void ImGuiRendererSDL::shutdown() {
 	ImGui_ImplSDL2_Shutdown();
 }
 
+std::unique_ptr<RetainedLayer> ImGuiRendererSDL::createRetainedLayer() {
+	return {};
+}
+
 std::string ImGuiRendererSDL::loadTextureFromFile(const filesystem::path &filepath, GLuint* out_texture, int* out_width, int* out_height)
 {
 	// Load from file
@@ -151,3 +155,37 @@ std::string ImGuiRendererSDL::loadTextureFromFile(const filesystem::path &filepa
 
 	return {};
 }
+
+bool ImGuiRendererSDL::canRenderToTexture(int size) {
+	int width = 0, height = 0;
+	SDL_GL_GetDrawableSize(window, &width, &height);
+	return width >= size && height >= size;
+}
+
+bool ImGuiRendererSDL::renderToTexture(ImDrawList &list, int size, const ImVec4 &clear_color, GLuint texture) {
+	if (!canRenderToTexture(size)) return false;
+
+	// Without framebuffer objects in OpenGL 1, draw in a corner of the back buffer and copy from there,
+	// renderFrame() clears it before drawing the frame
+	ImDrawList *lists[] = {&list};
+	ImDrawData data;
+	data.Valid            = true;
+	data.CmdLists         = lists;
+	data.CmdListsCount    = 1;
+	data.TotalVtxCount    = list.VtxBuffer.Size;
+	data.TotalIdxCount    = list.IdxBuffer.Size;
+	data.DisplayPos       = ImVec2(0.0f, 0.0f);
+	data.DisplaySize      = ImVec2(static_cast<float>(size), static_cast<float>(size));
+	data.FramebufferScale = ImVec2(1.0f, 1.0f);
+
+	glDisable(GL_SCISSOR_TEST);
+	glViewport(0, 0, size, size);
+	glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+	glClear(GL_COLOR_BUFFER_BIT);
+	renderDrawData(&data);
+
+	// Rows are copied bottom up, the texture is upside down
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, size, size);
+	return true;
+}
@@ -1,6 +1,7 @@
 #ifndef _IMGUIRENDERERSDL_H_
 #define _IMGUIRENDERERSDL_H_
 
+#include <memory>
 #include <string>
 
 // SDL, glad
@@ -10,6 +11,7 @@
 #include "imgui/imgui.h"
 
 #include "filesystem_impl.h"
+#include "RetainedLayer.h"
 
 class ImGuiRendererSDL {
 public:
@@ -22,11 +24,20 @@ public:
 	virtual void processEvent(SDL_Event &event);
 	virtual void initFrame();
 	virtual void renderFrame(const ImVec4 &clear_color);
-	virtual void renderDrawData() = 0;
+	virtual void renderDrawData(ImDrawData *draw_data) = 0;
 	virtual void shutdown();
 
 	// Returned string is error message, empty if successful
 	virtual std::string loadTextureFromFile(const filesystem::path &filepath, GLuint* out_texture, int* out_width, int* out_height);
+
+	// Geometry kept on the GPU between frames, nullptr if this renderer can't do it
+	virtual std::unique_ptr<RetainedLayer> createRetainedLayer();
+
+	// Whether renderToTexture() can render textures of size x size pixels, the window must be large enough
+	virtual bool canRenderToTexture(int size);
+	// Renders list, in pixels from (0, 0), over clear_color into the size x size texture.
+	// Only between frames or before renderFrame() as it draws in the back buffer.
+	virtual bool renderToTexture(ImDrawList &list, int size, const ImVec4 &clear_color, GLuint texture);
 protected:
 	SDL_Window *window = nullptr;
 	virtual void setGLVersion();
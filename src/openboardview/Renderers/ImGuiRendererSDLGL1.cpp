@@ -29,8 +29,8 @@ void ImGuiRendererSDLGL1::initFrame() {
 	ImGuiRendererSDL::initFrame();
 }
 
-void ImGuiRendererSDLGL1::renderDrawData() {
-	ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
+void ImGuiRendererSDLGL1::renderDrawData(ImDrawData *draw_data) {
+	ImGui_ImplOpenGL2_RenderDrawData(draw_data);
 }
 
 void ImGuiRendererSDLGL1::shutdown() {
@@ -11,7 +11,7 @@ public:
 	void setGLVersion();
 	bool init();
 	void initFrame();
-	void renderDrawData();
+	void renderDrawData(ImDrawData *draw_data);
 	void shutdown();
 };
 
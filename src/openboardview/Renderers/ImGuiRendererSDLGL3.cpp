@@ -1,4 +1,5 @@
 #include "ImGuiRendererSDLGL3.h"
+#include "RetainedLayerGL3.h"
 
 #include "backends/imgui_impl_opengl3.h"
 
@@ -64,11 +65,21 @@ void ImGuiRendererSDLGL3::initFrame() {
 	ImGuiRendererSDL::initFrame();
 }
 
-void ImGuiRendererSDLGL3::renderDrawData() {
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+void ImGuiRendererSDLGL3::renderDrawData(ImDrawData *draw_data) {
+	ImGui_ImplOpenGL3_RenderDrawData(draw_data);
 }
 
 void ImGuiRendererSDLGL3::shutdown() {
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGuiRendererSDL::shutdown();
 }
+
+std::unique_ptr<RetainedLayer> ImGuiRendererSDLGL3::createRetainedLayer() {
+#if defined(IMGUI_IMPL_OPENGL_ES2) || defined(IMGUI_IMPL_OPENGL_ES3)
+	return {}; // needs base vertex draws, OpenGL ES 3.2
+#else
+	std::unique_ptr<RetainedLayerGL3> layer{new RetainedLayerGL3(glsl_version)};
+	if (!layer->valid()) return {};
+	return layer;
+#endif
+}
@@ -11,8 +11,9 @@ public:
 	void setGLVersion();
 	bool init();
 	void initFrame();
-	void renderDrawData();
+	void renderDrawData(ImDrawData *draw_data);
 	void shutdown();
+	std::unique_ptr<RetainedLayer> createRetainedLayer();
 private:
 	std::string glsl_version;
 };
@@ -0,0 +1,22 @@
+#ifndef _RETAINEDLAYER_H_
+#define _RETAINEDLAYER_H_
+
+#include "imgui/imgui.h"
+
+/*
+ * Geometry kept on the GPU and drawn through an affine transform, so moving the view only changes
+ * the transform instead of rebuilding the vertices. It is filled from an ImDrawList whose vertices
+ * are in the space the transform maps to the screen.
+ */
+class RetainedLayer {
+public:
+	virtual ~RetainedLayer() = default;
+
+	// Replaces the geometry with the draw commands of list, callbacks are skipped
+	virtual void upload(const ImDrawList &list) = 0;
+
+	// Queues drawing the geometry into draw, a vertex (x, y) lands on screen at origin + x * axis_x + y * axis_y
+	virtual void draw(ImDrawList *draw, ImVec2 origin, ImVec2 axis_x, ImVec2 axis_y) = 0;
+};
+
+#endif
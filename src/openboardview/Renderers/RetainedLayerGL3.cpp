@@ -0,0 +1,180 @@
+#include "RetainedLayerGL3.h"
+
+#include <SDL.h>
+
+#include <cstddef>
+
+namespace {
+
+const char *vertexShader =
+	"uniform mat4 ProjMtx;\n"
+	"in vec2 Position;\n"
+	"in vec2 UV;\n"
+	"in vec4 Color;\n"
+	"out vec2 Frag_UV;\n"
+	"out vec4 Frag_Color;\n"
+	"void main() {\n"
+	"	Frag_UV = UV;\n"
+	"	Frag_Color = Color;\n"
+	"	gl_Position = ProjMtx * vec4(Position.xy, 0, 1);\n"
+	"}\n";
+
+const char *fragmentShader =
+	"precision mediump float;\n"
+	"uniform sampler2D Texture;\n"
+	"in vec2 Frag_UV;\n"
+	"in vec4 Frag_Color;\n"
+	"out vec4 Out_Color;\n"
+	"void main() {\n"
+	"	Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+	"}\n";
+
+GLuint compileShader(GLenum type, const std::string &glsl_version, const char *source) {
+	std::string header = glsl_version + "\n";
+	const GLchar *sources[] = {header.c_str(), source};
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 2, sources, nullptr);
+	glCompileShader(shader);
+
+	GLint status = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status == GL_FALSE) {
+		GLchar log[512];
+		glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+		SDL_LogError(SDL_LOG_CATEGORY_RENDER, "RetainedLayerGL3: failed to compile shader: %s", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+} // namespace
+
+RetainedLayerGL3::RetainedLayerGL3(const std::string &glsl_version) {
+	// GLSL 1.50 has no precision qualifiers, only ES needs them
+	std::string fragment = fragmentShader;
+	if (glsl_version.find(" es") == std::string::npos) fragment.erase(0, fragment.find('\n') + 1);
+
+	GLuint vert = compileShader(GL_VERTEX_SHADER, glsl_version, vertexShader);
+	GLuint frag = compileShader(GL_FRAGMENT_SHADER, glsl_version, fragment.c_str());
+	if (vert && frag) {
+		program = glCreateProgram();
+		glAttachShader(program, vert);
+		glAttachShader(program, frag);
+		glLinkProgram(program);
+
+		GLint status = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (status == GL_FALSE) {
+			SDL_LogError(SDL_LOG_CATEGORY_RENDER, "RetainedLayerGL3: failed to link program");
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+	if (vert) glDeleteShader(vert);
+	if (frag) glDeleteShader(frag);
+	if (!program) return;
+
+	locationProjMtx = glGetUniformLocation(program, "ProjMtx");
+	locationTexture = glGetUniformLocation(program, "Texture");
+	GLint position  = glGetAttribLocation(program, "Position");
+	GLint uv        = glGetAttribLocation(program, "UV");
+	GLint color     = glGetAttribLocation(program, "Color");
+
+	// The vertex layout is ImDrawVert's, as the ImGui backend uses. Keep the current VAO bound.
+	GLint last_vao = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vao);
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glEnableVertexAttribArray(position);
+	glEnableVertexAttribArray(uv);
+	glEnableVertexAttribArray(color);
+	glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid *)offsetof(ImDrawVert, pos));
+	glVertexAttribPointer(uv, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid *)offsetof(ImDrawVert, uv));
+	glVertexAttribPointer(color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid *)offsetof(ImDrawVert, col));
+	glBindVertexArray(last_vao);
+}
+
+RetainedLayerGL3::~RetainedLayerGL3() {
+	if (!SDL_GL_GetCurrentContext()) return; // went with the context
+	if (ebo) glDeleteBuffers(1, &ebo);
+	if (vbo) glDeleteBuffers(1, &vbo);
+	if (vao) glDeleteVertexArrays(1, &vao);
+	if (program) glDeleteProgram(program);
+}
+
+bool RetainedLayerGL3::valid() const {
+	return program != 0;
+}
+
+void RetainedLayerGL3::upload(const ImDrawList &list) {
+	commands.clear();
+	for (auto &cmd : list.CmdBuffer) {
+		if (cmd.UserCallback || cmd.ElemCount == 0) continue;
+		commands.push_back({cmd.GetTexID(), cmd.ElemCount, cmd.IdxOffset, cmd.VtxOffset});
+	}
+
+	// The element buffer binding is VAO state, bind it there
+	GLint last_vao = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vao);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, list.VtxBuffer.Size * sizeof(ImDrawVert), list.VtxBuffer.Data, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, list.IdxBuffer.Size * sizeof(ImDrawIdx), list.IdxBuffer.Data, GL_STATIC_DRAW);
+	glBindVertexArray(last_vao);
+}
+
+void RetainedLayerGL3::draw(ImDrawList *draw, ImVec2 origin, ImVec2 axis_x, ImVec2 axis_y) {
+	this->origin = origin;
+	axisX        = axis_x;
+	axisY        = axis_y;
+	draw->AddCallback(&RetainedLayerGL3::renderCallback, this);
+	draw->AddCallback(ImDrawCallback_ResetRenderState, nullptr); // the backend sets its own state back up
+}
+
+void RetainedLayerGL3::renderCallback(const ImDrawList *, const ImDrawCmd *cmd) {
+	static_cast<RetainedLayerGL3 *>(cmd->UserCallbackData)->render(cmd->ClipRect);
+}
+
+void RetainedLayerGL3::render(const ImVec4 &clip_rect) {
+	ImDrawData *draw_data = ImGui::GetDrawData();
+	if (!draw_data || commands.empty()) return;
+
+	// Clip like the backend does for the surrounding commands
+	ImVec2 clip_off   = draw_data->DisplayPos;
+	ImVec2 clip_scale = draw_data->FramebufferScale;
+	float fb_height   = draw_data->DisplaySize.y * clip_scale.y;
+	ImVec2 clip_min((clip_rect.x - clip_off.x) * clip_scale.x, (clip_rect.y - clip_off.y) * clip_scale.y);
+	ImVec2 clip_max((clip_rect.z - clip_off.x) * clip_scale.x, (clip_rect.w - clip_off.y) * clip_scale.y);
+	if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y) return;
+	glScissor((int)clip_min.x, (int)(fb_height - clip_max.y), (int)(clip_max.x - clip_min.x), (int)(clip_max.y - clip_min.y));
+
+	// The backend's orthographic projection applied after the layer's transform
+	float L  = draw_data->DisplayPos.x;
+	float R  = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+	float T  = draw_data->DisplayPos.y;
+	float B  = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+	float sx = 2.0f / (R - L);
+	float sy = 2.0f / (T - B);
+	const float projection[4][4] = {
+		{sx * axisX.x, sy * axisX.y, 0.0f, 0.0f},
+		{sx * axisY.x, sy * axisY.y, 0.0f, 0.0f},
+		{0.0f, 0.0f, -1.0f, 0.0f},
+		{sx * origin.x + (R + L) / (L - R), sy * origin.y + (T + B) / (B - T), 0.0f, 1.0f},
+	};
+
+	glUseProgram(program);
+	glUniform1i(locationTexture, 0);
+	glUniformMatrix4fv(locationProjMtx, 1, GL_FALSE, &projection[0][0]);
+	glBindVertexArray(vao);
+	glActiveTexture(GL_TEXTURE0);
+	for (auto &cmd : commands) {
+		glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)cmd.texture);
+		glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)cmd.elem_count, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+		                         (void *)(intptr_t)(cmd.idx_offset * sizeof(ImDrawIdx)), (GLint)cmd.vtx_offset);
+	}
+}
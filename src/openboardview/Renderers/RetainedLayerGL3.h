@@ -0,0 +1,41 @@
+#ifndef _RETAINEDLAYERGL3_H_
+#define _RETAINEDLAYERGL3_H_
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "RetainedLayer.h"
+
+// RetainedLayer drawn from ImDrawList callbacks while the OpenGL 3 ImGui backend renders
+class RetainedLayerGL3: public RetainedLayer {
+public:
+	explicit RetainedLayerGL3(const std::string &glsl_version);
+	~RetainedLayerGL3();
+
+	bool valid() const;
+
+	void upload(const ImDrawList &list);
+	void draw(ImDrawList *draw, ImVec2 origin, ImVec2 axis_x, ImVec2 axis_y);
+
+private:
+	struct Command {
+		ImTextureID texture;
+		unsigned int elem_count;
+		unsigned int idx_offset;
+		unsigned int vtx_offset;
+	};
+
+	static void renderCallback(const ImDrawList *parent_list, const ImDrawCmd *cmd);
+	void render(const ImVec4 &clip_rect);
+
+	GLuint program = 0;
+	GLuint vao = 0, vbo = 0, ebo = 0;
+	GLint locationProjMtx = -1, locationTexture = -1;
+
+	std::vector<Command> commands;
+	ImVec2 origin{0.0f, 0.0f}, axisX{1.0f, 0.0f}, axisY{0.0f, 1.0f};
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "TileCache.h"
+
+namespace {
+
+// Drivers usually keep RGB textures as 4 bytes per pixel
+constexpr size_t kTileBytes = TileCache::kTileSize * TileCache::kTileSize * 4;
+
+} // namespace
+
+TileCache::TileCache(ImGuiRendererSDL &renderer) : renderer(renderer) {
+}
+
+TileCache::~TileCache() {
+	if (!SDL_GL_GetCurrentContext()) return; // went with the context
+	clear();
+}
+
+void TileCache::setLimit(size_t megabytes) {
+	limit = megabytes * 1024 * 1024;
+	evict();
+}
+
+void TileCache::beginFrame() {
+	frame++;
+}
+
+GLuint TileCache::find(const Key &key, size_t state, bool *fresh) {
+	auto it = tiles.find(key);
+	if (it == tiles.end()) {
+		*fresh = false;
+		return 0;
+	}
+	touch(it->second);
+	*fresh = it->second.state == state && !it->second.stale;
+	return it->second.texture;
+}
+
+bool TileCache::canRender() {
+	return renderer.canRenderToTexture(kTileSize);
+}
+
+GLuint TileCache::render(const Key &key, size_t state, ImDrawList &list, const ImVec4 &background, const ImVec2 &min, const ImVec2 &max) {
+	auto it = tiles.find(key);
+	if (it == tiles.end()) {
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		// Opaque, the back buffer may have no alpha to copy
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, kTileSize, kTileSize, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+		lru.push_front(key);
+		it = tiles.emplace(key, Tile{texture, 0, frame, lru.begin(), min, max}).first;
+		evict();
+	}
+
+	auto &tile = it->second;
+	touch(tile);
+	if (!renderer.renderToTexture(list, kTileSize, background, tile.texture)) return 0;
+	tile.state = state;
+	tile.min   = min;
+	tile.max   = max;
+	tile.stale = false;
+	return tile.texture;
+}
+
+void TileCache::invalidate(const std::function<bool(const Key &key, const ImVec2 &min, const ImVec2 &max)> &touched) {
+	for (auto &tile : tiles)
+		if (!tile.second.stale && touched(tile.first, tile.second.min, tile.second.max)) tile.second.stale = true;
+}
+
+void TileCache::clear() {
+	for (auto &tile : tiles) glDeleteTextures(1, &tile.second.texture);
+	tiles.clear();
+	lru.clear();
+}
+
+void TileCache::touch(Tile &tile) {
+	tile.frame = frame;
+	lru.splice(lru.begin(), lru, tile.order);
+}
+
+void TileCache::evict() {
+	while (tiles.size() * kTileBytes > limit && !lru.empty()) {
+		auto it = tiles.find(lru.back());
+		if (it->second.frame == frame) break; // on screen, as is everything more recent
+		glDeleteTextures(1, &it->second.texture);
+		tiles.erase(it);
+		lru.pop_back();
+	}
+}
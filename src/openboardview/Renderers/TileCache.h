@@ -0,0 +1,93 @@
+#ifndef _TILECACHE_H_
+#define _TILECACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include "imgui/imgui.h"
+
+#include "ImGuiRendererSDL.h"
+
+/*
+ * Textures of a picture cut in square tiles, for a pyramid of zoom levels, as a map viewer keeps them.
+ * Tiles are rendered through the renderer one at a time, so callers can spread the work over frames,
+ * and the least recently used ones are freed past a memory limit.
+ * A tile is rendered for a state (a hash of what it shows); one from another state is stale, it can
+ * still be drawn until it is rendered again. Changes to part of the picture only make the tiles
+ * they touch stale, through invalidate().
+ */
+class TileCache {
+public:
+	static constexpr int kTileSize = 256; // pixels
+
+	struct Key {
+		int view;  // which picture, e.g. the orientation it is seen in
+		int level; // zoom octave
+		int x, y;  // tile (x, y) covers pixels [x, x + 1) * kTileSize by [y, y + 1) * kTileSize of its level
+
+		bool operator==(const Key &o) const {
+			return view == o.view && level == o.level && x == o.x && y == o.y;
+		}
+	};
+
+	explicit TileCache(ImGuiRendererSDL &renderer);
+	~TileCache();
+
+	// Memory the tile textures may use, in megabytes. Tiles used this frame are kept even past it.
+	void setLimit(size_t megabytes);
+
+	// Starts counting the tiles used by a new frame
+	void beginFrame();
+
+	// Texture of a tile or 0, fresh tells if it was rendered for state. Texture rows go bottom up.
+	GLuint find(const Key &key, size_t state, bool *fresh);
+
+	// Whether the renderer can render tiles now, e.g. the window isn't smaller than one
+	bool canRender();
+
+	/*
+	 * Renders list, in the tile's pixels from (0, 0), over background into the tile, 0 if it can't.
+	 * [min, max] is the region of the picture the tile shows, in the caller's coordinates.
+	 */
+	GLuint render(const Key &key, size_t state, ImDrawList &list, const ImVec4 &background, const ImVec2 &min, const ImVec2 &max);
+
+	// Makes the tiles for which touched(key, min, max) is true stale, with the region they were rendered for
+	void invalidate(const std::function<bool(const Key &key, const ImVec2 &min, const ImVec2 &max)> &touched);
+
+	void clear();
+
+private:
+	struct KeyHash {
+		size_t operator()(const Key &k) const {
+			size_t h = std::hash<int>()(k.x);
+			h        = h * 31 + std::hash<int>()(k.y);
+			h        = h * 31 + std::hash<int>()(k.level);
+			return h * 31 + std::hash<int>()(k.view);
+		}
+	};
+
+	struct Tile {
+		GLuint texture;
+		size_t state;
+		uint64_t frame;                 // last used
+		std::list<Key>::iterator order; // in lru
+		ImVec2 min, max;                // region shown
+		bool stale = false;             // invalidated since it was rendered
+	};
+
+	void touch(Tile &tile);
+	void evict();
+
+	ImGuiRendererSDL &renderer;
+	std::unordered_map<Key, Tile, KeyHash> tiles;
+	std::list<Key> lru; // most recently used first
+	size_t limit   = 64 * 1024 * 1024;
+	uint64_t frame = 0;
+};
+
+#endif
@@ -17,11 +17,11 @@ void Searcher::setMode(SearchMode sm) {
 	m_searchMode = sm;
 }
 
-bool Searcher::strstrModeSearch(const std::string &strhaystack, const std::string &strneedle) {
+bool Searcher::strstrModeSearch(std::string_view strhaystack, const std::string &strneedle) {
 	size_t nl = strneedle.size();
 	size_t hl = strhaystack.size();
 	const char *needle = strneedle.c_str();
-	const char *haystack = strhaystack.c_str();
+	const char *haystack = strhaystack.data();
 	const char *sr;
 
 	sr = strcasestr(haystack, needle);
@@ -45,7 +45,7 @@ template<class T> std::vector<T> Searcher::searchFor(const std::string& search,
 		if (m_search_details && !match) {
 			const auto details = p->searchableStringDetails();
 			for (auto s = details.begin(); s != details.end() && !match; ++s) {
-				match |= strstrModeSearch(**s, search);
+				match |= strstrModeSearch(*s, search);
 			}
 		}
 		if (match) {
@@ -14,7 +14,7 @@ class Searcher {
 	SharedVector<Component> m_parts;
 
 	template<class T> std::vector<T> searchFor(const std::string& search, std::vector<T> v,  int limit);
-	bool strstrModeSearch(const std::string &strhaystack, const std::string &strneedle);
+	bool strstrModeSearch(std::string_view strhaystack, const std::string &strneedle); // strhaystack is NUL-terminated
 public:
 	void setNets(SharedVector<Net> nets);
 	void setParts(SharedVector<Component> components);
@@ -0,0 +1,202 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+constexpr int kMaxGridSize        = 2048; // cells per axis
+constexpr int kMaxCellsPerElement = 64;
+constexpr float kElementsPerCell  = 2.0f;
+
+} // namespace
+
+int SpatialGrid::column(float x) const {
+	return std::clamp(static_cast<int>((x - origin.x) * inv_cell_size), 0, columns - 1);
+}
+
+int SpatialGrid::row(float y) const {
+	return std::clamp(static_cast<int>((y - origin.y) * inv_cell_size), 0, rows - 1);
+}
+
+void SpatialGrid::build(std::vector<Box> new_boxes) {
+	boxes = std::move(new_boxes);
+	oversize.clear();
+	cell_begin.clear();
+	items.clear();
+	seen.assign(boxes.size(), 0);
+	stamp   = 0;
+	extent  = 0.0f;
+	columns = rows = 0;
+
+	ImVec2 min(FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX);
+	size_t count = 0;
+	for (auto &box : boxes) {
+		if (box.min.x > box.max.x || box.min.y > box.max.y) continue;
+		min.x  = std::min(min.x, box.min.x);
+		min.y  = std::min(min.y, box.min.y);
+		max.x  = std::max(max.x, box.max.x);
+		max.y  = std::max(max.y, box.max.y);
+		extent = std::max(extent, std::max(box.max.x - box.min.x, box.max.y - box.min.y) / 2.0f);
+		count++;
+	}
+	if (count == 0) return;
+
+	// Square cells sized for a few elements each over the occupied area
+	float width     = std::max(max.x - min.x, 1.0f);
+	float height    = std::max(max.y - min.y, 1.0f);
+	float cell_size = std::sqrt(width * height * kElementsPerCell / count);
+	cell_size       = std::max({cell_size, width / kMaxGridSize, height / kMaxGridSize});
+	origin          = min;
+	inv_cell_size   = 1.0f / cell_size;
+	columns         = std::min(kMaxGridSize, static_cast<int>(width * inv_cell_size) + 1);
+	rows            = std::min(kMaxGridSize, static_cast<int>(height * inv_cell_size) + 1);
+
+	// Count, then fill, the elements of each cell
+	cell_begin.assign(static_cast<size_t>(columns) * rows + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			for (size_t c = 1; c < cell_begin.size(); c++) cell_begin[c] += cell_begin[c - 1];
+			items.resize(cell_begin.back());
+		}
+		for (uint32_t i = 0; i < boxes.size(); i++) {
+			auto &box = boxes[i];
+			if (box.min.x > box.max.x || box.min.y > box.max.y) continue;
+			int x0 = column(box.min.x), x1 = column(box.max.x);
+			int y0 = row(box.min.y), y1 = row(box.max.y);
+			if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerElement) {
+				if (pass == 0) oversize.push_back(i);
+				continue;
+			}
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					size_t c = static_cast<size_t>(y) * columns + x;
+					if (pass == 0)
+						cell_begin[c + 1]++;
+					else
+						items[--cell_begin[c + 1]] = i;
+				}
+			}
+		}
+	}
+	// The fill pass counted cell_begin[c + 1] down from the end of cell c to its start
+	for (size_t c = 0; c + 1 < cell_begin.size(); c++) cell_begin[c] = cell_begin[c + 1];
+	cell_begin.back() = items.size();
+}
+
+void SpatialGrid::query(ImVec2 min, ImVec2 max, std::vector<uint32_t> &result) const {
+	result.clear();
+	if (!columns) return;
+
+	if (++stamp == 0) { // wrapped, forget all stamps
+		std::fill(seen.begin(), seen.end(), 0);
+		stamp = 1;
+	}
+
+	auto overlaps = [&](uint32_t i) {
+		auto &box = boxes[i];
+		return box.min.x <= max.x && box.max.x >= min.x && box.min.y <= max.y && box.max.y >= min.y;
+	};
+
+	for (auto i : oversize)
+		if (overlaps(i)) result.push_back(i);
+
+	if (max.x >= origin.x && max.y >= origin.y) {
+		int x0 = column(min.x), x1 = column(max.x);
+		int y0 = row(min.y), y1 = row(max.y);
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				size_t c = static_cast<size_t>(y) * columns + x;
+				for (uint32_t k = cell_begin[c]; k < cell_begin[c + 1]; k++) {
+					uint32_t i = items[k];
+					if (seen[i] == stamp) continue;
+					seen[i] = stamp;
+					if (overlaps(i)) result.push_back(i);
+				}
+			}
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+}
+
+void BoardIndex::build(Board &board) {
+	std::vector<SpatialGrid::Box> boxes;
+
+	boxes.reserve(board.Vias().size());
+	for (auto &via : board.Vias()) {
+		float r = via->size;
+		boxes.push_back({{via->position.x - r, via->position.y - r}, {via->position.x + r, via->position.y + r}});
+	}
+	vias.build(std::move(boxes));
+
+	boxes.clear();
+	boxes.reserve(board.Tracks().size());
+	for (auto &track : board.Tracks()) {
+		float w = track->width / 2.0f;
+		boxes.push_back({{std::min(track->position_start.x, track->position_end.x) - w, std::min(track->position_start.y, track->position_end.y) - w},
+		                 {std::max(track->position_start.x, track->position_end.x) + w, std::max(track->position_start.y, track->position_end.y) + w}});
+	}
+	tracks.build(std::move(boxes));
+
+	boxes.clear();
+	boxes.reserve(board.arcs().size());
+	for (auto &arc : board.arcs()) {
+		float r = arc->radius;
+		boxes.push_back({{arc->position.x - r, arc->position.y - r}, {arc->position.x + r, arc->position.y + r}});
+	}
+	arcs.build(std::move(boxes));
+
+	pins_dirty = parts_dirty = true;
+	update(board);
+}
+
+void BoardIndex::update(Board &board) {
+	std::vector<SpatialGrid::Box> boxes;
+
+	if (pins_dirty) {
+		// A pin is hit within its diameter of its center
+		auto &store = board.Store();
+		boxes.reserve(store.pin_count());
+		for (size_t i = 0; i < store.pin_count(); i++) {
+			float r = store.pin_diameter[i];
+			boxes.push_back({{store.pin_x[i] - r, store.pin_y[i] - r}, {store.pin_x[i] + r, store.pin_y[i] + r}});
+		}
+		pins.build(std::move(boxes));
+		pins_dirty = false;
+	}
+
+	if (parts_dirty) {
+		boxes.clear();
+		boxes.reserve(board.Components().size());
+		unplaced_parts.clear();
+		auto &components = board.Components();
+		for (uint32_t i = 0; i < components.size(); i++) {
+			auto &part = components[i];
+			SpatialGrid::Box box{{FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX}};
+			if (part->outline_done) {
+				for (auto &p : part->outline) {
+					box.min = ImVec2(std::min(box.min.x, p.x), std::min(box.min.y, p.y));
+					box.max = ImVec2(std::max(box.max.x, p.x), std::max(box.max.y, p.y));
+				}
+			} else {
+				unplaced_parts.push_back(i);
+			}
+			boxes.push_back(box);
+		}
+		parts.build(std::move(boxes));
+		parts_dirty = false;
+	}
+}
+
+bool BoardIndex::part_contains(const Component &part, ImVec2 point) {
+	auto &poly = part.outline;
+	bool hit   = false;
+	for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+		if (((poly[i].y > point.y) != (poly[j].y > point.y)) &&
+		    (point.x < (poly[j].x - poly[i].x) * (point.y - poly[i].y) / (poly[j].y - poly[i].y) + poly[i].x))
+			hit = !hit;
+	}
+	return hit;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Board.h"
+
+#include "imgui/imgui.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * Uniform grid of element bounding boxes, in board coordinates. An element is listed in every cell
+ * its box overlaps, elements spanning too many cells go to a short list that every query checks.
+ * Queries return element indices (positions in the vector given to build()), so a lookup under the
+ * mouse only looks at the few elements around it instead of all of them.
+ */
+class SpatialGrid {
+  public:
+	struct Box {
+		ImVec2 min, max;
+	};
+
+	// Boxes with min > max are left out, e.g. parts that have no outline yet
+	void build(std::vector<Box> boxes);
+
+	// Indices of the elements whose box overlaps [min, max], ascending and without duplicates
+	void query(ImVec2 min, ImVec2 max, std::vector<uint32_t> &result) const;
+	void query(ImVec2 point, std::vector<uint32_t> &result) const {
+		query(point, point, result);
+	}
+
+	// Largest half width or height of an element box
+	float max_extent() const {
+		return extent;
+	}
+
+  private:
+	int column(float x) const;
+	int row(float y) const;
+
+	std::vector<Box> boxes;
+	std::vector<uint32_t> oversize; // elements that would cover more than kMaxCellsPerElement cells
+
+	ImVec2 origin;
+	float inv_cell_size = 1.0f;
+	int columns         = 0;
+	int rows            = 0;
+	float extent        = 0.0f;
+
+	// Elements of cell (column, row) are items[cell_begin[c]] to items[cell_begin[c + 1]], c = row * columns + column
+	std::vector<uint32_t> cell_begin;
+	std::vector<uint32_t> items;
+
+	// Query stamp of each element, to report elements spanning several cells once
+	mutable std::vector<uint32_t> seen;
+	mutable uint32_t stamp = 0;
+};
+
+/*
+ * The grids BoardView hit tests and culls with. Indices are positions in Board::Pins(), Vias(),
+ * Components(), Tracks() and arcs(). Callers still check the side and layer of what a query
+ * returns, the grids hold every side.
+ * Pin sizes and part outlines change when DrawParts first computes the outlines, and Mirror()
+ * moves pins and parts, so those grids are rebuilt on the next use after being marked dirty.
+ */
+struct BoardIndex {
+	SpatialGrid pins;
+	SpatialGrid vias;
+	SpatialGrid parts;
+	SpatialGrid tracks;
+	SpatialGrid arcs;
+
+	// Parts left out of the parts grid because they have no outline (yet), ascending
+	std::vector<uint32_t> unplaced_parts;
+
+	bool pins_dirty  = true;
+	bool parts_dirty = true;
+
+	void build(Board &board);
+	// Rebuilds the dirty grids
+	void update(Board &board);
+
+	// True if point is inside the part's outline
+	static bool part_contains(const Component &part, ImVec2 point);
+};
@@ -0,0 +1,89 @@
+/*
+ * Line splitting throughput of LineSplitter against the two-pass stb stringfile() it replaced, on
+ * a generated BVR3-like text of parts and pins with CRLF line ends.
+ *
+ * line_splitter_benchmark [million lines]
+ */
+#include "FileFormats/BRDFileBase.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename F>
+double Seconds(F &&f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// stringfile() as it was: counts the lines, then cuts them
+std::vector<char *> ReferenceLines(char *buffer) {
+	std::vector<char *> lines;
+	for (int pass = 0; pass < 2; pass++) {
+		char *s      = buffer;
+		size_t count = 1;
+		if (pass == 1) lines[0] = s;
+		while (*s) {
+			if (*s == '\n' || *s == '\r') {
+				if (pass == 1) *s = 0;
+				s++;
+				if (*s == '\r' || *s == '\n') s++;
+				if (*s) {
+					if (pass == 1) lines[count] = s;
+					count++;
+				}
+			}
+			s++;
+		}
+		if (pass == 0) lines.resize(count);
+	}
+	return lines;
+}
+
+std::string MakeText(size_t line_count) {
+	std::string text;
+	char line[128];
+	for (size_t i = 0; i * 4 < line_count; i++) {
+		snprintf(line, sizeof(line),
+		         "PART_NAME R%zu\r\n   PART_SIDE T\r\nPIN_NUMBER %zu\r\n   PIN_ORIGIN %zu.125 %zu.5\r\n",
+		         i, i % 7 + 1, i * 3 % 10000, i * 5 % 8000);
+		text += line;
+	}
+	return text;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	size_t millions = argc > 1 ? strtoul(argv[1], nullptr, 10) : 4;
+	std::string text = MakeText(millions * 1000000);
+
+	std::vector<char> reference(text.begin(), text.end()), split(text.begin(), text.end());
+	reference.push_back(0);
+	split.push_back(0);
+
+	std::vector<char *> reference_lines;
+	double reference_time = Seconds([&] { reference_lines = ReferenceLines(reference.data()); });
+
+	std::vector<char *> lines;
+	double split_time = Seconds([&] {
+		LineSplitter splitter(split.data(), text.size());
+		for (char *line : splitter) lines.push_back(line);
+	});
+
+	bool same = lines.size() == reference_lines.size();
+	for (size_t i = 0; same && i < lines.size(); i++) same = strcmp(lines[i], reference_lines[i]) == 0;
+
+	printf("%zu lines, %.1f MB\n", lines.size(), text.size() / 1e6);
+	printf("stringfile (ref): %8.1f ms %8.1f MB/s\n", reference_time * 1e3, text.size() / reference_time / 1e6);
+	printf("LineSplitter:     %8.1f ms %8.1f MB/s\n", split_time * 1e3, text.size() / split_time / 1e6);
+	printf("speedup:          %8.1fx\n", reference_time / split_time);
+	printf("lines %s\n", same ? "match" : "DIFFER");
+	return same ? 0 : 1;
+}
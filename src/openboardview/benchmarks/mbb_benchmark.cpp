@@ -0,0 +1,126 @@
+/*
+ * Hull and minimal bounding box of 100k synthetic connector-like parts, against the all-edge search
+ * VHMBBCalculate did before: every hull edge angle, every vertex rotated with its own sin/cos.
+ *
+ * mbb_benchmark [parts]
+ */
+#include "imgui/imgui.h"
+#include "vectorhulls.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// The previous search, kept here as the reference
+std::array<ImVec2, 4> ReferenceMBB(std::vector<ImVec2> hull, double psz) {
+	std::array<ImVec2, 4> box;
+	double mbArea = DBL_MAX, mbAngle = 0;
+	double mbx0 = 0, mby0 = 0, mbx1 = 0, mby1 = 0;
+	for (size_t i = 0; i < hull.size(); i++) {
+		size_t ni = (i + 1) % hull.size();
+		if (hull[i].x == hull[ni].x && hull[i].y == hull[ni].y) continue;
+		double angle = -VHAngleToX(hull[i], hull[ni]);
+		double x0 = DBL_MAX, y0 = DBL_MAX, x1 = -DBL_MAX, y1 = -DBL_MAX;
+		for (auto &p : hull) {
+			ImVec2 r = VHRotateV(p, hull[i], angle);
+			x0       = std::min(x0, static_cast<double>(r.x));
+			y0       = std::min(y0, static_cast<double>(r.y));
+			x1       = std::max(x1, static_cast<double>(r.x));
+			y1       = std::max(y1, static_cast<double>(r.y));
+		}
+		double area = (x1 - x0 + 2 * psz) * (y1 - y0 + 2 * psz);
+		if (area < mbArea) {
+			mbArea  = area;
+			mbAngle = angle;
+			mbx0 = x0, mby0 = y0, mbx1 = x1, mby1 = y1;
+			box[0]  = hull[i];
+		}
+	}
+	ImVec2 o = box[0];
+	box[0]   = VHRotateV(ImVec2(mbx0 - psz, mby0 - psz), o, -mbAngle);
+	box[1]   = VHRotateV(ImVec2(mbx1 + psz, mby0 - psz), o, -mbAngle);
+	box[2]   = VHRotateV(ImVec2(mbx1 + psz, mby1 + psz), o, -mbAngle);
+	box[3]   = VHRotateV(ImVec2(mbx0 - psz, mby1 + psz), o, -mbAngle);
+	return box;
+}
+
+double Area(const std::array<ImVec2, 4> &box) {
+	double a = 0;
+	for (size_t i = 0; i < 4; i++) {
+		const ImVec2 &p = box[i], &q = box[(i + 1) % 4];
+		a += (static_cast<double>(p.x) - box[0].x) * (static_cast<double>(q.y) - box[0].y) -
+		     (static_cast<double>(q.x) - box[0].x) * (static_cast<double>(p.y) - box[0].y);
+	}
+	return std::fabs(a) / 2;
+}
+
+// Rows of pins like connectors and BGA corners, at odd angles, some sharing positions
+std::vector<std::vector<ImVec2>> MakeParts(size_t count) {
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<std::vector<ImVec2>> parts(count);
+	for (auto &pins : parts) {
+		size_t rows = 1 + rng() % 3, cols = 4 + rng() % 60;
+		float pitch = 10.0f + 40.0f * unit(rng), angle = 6.2831853f * unit(rng);
+		ImVec2 at(100000.0f * unit(rng), 100000.0f * unit(rng));
+		for (size_t r = 0; r < rows; r++)
+			for (size_t c = 0; c < cols; c++) {
+				if (rng() % 8 == 0) continue;
+				pins.push_back(VHRotateV(ImVec2(at.x + c * pitch, at.y + r * pitch * 3), at, angle));
+				if (rng() % 16 == 0) pins.push_back(pins.back()); // double pin
+			}
+		if (pins.size() < 4) pins.push_back(ImVec2(at.x, at.y + pitch));
+	}
+	return parts;
+}
+
+template <typename F>
+double Seconds(F &&f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+	auto parts   = MakeParts(count);
+
+	std::vector<std::vector<ImVec2>> hulls(count);
+	double hull_time = Seconds([&] {
+		for (size_t i = 0; i < count; i++) {
+			hulls[i].resize(parts[i].size());
+			hulls[i].resize(VHConvexHull(parts[i].data(), parts[i].size(), hulls[i].data()));
+		}
+	});
+
+	std::vector<std::array<ImVec2, 4>> boxes(count), reference(count);
+	double mbb_time = Seconds([&] {
+		for (size_t i = 0; i < count; i++) boxes[i] = VHMBBCalculate(hulls[i], 10.0);
+	});
+	double reference_time = Seconds([&] {
+		for (size_t i = 0; i < count; i++) reference[i] = ReferenceMBB(hulls[i], 10.0);
+	});
+
+	// Float box corners far from the origin, areas of thin parts agree to about 1e-3
+	size_t larger = 0;
+	for (size_t i = 0; i < count; i++)
+		if (Area(boxes[i]) > Area(reference[i]) * 1.001 + 1) larger++;
+
+	printf("%zu parts\n", count);
+	printf("hull:               %8.1f ms\n", hull_time * 1000);
+	printf("MBB calipers:       %8.1f ms  %10.0f parts/s\n", mbb_time * 1000, count / mbb_time);
+	printf("MBB all-edge (ref): %8.1f ms  %10.0f parts/s\n", reference_time * 1000, count / reference_time);
+	printf("speedup:            %8.1fx\n", reference_time / mbb_time);
+	printf("boxes larger than the reference: %zu\n", larger);
+	return larger ? 1 : 0;
+}
@@ -75,6 +75,7 @@ annotationBoxSize = 20\r\n\
 annotationBoxOffset = 8\r\n\
 \r\n\
 netWebThickness = 2\r\n\
+netWebStar = false\r\n\
 \r\n\
 pdfSoftwarePath = SumatraPDF.exe\r\n\
 #\r\n\
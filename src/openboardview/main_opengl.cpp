@@ -246,6 +246,7 @@ int main(int argc, char **argv) {
 	if (!dataDir.empty()) {
 		app.fhistory.Set_filename(dataDir + "obv.history");
 		app.fhistory.Load();
+		app.boardLoader.SetCacheDir(filesystem::u8path(dataDir) / "cache");
 	}
 
 	// If we've chosen to override the normally found config.
@@ -447,6 +448,9 @@ int main(int argc, char **argv) {
 			clear_color = ImColor(app.m_colors.backgroundColor);
 		}
 
+		// Keep drawing frames while a board loads so its progress is shown, or board tiles are left to render
+		if (app.boardLoader.Busy() || app.m_tilesPending) sleepout = 30;
+
 		if (!(sleepout--)) {
 #ifdef _WIN32
 			Sleep(50);
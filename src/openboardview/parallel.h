@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+typedef std::pair<size_t, size_t> index_range; // [first, second)
+
+/*
+ * Cancellation flag of the board load running on this thread, nullptr outside of loads. Threads of
+ * parallel_for_each() take their caller's, so parsers split across threads see it too.
+ */
+inline const std::atomic<bool> *&load_cancel_flag() {
+	thread_local const std::atomic<bool> *flag = nullptr;
+	return flag;
+}
+
+// Long parsing loops give up once this is true, the load is dropped anyway
+inline bool load_cancelled() {
+	const std::atomic<bool> *flag = load_cancel_flag();
+	return flag && flag->load(std::memory_order_relaxed);
+}
+
+// Number of worker threads used for load time work, at least 1
+inline unsigned int worker_count() {
+	unsigned int n = std::thread::hardware_concurrency();
+	return n > 0 ? n : 1;
+}
+
+// Split [0, count) into at most worker_count() contiguous ranges of at least min_range items
+inline std::vector<index_range> split_ranges(size_t count, size_t min_range) {
+	std::vector<index_range> ranges;
+	if (count == 0) return ranges;
+	if (min_range == 0) min_range = 1;
+
+	size_t n    = std::max<size_t>(1, std::min<size_t>(worker_count(), (count + min_range - 1) / min_range));
+	size_t step = (count + n - 1) / n;
+	for (size_t begin = 0; begin < count; begin += step) {
+		ranges.emplace_back(begin, std::min(begin + step, count));
+	}
+	return ranges;
+}
+
+// Call fn(range) for each range concurrently, the calling thread takes the first one
+template <typename F>
+void parallel_for_each(const std::vector<index_range> &ranges, F &&fn) {
+	if (ranges.empty()) return;
+
+	const std::atomic<bool> *cancel = load_cancel_flag();
+	std::vector<std::thread> threads;
+	threads.reserve(ranges.size() - 1);
+	for (size_t i = 1; i < ranges.size(); i++) {
+		threads.emplace_back([&fn, &ranges, i, cancel]() {
+			load_cancel_flag() = cancel;
+			fn(ranges[i]);
+		});
+	}
+	fn(ranges[0]);
+	for (auto &t : threads) t.join();
+}
+
+// Call fn(begin, end) over [0, count) split in ranges of at least min_range items
+template <typename F>
+void parallel_for_ranges(size_t count, size_t min_range, F &&fn) {
+	parallel_for_each(split_ranges(count, min_range), [&fn](const index_range &r) { fn(r.first, r.second); });
+}
@@ -1,8 +1,11 @@
 #include "imgui/imgui.h"
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
 #include <iostream>
 #include <climits>
 #include <memory>
+#include <vector>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -17,8 +20,9 @@ void VHRotateV(double *px, double *py, double ox, double oy, double theta) {
 
 	// With not a lot of parts on the boards, we can get away with using the
 	// precision trig functions, might have to change to LUT based later.
-	ttx = tx * cos(theta) - ty * sin(theta);
-	tty = tx * sin(theta) + ty * cos(theta);
+	double c = cos(theta), s = sin(theta);
+	ttx = tx * c - ty * s;
+	tty = tx * s + ty * c;
 
 	*px = ttx + ox;
 	*py = tty + oy;
@@ -32,8 +36,9 @@ ImVec2 VHRotateV(ImVec2 v, ImVec2 o, double theta) {
 
 	// With not a lot of parts on the boards, we can get away with using the
 	// precision trig functions, might have to change to LUT based later.
-	ttx = tx * cos(theta) - ty * sin(theta);
-	tty = tx * sin(theta) + ty * cos(theta);
+	double c = cos(theta), s = sin(theta);
+	ttx = tx * c - ty * s;
+	tty = tx * s + ty * c;
 
 	return ImVec2(ttx + o.x, tty + o.y);
 }
@@ -41,99 +46,194 @@ ImVec2 VHRotateV(ImVec2 v, ImVec2 o, double theta) {
 ImVec2 VHRotateV(ImVec2 v, double theta) {
 	double nx, ny;
 
-	nx = v.x * cos(theta) - v.y * sin(theta);
-	ny = v.x * sin(theta) + v.y * cos(theta);
+	double c = cos(theta), s = sin(theta);
+	nx = v.x * c - v.y * s;
+	ny = v.x * s + v.y * c;
 
 	return ImVec2(nx, ny);
 }
 
+void VHRotate(const ImVec2 *points, size_t count, ImVec2 o, double theta, ImVec2 *out) {
+	// Sine and cosine once for the batch, the loop is plain arithmetic the compiler can vectorize
+	const float c = cos(theta), s = sin(theta);
+	for (size_t i = 0; i < count; i++) {
+		float tx = points[i].x - o.x;
+		float ty = points[i].y - o.y;
+		out[i]   = ImVec2(tx * c - ty * s + o.x, tx * s + ty * c + o.y);
+	}
+}
+
 double VHAngleToX(ImVec2 a, ImVec2 b) {
 	return atan2((b.y - a.y), (b.x - a.x));
 }
 
-std::array<ImVec2, 4> VHMBBCalculate(std::vector<ImVec2> hull, double psz) {
-	std::array<ImVec2, 4> box;
-
-	double mbAngle = 0, cumulative_angle = 0;
-	double mbArea = DBL_MAX; // fake area to initialise
-	ImVec2 mbb, mba, origin; // Box bottom left, box top right
-
-	// Find the lowest hull point, if it's below the x-axis just bring it up to
-	// compensate
-	// NOTE: we're not modifying the actual hull point, just a copy
-	origin.x = DBL_MAX;
-	origin.y = DBL_MAX;
-
-	// find bottom corner
-	for (size_t i = 0; i < hull.size(); i++) {
-		if (hull[i].y < origin.y) origin.y = hull[i].y;
-		if (hull[i].x < origin.x) origin.x = hull[i].x;
+namespace {
+
+struct HullPoint {
+	double x, y;
+};
+
+/*
+ * Strictly convex, counterclockwise hull of the points relative to o, with a monotone chain: no
+ * duplicate or collinear points, which the rotating calipers rely on. Two points when all are on a
+ * line, one when they are all the same.
+ */
+void StrictHull(const ImVec2 *points, size_t count, double ox, double oy, std::vector<HullPoint> &hull) {
+	thread_local std::vector<HullPoint> sorted;
+	sorted.resize(count);
+	for (size_t i = 0; i < count; i++) sorted[i] = {points[i].x - ox, points[i].y - oy};
+	std::sort(sorted.begin(), sorted.end(), [](const HullPoint &a, const HullPoint &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+	sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const HullPoint &a, const HullPoint &b) { return a.x == b.x && a.y == b.y; }),
+	             sorted.end());
+
+	hull.clear();
+	if (sorted.size() < 3) {
+		hull = sorted;
+		return;
 	}
 
-	// transpose
-	for (size_t i = 0; i < hull.size(); i++) {
-		hull[i].x -= origin.x;
-		hull[i].y -= origin.y;
+	// Lower then upper chain, dropping points that don't turn left
+	auto cross = [](const HullPoint &o, const HullPoint &a, const HullPoint &b) { return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); };
+	hull.resize(2 * sorted.size());
+	size_t k = 0;
+	for (size_t i = 0; i < sorted.size(); i++) {
+		while (k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) k--;
+		hull[k++] = sorted[i];
 	}
+	for (size_t i = sorted.size() - 1, lower = k + 1; i-- > 0;) {
+		while (k >= lower && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) k--;
+		hull[k++] = sorted[i];
+	}
+	hull.resize(k - 1); // last point is the first
+}
 
-	// rotate hull on each side and work out the smallest area
-	for (size_t i = 0; i < hull.size(); i++) {
-		int ni = i + 1;
-		double area;
-
-		ImVec2 current = hull[i];
-		ImVec2 next    = hull[ni % hull.size()];
-
-		double angle = VHAngleToX(current, next); // angle formed between current and next hull points;
-		cumulative_angle += angle;
+/*
+ * The points relative to o, counterclockwise, if they already are a strictly convex polygon such as
+ * the VHConvexHull() output: every turn the same way and x changing direction only twice, so it goes
+ * round once.
+ */
+bool ConvexHull(const ImVec2 *points, size_t count, double ox, double oy, std::vector<HullPoint> &hull) {
+	if (count < 3) return false;
+	hull.resize(count);
+	for (size_t i = 0; i < count; i++) hull[i] = {points[i].x - ox, points[i].y - oy};
+
+	int turn = 0, x_changes = 0, x_dir = 0;
+	for (size_t i = 0; i < count; i++) {
+		const HullPoint &a = hull[i], &b = hull[(i + 1) % count], &c = hull[(i + 2) % count];
+		double cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+		int t        = cross > 0 ? 1 : cross < 0 ? -1 : 0;
+		if (t == 0 || (turn && t != turn)) return false;
+		turn = t;
+
+		int dir = b.x > a.x ? 1 : b.x < a.x ? -1 : 0;
+		if (dir && x_dir && dir != x_dir) x_changes++;
+		if (dir) x_dir = dir;
+	}
+	if (x_changes > 2) return false;
 
-		double top, bot, left, right; // bounding rect limits
-		top = right = DBL_MIN;
-		bot = left = DBL_MAX;
+	if (turn < 0) std::reverse(hull.begin(), hull.end());
+	return true;
+}
 
-		for (size_t x = 0; x < hull.size(); x++) {
-			ImVec2 rp = VHRotateV(hull[x], -angle);
+} // namespace
 
-			hull[x] = rp;
+/*
+ * Minimal bounding box of a hull with rotating calipers: the box has a side on one of the hull
+ * edges, so going round the edges, the points furthest along the edge, across it and back from it
+ * only move forward and each edge is checked in constant time, O(h) overall. The hull is made
+ * strictly convex first, so any outline of the points, even one looping over itself, gives the box
+ * of their convex hull.
+ */
+std::array<ImVec2, 4> VHMBBCalculate(const ImVec2 *points, size_t count, double psz) {
+	std::array<ImVec2, 4> box;
+	box.fill(ImVec2(0.0f, 0.0f));
+	if (count == 0) return box;
+
+	// Relative to the first point, keeps the precision of large board coordinates
+	const double ox = points[0].x, oy = points[0].y;
+	thread_local std::vector<HullPoint> hull;
+	if (!ConvexHull(points, count, ox, oy, hull)) StrictHull(points, count, ox, oy, hull);
+	const size_t n = hull.size();
+
+	auto next   = [&](size_t i) { return (i + 1) % n; };
+	double ux   = 1.0, uy = 0.0; // direction of the best edge
+	if (n >= 3) {
+		double mbArea = DBL_MAX;
+		size_t right = 0, top = 0, left = 0;
+
+		for (size_t i = 0; i < n; i++) {
+			double dx  = hull[next(i)].x - hull[i].x;
+			double dy  = hull[next(i)].y - hull[i].y;
+			double len = sqrt(dx * dx + dy * dy);
+
+			double eux = dx / len, euy = dy / len; // along the edge
+			double enx = -euy, eny = eux;          // across, into the counterclockwise hull
+			auto along  = [&](size_t k) { return hull[k].x * eux + hull[k].y * euy; };
+			auto across = [&](size_t k) { return hull[k].x * enx + hull[k].y * eny; };
+
+			if (i == 0) {
+				for (size_t k = 0; k < n; k++) {
+					if (along(k) > along(right)) right = k;
+					if (across(k) > across(top)) top = k;
+					if (along(k) < along(left)) left = k;
+				}
+			} else {
+				while (along(next(right)) > along(right)) right = next(right);
+				while (across(next(top)) > across(top)) top = next(top);
+				while (along(next(left)) < along(left)) left = next(left);
+			}
 
-			if (rp.y > top) top     = rp.y;
-			if (rp.y < bot) bot     = rp.y;
-			if (rp.x > right) right = rp.x;
-			if (rp.x < left) left   = rp.x;
-		}
-		area = (right - left) * (top - bot);
-
-		if (area < mbArea) {
-			mbArea  = area;
-			mbAngle = cumulative_angle; // total angle we've had to rotate the board
-			                            // to get to this orientation;
-			mba = ImVec2(left, bot);
-			mbb = ImVec2(right, top);
+			// Area once grown by the pin size, ties between edges go to the smaller grown box
+			double area = (along(right) - along(left) + 2 * psz) * (across(top) - across(i) + 2 * psz);
+			if (area < mbArea) {
+				mbArea = area;
+				ux     = eux;
+				uy     = euy;
+			}
 		}
-	} // for all points on hull
+	} else if (n == 2) {
+		// All points on a line, the box lies along it
+		double dx = hull[1].x - hull[0].x, dy = hull[1].y - hull[0].y, len = sqrt(dx * dx + dy * dy);
+		ux        = dx / len;
+		uy        = dy / len;
+	}
+
+	// Extents in the box's frame
+	double vx = -uy, vy = ux;
+	double left_x = DBL_MAX, right_x = -DBL_MAX, bot = DBL_MAX, top_y = -DBL_MAX;
+	for (auto &p : hull) {
+		double a = p.x * ux + p.y * uy;
+		double b = p.x * vx + p.y * vy;
+		left_x   = std::min(left_x, a);
+		right_x  = std::max(right_x, a);
+		bot      = std::min(bot, b);
+		top_y    = std::max(top_y, b);
+	}
 
 	// expand by pin size
-	mba.x -= psz;
-	mba.y -= psz;
-	mbb.x += psz;
-	mbb.y += psz;
-
-	// Form our rectangle, has to be all 4 points as it's a polygon now that'll be
-	// rotated
-	box[0] = VHRotateV(mba, +mbAngle);
-	box[1] = VHRotateV(ImVec2(mbb.x, mba.y), +mbAngle);
-	box[2] = VHRotateV(mbb, +mbAngle);
-	box[3] = VHRotateV(ImVec2(mba.x, mbb.y), +mbAngle);
-
-	// Transpose MBB back
-	for (size_t i = 0; i < 4; i++) {
-		box[i].x += origin.x;
-		box[i].y += origin.y;
+	left_x -= psz;
+	bot -= psz;
+	right_x += psz;
+	top_y += psz;
+
+	// Form our rectangle in the box's frame, then rotated and moved back in one batch
+	box[0] = ImVec2(left_x, bot);
+	box[1] = ImVec2(right_x, bot);
+	box[2] = ImVec2(right_x, top_y);
+	box[3] = ImVec2(left_x, top_y);
+	VHRotate(box.data(), box.size(), ImVec2(0.0f, 0.0f), atan2(uy, ux), box.data());
+	for (auto &p : box) {
+		p.x += ox;
+		p.y += oy;
 	}
 
 	return box;
 }
 
+std::array<ImVec2, 4> VHMBBCalculate(const std::vector<ImVec2> &hull, double psz) {
+	return VHMBBCalculate(hull.data(), hull.size(), psz);
+}
+
 // To find orientation of ordered triplet (p, q, r).
 // The function returns following values
 // 0 --> p, q and r are colinear
@@ -147,49 +247,21 @@ int VHConvexHullOrientation(ImVec2 p, ImVec2 q, ImVec2 r) {
 	return (val > 0) ? 1 : 2; // clock or counterclock wise
 }
 
-std::vector<ImVec2> VHConvexHull(const std::vector<ImVec2> &points) {
-	std::vector<ImVec2> hull;
-
+size_t VHConvexHull(const ImVec2 *points, size_t count, ImVec2 *hull) {
 	// There must be at least 3 points
-	if (points.size() < 3) return hull;
-
-	// Find the leftmost point
-	int l = 0;
-	for (size_t i = 1; i < points.size(); i++) {
-		if (points[i].x < points[l].x) {
-			l = i;
-		}
-	}
-
-	// Start from leftmost point, keep moving counterclockwise
-	// until reach the start point again.  This loop runs O(h)
-	// times where h is number of points in result or output.
-	int p = l, q;
-	do {
-		// Add current point to result
-		//		hull[hpc] = CoordToScreen(points[p].x, points[p].y);
-		hull.push_back({points[p].x, points[p].y});
-
-		// Search for a point 'q' such that orientation(p, x,
-		// q) is counterclockwise for all points 'x'. The idea
-		// is to keep track of last visited most counterclock-
-		// wise point in q. If any point 'i' is more counterclock-
-		// wise than q, then update q.
-		q = (p + 1) % points.size();
-		for (size_t i = 0; i < points.size(); i++) {
-			// If i is more counterclockwise than current q, then update q
-			if (VHConvexHullOrientation(points[p], points[i], points[q]) == 2) {
-				q = i;
-			}
-		}
-
-		// Now q is the most counterclockwise with respect to p
-		// Set p as q for next iteration, so that q is added to
-		// result 'hull'
-		p = q;
-
-	} while ((p != l) && (hull.size() < points.size())); // While we don't come to first point
+	if (count < 3) return 0;
+
+	// Relative to the first point, exact for float coordinates and back again
+	const double ox = points[0].x, oy = points[0].y;
+	thread_local std::vector<HullPoint> strict;
+	StrictHull(points, count, ox, oy, strict);
+	for (size_t i = 0; i < strict.size(); i++) hull[i] = ImVec2(strict[i].x + ox, strict[i].y + oy);
+	return strict.size();
+}
 
+std::vector<ImVec2> VHConvexHull(const std::vector<ImVec2> &points) {
+	std::vector<ImVec2> hull(points.size());
+	hull.resize(VHConvexHull(points.data(), points.size(), hull.data()));
 	return hull;
 }
 
@@ -2,16 +2,22 @@
 #define VECTORHULLS
 
 #include <array>
+#include <cstddef>
 #include <vector>
 
 void VHRotateV(double *px, double *py, double ox, double oy, double theta);
 ImVec2 VHRotateV(ImVec2 v, double theta);
 ImVec2 VHRotateV(ImVec2 v, ImVec2 o, double theta);
+// Rotates count points around o into out, which can be points
+void VHRotate(const ImVec2 *points, size_t count, ImVec2 o, double theta, ImVec2 *out);
 double VHAngleToX(ImVec2 a, ImVec2 b);
 int VHConvexHullOrientation(ImVec2 p, ImVec2 q, ImVec2 r);
+// Writes the strictly convex hull of count points to hull, with room for count points, and returns its size
+size_t VHConvexHull(const ImVec2 *points, size_t count, ImVec2 *hull);
 std::vector<ImVec2> VHConvexHull(const std::vector<ImVec2> &points);
 int VHTightenHull(ImVec2 hull[], int n, double threshold);
-std::array<ImVec2, 4> VHMBBCalculate(std::vector<ImVec2> hull, double psz);
+std::array<ImVec2, 4> VHMBBCalculate(const ImVec2 *hull, size_t count, double psz);
+std::array<ImVec2, 4> VHMBBCalculate(const std::vector<ImVec2> &hull, double psz);
 
 bool GetIntersection(ImVec2 p0, ImVec2 p1, ImVec2 p2, ImVec2 p3, ImVec2 *i);
 